@@ -1,6 +1,8 @@
 #include "parser.h"
 #include "error.h"
+#include "scheme-string.h"
 #include "utils.h"
+#include "vector.h"
 
 #include <sstream>
 #include <string>
@@ -11,7 +13,7 @@
 
 namespace {
 
-std::shared_ptr<Object> ReadFull(std::string str) {
+Value ReadFull(std::string str) {
     std::stringstream ss{std::move(str)};
     Tokenizer tokenizer{&ss};
 
@@ -20,17 +22,17 @@ std::shared_ptr<Object> ReadFull(std::string str) {
     return obj;
 }
 
-void CheckNumber(const std::shared_ptr<Object>& obj, int value) {
-    REQUIRE(Is<Number>(obj));
-    REQUIRE(As<Number>(obj)->GetValue() == value);
+void CheckNumber(Value obj, int value) {
+    REQUIRE(obj.IsFixnum());
+    REQUIRE(obj.GetFixnum() == value);
 }
 
-void CheckSymbol(const std::shared_ptr<Object>& obj, const std::string& name) {
+void CheckSymbol(Value obj, const std::string& name) {
     REQUIRE(Is<Symbol>(obj));
     REQUIRE(As<Symbol>(obj)->GetName() == name);
 }
 
-std::shared_ptr<Cell> CheckCell(const std::shared_ptr<Object>& obj) {
+Cell* CheckCell(Value obj) {
     REQUIRE(Is<Cell>(obj));
     return As<Cell>(obj);
 }
@@ -64,6 +66,27 @@ TEST_CASE("Read symbol") {
     }
 }
 
+TEST_CASE("Symbols are interned") {
+    auto cell = CheckCell(ReadFull("(foo bar foo)"));
+    auto first = cell->GetFirst();
+    auto third = CheckCell(CheckCell(cell->GetSecond())->GetSecond())->GetFirst();
+    CheckSymbol(first, "foo");
+    REQUIRE(first == third);
+    REQUIRE(first == ReadFull("foo"));
+    REQUIRE(As<Symbol>(first)->GetId() != As<Symbol>(ReadFull("bar"))->GetId());
+}
+
+TEST_CASE("String literals are shared") {
+    auto cell = CheckCell(ReadFull(R"(("foo" "bar" "foo"))"));
+    auto first = cell->GetFirst();
+    auto third = CheckCell(CheckCell(cell->GetSecond())->GetSecond())->GetFirst();
+    REQUIRE(Is<String>(first));
+    REQUIRE(As<String>(first)->GetView() == "foo");
+    REQUIRE(first == third);
+    REQUIRE(first == ReadFull(R"("foo")"));
+    REQUIRE(first != CheckCell(cell->GetSecond())->GetFirst());
+}
+
 TEST_CASE("Lists") {
     SECTION("Empty list") {
         REQUIRE_FALSE(ReadFull("()"));
@@ -148,3 +171,70 @@ TEST_CASE("Lists") {
         CHECK_THROWS_AS(ReadFull("- 5"), SyntaxError);
     }
 }
+
+TEST_CASE("Deeply nested lists") {
+    constexpr int kDepth = 100'000;
+    auto obj = ReadFull(std::string(kDepth, '(') + "1" + std::string(kDepth, ')'));
+    for (int i = 0; i < kDepth; ++i) {
+        auto cell = CheckCell(obj);
+        REQUIRE_FALSE(cell->GetSecond());
+        obj = cell->GetFirst();
+    }
+    CheckNumber(obj, 1);
+
+    obj = ReadFull(std::string(kDepth, '\'') + "x");
+    for (int i = 0; i < kDepth; ++i) {
+        auto cell = CheckCell(obj);
+        CheckSymbol(cell->GetFirst(), "quote");
+        obj = CheckCell(cell->GetSecond())->GetFirst();
+    }
+    CheckSymbol(obj, "x");
+}
+
+TEST_CASE("Reading several data") {
+    std::stringstream ss{"1 (2 3) 'x\n#(4)"};
+    Tokenizer tokenizer{&ss};
+
+    CheckNumber(ReadNext(&tokenizer), 1);
+    auto list = CheckCell(ReadNext(&tokenizer));
+    CheckNumber(list->GetFirst(), 2);
+    auto quote = CheckCell(ReadNext(&tokenizer));
+    CheckSymbol(quote->GetFirst(), "quote");
+    REQUIRE(Is<Vector>(ReadNext(&tokenizer)));
+    REQUIRE(tokenizer.IsEnd());
+    REQUIRE_THROWS_AS(ReadNext(&tokenizer), SyntaxError);
+
+    std::stringstream unfinished{"(1) (2"};
+    Tokenizer second{&unfinished};
+    CheckCell(ReadNext(&second));
+    REQUIRE_THROWS_AS(ReadNext(&second), SyntaxError);
+
+    std::stringstream close{"(1))"};
+    Tokenizer third{&close};
+    CheckCell(ReadNext(&third));
+    REQUIRE_THROWS_AS(ReadNext(&third), SyntaxError);
+}
+
+TEST_CASE("Long lists") {
+    constexpr int kLength = 1'000'000;
+    std::string text = "(";
+    for (int i = 0; i < kLength; ++i) {
+        text += std::to_string(i % 10) + ' ';
+    }
+    auto obj = ReadFull(text + ". x)");
+    for (int i = 0; i < kLength; ++i) {
+        auto cell = CheckCell(obj);
+        CheckNumber(cell->GetFirst(), i % 10);
+        obj = cell->GetSecond();
+    }
+    CheckSymbol(obj, "x");
+
+    auto vector = ReadFull("#" + text + "(1 #(2 3)) 4)");
+    REQUIRE(Is<Vector>(vector));
+    auto elements = As<Vector>(vector)->GetElements();
+    REQUIRE(elements.size() == kLength + 2);
+    CheckNumber(elements[kLength - 1], (kLength - 1) % 10);
+    auto nested = CheckCell(CheckCell(elements[kLength])->GetSecond())->GetFirst();
+    REQUIRE(As<Vector>(nested)->GetElements().size() == 2);
+    CheckNumber(elements[kLength + 1], 4);
+}
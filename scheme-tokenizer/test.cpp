@@ -1,8 +1,12 @@
 #include "tokenizer.h"
+#include "error.h"
 
+#include <limits>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <variant>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -61,6 +65,42 @@ TEST_CASE("Unary plus and minus") {
                 SymbolToken{"+"}, ConstantToken{3});
 }
 
+TEST_CASE("64-bit numbers") {
+    CheckTokens("9223372036854775807", ConstantToken{9223372036854775807});
+    CheckTokens("-9223372036854775808", ConstantToken{-9223372036854775807 - 1});
+    CheckTokens("9223372036854775808 -99999999999999999999",
+                BignumToken{"9223372036854775808"}, BignumToken{"-99999999999999999999"});
+}
+
+TEST_CASE("Flonums") {
+    CheckTokens("1.5", FlonumToken{1.5});
+    CheckTokens("-0.25 2. .5", FlonumToken{-0.25}, FlonumToken{2.0}, FlonumToken{0.5});
+    CheckTokens("1e3 1.5E-2", FlonumToken{1e3}, FlonumToken{1.5e-2});
+    CheckTokens("-.5 +.25 -.", FlonumToken{-0.5}, FlonumToken{0.25}, SymbolToken{"-"}, DotToken{});
+    CheckTokens("+inf.0 (-inf.0)", FlonumToken{std::numeric_limits<double>::infinity()},
+                BracketToken::OPEN, FlonumToken{-std::numeric_limits<double>::infinity()},
+                BracketToken::CLOSE);
+    CheckTokens("+infinity -nan", SymbolToken{"+"}, SymbolToken{"infinity"}, SymbolToken{"-"},
+                SymbolToken{"nan"});
+    CheckTokens("(1 . 2)", BracketToken::OPEN, ConstantToken{1}, DotToken{}, ConstantToken{2},
+                BracketToken::CLOSE);
+}
+
+TEST_CASE("Vector literals") {
+    CheckTokens("#(1 #t)", VectorToken{}, ConstantToken{1}, SymbolToken{"#t"},
+                BracketToken::CLOSE);
+    CheckTokens("# (", SymbolToken{"#"}, BracketToken::OPEN);
+}
+
+TEST_CASE("String literals") {
+    CheckTokens(R"("hello" "")", StringToken{"hello"}, StringToken{""});
+    CheckTokens(R"(("a b" x))", BracketToken::OPEN, StringToken{"a b"}, SymbolToken{"x"},
+                BracketToken::CLOSE);
+    CheckTokens(R"("say \"hi\"\n\t\\")", StringToken{"say \"hi\"\n\t\\"});
+    REQUIRE_THROWS_AS(CheckTokens(R"("open)"), SyntaxError);
+    REQUIRE_THROWS_AS(CheckTokens(R"("bad \q")"), SyntaxError);
+}
+
 TEST_CASE("Symbol names") {
     CheckTokens("foo bar zog-zog?", SymbolToken{"foo"}, SymbolToken{"bar"},
                 SymbolToken{"zog-zog?"});
@@ -121,6 +161,59 @@ TEST_CASE("Literal strings are handled correctly") {
                 ConstantToken{4}, SymbolToken{"+"});
 }
 
+TEST_CASE("Tokenizer scans a string in place") {
+    std::string source = R"(("a\"b" foo . .5 +1.5 -7) "plain")";
+    Tokenizer tokenizer{std::string_view{source}};
+    std::vector<Token> tokens;
+    for (; !tokenizer.IsEnd(); tokenizer.Next()) {
+        tokens.push_back(tokenizer.GetToken());
+    }
+    REQUIRE(tokens.size() == 9);
+    RequireEquals(tokens[1], StringToken{"a\"b"});
+    RequireEquals(tokens[2], SymbolToken{"foo"});
+    RequireEquals(tokens[4], FlonumToken{0.5});
+    RequireEquals(tokens[5], FlonumToken{1.5});
+    RequireEquals(tokens[6], ConstantToken{-7});
+    // Symbols and plain string literals view the source itself.
+    auto name = std::get<SymbolToken>(tokens[2]).name;
+    REQUIRE(name.data() == source.data() + source.find("foo"));
+    auto plain = std::get<StringToken>(tokens[8]).value;
+    REQUIRE(plain.data() == source.data() + source.find("plain"));
+}
+
+TEST_CASE("Tokens span stream buffer refills") {
+    std::string long_name(100'000, 'x');
+    std::stringstream ss;
+    for (int i = 0; i < 5; ++i) {
+        ss << long_name << " 12345 \"" << long_name << "\" ";
+    }
+    Tokenizer tokenizer{&ss};
+    for (int i = 0; i < 5; ++i) {
+        RequireEquals(tokenizer.GetToken(), SymbolToken{long_name});
+        tokenizer.Next();
+        RequireEquals(tokenizer.GetToken(), ConstantToken{12345});
+        tokenizer.Next();
+        RequireEquals(tokenizer.GetToken(), StringToken{long_name});
+        tokenizer.Next();
+    }
+    REQUIRE(tokenizer.IsEnd());
+}
+
+TEST_CASE("Long runs of one kind of character") {
+    // Runs of every length around the 16 and 32 characters the scanner tests at a time.
+    for (size_t length = 1; length <= 150; ++length) {
+        std::string name;
+        for (size_t i = 0; i < length; ++i) {
+            name += "aZ09<=>?*#!-/"[i % 13];
+        }
+        std::string number = std::string(length, '7') + "." + std::string(length, '3');
+        std::string text(length, '\xe9');
+        std::string space = std::string(length, ' ') + "\t\n\r\v\f";
+        CheckTokens(space + name + space + number + space + "\"" + text + "\"" + space,
+                    SymbolToken{name}, FlonumToken{std::stod(number)}, StringToken{text});
+    }
+}
+
 TEST_CASE("Empty string handled correctly") {
     std::stringstream ss;
     Tokenizer tokenizer{&ss};
@@ -0,0 +1,139 @@
+#include "allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "object.h"
+
+ObjectAllocator::~ObjectAllocator() {
+    for (auto& size_class : classes_) {
+        for (auto* chunk : size_class.chunks) {
+            for (size_t i = 0; i < chunk->bumped; ++i) {
+                auto* slot = chunk->Slot(i);
+                if (!Chunk::IsFree(slot)) {
+                    reinterpret_cast<Object*>(slot)->~Object();
+                }
+            }
+            std::free(chunk);
+        }
+    }
+    for (auto* object : large_objects_) {
+        object->~Object();
+        ::operator delete(object);
+    }
+}
+
+void ObjectAllocator::Deallocate(void* memory, size_t size) {
+    --object_count_;
+    if (size > kMaxSmallSize) {
+        std::erase(large_objects_, static_cast<Object*>(memory));
+        ::operator delete(memory);
+        return;
+    }
+    auto& size_class = classes_[ClassIndex(size)];
+    size_class.free_list = new (memory) FreeSlot{.next = size_class.free_list};
+}
+
+void* ObjectAllocator::AllocateSlow(SizeClass& size_class, size_t index) {
+    Chunk* chunk;
+    if (!size_class.bump_chunks.empty()) {
+        chunk = size_class.bump_chunks.back();
+        size_class.bump_chunks.pop_back();
+    } else {
+        chunk = NewChunk((index + 1) * kGranularity);
+        size_class.chunks.push_back(chunk);
+    }
+    size_class.bump_chunk = chunk;
+    chunk->used_since_sweep = true;
+    return chunk->Slot(chunk->bumped++);
+}
+
+void* ObjectAllocator::AllocateLarge(size_t size) {
+    void* memory = ::operator new(size);
+    large_objects_.push_back(static_cast<Object*>(memory));
+    ++object_count_;
+    return memory;
+}
+
+ObjectAllocator::Chunk* ObjectAllocator::NewChunk(size_t slot_size) {
+    void* memory = std::aligned_alloc(kChunkSize, kChunkSize);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    auto* chunk = new (memory) Chunk{.slot_size = static_cast<uint32_t>(slot_size),
+                                     .slot_count = 0,
+                                     .bumped = 0,
+                                     .used_since_sweep = true};
+    chunk->slot_count = (static_cast<std::byte*>(memory) + kChunkSize - chunk->Slot(0)) / slot_size;
+    return chunk;
+}
+
+void ObjectAllocator::Sweep() {
+    for (auto& size_class : classes_) {
+        SweepClass(size_class);
+    }
+    SweepLarge();
+}
+
+void ObjectAllocator::SweepClass(SizeClass& size_class) {
+    FreeSlot* free_list = nullptr;
+    FreeSlot** free_tail = &free_list;
+    size_class.bump_chunks.clear();
+
+    std::erase_if(size_class.chunks, [&](Chunk* chunk) {
+        size_t live = 0;
+        for (size_t i = 0; i < chunk->bumped; ++i) {
+            auto* slot = chunk->Slot(i);
+            if (Chunk::IsFree(slot)) {
+                continue;
+            }
+            auto* object = reinterpret_cast<Object*>(slot);
+            if (object->marked_) {
+                object->marked_ = false;
+                ++live;
+            } else {
+                object->~Object();
+                new (slot) FreeSlot;
+                --object_count_;
+            }
+        }
+
+        if (live == 0) {
+            if (!chunk->used_since_sweep) {
+                std::free(chunk);
+                return true;
+            }
+            chunk->bumped = 0;
+        } else {
+            for (size_t i = 0; i < chunk->bumped; ++i) {
+                auto* slot = chunk->Slot(i);
+                if (Chunk::IsFree(slot)) {
+                    *free_tail = reinterpret_cast<FreeSlot*>(slot);
+                    free_tail = &(*free_tail)->next;
+                }
+            }
+        }
+        chunk->used_since_sweep = false;
+        if (chunk->bumped < chunk->slot_count) {
+            size_class.bump_chunks.push_back(chunk);
+        }
+        return false;
+    });
+
+    *free_tail = nullptr;
+    size_class.free_list = free_list;
+    size_class.bump_chunk = nullptr;
+}
+
+void ObjectAllocator::SweepLarge() {
+    std::erase_if(large_objects_, [&](Object* object) {
+        if (object->marked_) {
+            object->marked_ = false;
+            return false;
+        }
+        object->~Object();
+        ::operator delete(object);
+        --object_count_;
+        return true;
+    });
+}
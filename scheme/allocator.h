@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Object;
+
+// Size-classed storage for heap objects.
+//
+// Small objects live in 64 KiB chunks, one size class per chunk. A chunk is filled by bumping
+// a pointer; slots freed by a sweep are threaded into the free list of their class, and a chunk
+// left without live objects is reset so it is bump-allocated again from the start. Chunks that
+// stay empty for a whole cycle are returned to the system. Larger objects go straight to
+// operator new.
+class ObjectAllocator {
+public:
+    static constexpr size_t kGranularity = 16;
+    static constexpr size_t kMaxSmallSize = 256;
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    ObjectAllocator() = default;
+    ObjectAllocator(const ObjectAllocator&) = delete;
+    ObjectAllocator& operator=(const ObjectAllocator&) = delete;
+    ~ObjectAllocator();
+
+    void* Allocate(size_t size) {
+        if (size > kMaxSmallSize) {
+            return AllocateLarge(size);
+        }
+        auto& size_class = classes_[ClassIndex(size)];
+        ++object_count_;
+        if (auto* slot = size_class.free_list) {
+            size_class.free_list = slot->next;
+            return slot;
+        }
+        if (auto* chunk = size_class.bump_chunk; chunk && chunk->bumped < chunk->slot_count) {
+            chunk->used_since_sweep = true;
+            return chunk->Slot(chunk->bumped++);
+        }
+        return AllocateSlow(size_class, ClassIndex(size));
+    }
+
+    // Returns memory whose object was never constructed.
+    void Deallocate(void* memory, size_t size);
+
+    // Destroys every object that is not marked, clears the marks of the others and
+    // rebuilds the free lists.
+    void Sweep();
+
+    size_t GetObjectCount() const {
+        return object_count_;
+    }
+
+private:
+    static constexpr size_t kClassCount = kMaxSmallSize / kGranularity;
+
+    // A free slot starts with a null word where a live object has its vtable pointer.
+    struct FreeSlot {
+        void* null = nullptr;
+        FreeSlot* next;
+    };
+
+    struct Chunk {
+        uint32_t slot_size;
+        uint32_t slot_count;
+        uint32_t bumped = 0;
+        bool used_since_sweep = true;
+
+        std::byte* Slot(size_t index) {
+            constexpr size_t kHeaderSize = (sizeof(Chunk) + kGranularity - 1) & ~(kGranularity - 1);
+            return reinterpret_cast<std::byte*>(this) + kHeaderSize + index * slot_size;
+        }
+
+        static bool IsFree(const std::byte* slot) {
+            return reinterpret_cast<const FreeSlot*>(slot)->null == nullptr;
+        }
+    };
+
+    struct SizeClass {
+        FreeSlot* free_list = nullptr;
+        Chunk* bump_chunk = nullptr;
+        // Chunks with room left for bump allocation, besides bump_chunk.
+        std::vector<Chunk*> bump_chunks;
+        std::vector<Chunk*> chunks;
+    };
+
+    static constexpr size_t ClassIndex(size_t size) {
+        return size == 0 ? 0 : (size - 1) / kGranularity;
+    }
+
+    void* AllocateSlow(SizeClass& size_class, size_t index);
+    void* AllocateLarge(size_t size);
+    static Chunk* NewChunk(size_t slot_size);
+    void SweepClass(SizeClass& size_class);
+    void SweepLarge();
+
+    std::array<SizeClass, kClassCount> classes_;
+    std::vector<Object*> large_objects_;
+    size_t object_count_ = 0;
+};
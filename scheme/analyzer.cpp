@@ -0,0 +1,832 @@
+#include "analyzer.h"
+#include "compiler.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include "error.h"
+#include "heap.h"
+#include "number.h"
+#include "object.h"
+#include "scheme-string.h"
+#include "vector.h"
+
+namespace {
+bool IsFalse(Value value) {
+    return value.IsBoolean() && value.GetBoolean() == false;
+}
+
+Frame* FrameAt(Frame* env, uint16_t depth) {
+    while (depth--) {
+        env = env->GetParent();
+    }
+    return env;
+}
+
+Value LoadVariable(const VariableRef& ref, Frame* env, const Globals* globals) {
+    auto value = ref.global ? globals->Find(ref.name->GetId())
+                            : FrameAt(env, ref.depth)->GetSlots()[ref.slot];
+    if (value.IsUnbound()) {
+        throw NameError(ref.name->GetName());
+    }
+    return value;
+}
+
+void StoreVariable(const VariableRef& ref, Frame* env, Globals* globals, Value value) {
+    if (ref.global) {
+        globals->Define(ref.name->GetId(), value);
+    } else {
+        FrameAt(env, ref.depth)->GetSlots()[ref.slot] = value;
+    }
+}
+
+struct CallDepth {
+    size_t current = 0;
+    size_t max = kDefaultMaxCallDepth;
+    // Where the outermost Execute is on the native stack.
+    uintptr_t stack_base = 0;
+};
+
+CallDepth& GetCallDepth() {
+    thread_local CallDepth depth;
+    return depth;
+}
+
+uintptr_t GetStackAddress() {
+#if defined(__GNUC__) || defined(__clang__)
+    return reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+#else
+    volatile char probe = 0;
+    return reinterpret_cast<uintptr_t>(&probe);
+#endif
+}
+
+// Calls and the nesting of their arguments recurse on the native stack: a body nested deeply
+// takes more of it per call than the call depth tells.
+void CheckNativeStack() {
+    const auto& depth = GetCallDepth();
+    auto here = GetStackAddress();
+    auto used = here < depth.stack_base ? depth.stack_base - here : here - depth.stack_base;
+    if (used > kMaxNativeStack) {
+        throw RuntimeError("maximum call depth exceeded");
+    }
+}
+
+// Values the tree walker holds outside the heap while it runs, which collections mark.
+class WalkerStacks : public RootSet {
+public:
+    WalkerStacks() {
+        Heap::Instance().AddRootSet(this);
+    }
+    WalkerStacks(const WalkerStacks&) = delete;
+    WalkerStacks& operator=(const WalkerStacks&) = delete;
+
+    ~WalkerStacks() {
+        Heap::Instance().RemoveRootSet(this);
+    }
+
+    void Trace(Heap& heap) const override {
+        for (auto value : arguments) {
+            heap.Mark(value);
+        }
+        for (auto value : activations) {
+            heap.Mark(value);
+        }
+    }
+
+    // The functions of the calls in progress, each followed by the values of its arguments.
+    // Arguments are passed on as a span of the stack, so a call doesn't allocate once the stack
+    // has grown.
+    std::vector<Value> arguments;
+    // The closure and the frame of every closure call in progress, the frame null when it
+    // comes from the FramePool.
+    std::vector<Value> activations;
+};
+
+WalkerStacks& GetStacks() {
+    thread_local WalkerStacks stacks;
+    return stacks;
+}
+
+std::vector<Value>& ArgumentStack() {
+    return GetStacks().arguments;
+}
+
+// Keeps the closure a call runs and its frame while the call is in progress: after a tail
+// call, nothing else refers to them.
+class Activation {
+public:
+    Activation() : stack_(GetStacks().activations), index_(stack_.size()) {
+        stack_.resize(index_ + 2);
+    }
+    Activation(const Activation&) = delete;
+    Activation& operator=(const Activation&) = delete;
+
+    ~Activation() {
+        stack_.resize(index_);
+    }
+
+    void Set(Closure* closure, Frame* frame) {
+        stack_[index_] = closure;
+        stack_[index_ + 1] = frame;
+    }
+
+private:
+    std::vector<Value>& stack_;
+    size_t index_;
+};
+
+// Drops the arguments pushed during its lifetime, also when an exception is thrown.
+class PushedArguments {
+public:
+    PushedArguments() : stack_(ArgumentStack()), base_(stack_.size()) {
+    }
+    PushedArguments(const PushedArguments&) = delete;
+    PushedArguments& operator=(const PushedArguments&) = delete;
+
+    ~PushedArguments() {
+        Release();
+    }
+
+    void Push(Value value) {
+        stack_.push_back(value);
+    }
+
+    std::span<const Value> Get() const {
+        return {stack_.data() + base_, stack_.size() - base_};
+    }
+
+    void Release() {
+        stack_.resize(base_);
+    }
+
+private:
+    std::vector<Value>& stack_;
+    size_t base_;
+};
+
+class ConstantNode : public Node {
+public:
+    explicit ConstantNode(Value value) : value_(value) {
+    }
+
+    Value Execute(Frame*) const override {
+        return value_;
+    }
+
+    void Compile(Compiler& compiler, bool) const override {
+        compiler.CompileConstant(value_);
+    }
+
+private:
+    Value value_;
+};
+
+class VariableNode : public Node {
+public:
+    VariableNode(const VariableRef& ref, Globals* globals) : ref_(ref), globals_(globals) {
+    }
+
+    Value Execute(Frame* env) const override {
+        return LoadVariable(ref_, env, globals_);
+    }
+
+    void Compile(Compiler& compiler, bool) const override {
+        compiler.CompileVariable(ref_);
+    }
+
+    const VariableRef& GetRef() const {
+        return ref_;
+    }
+
+private:
+    VariableRef ref_;
+    Globals* globals_;
+};
+
+// Holds an error found during analysis until the form is executed.
+class ErrorNode : public Node {
+public:
+    explicit ErrorNode(std::exception_ptr error) : error_(std::move(error)) {
+    }
+
+    Value Execute(Frame*) const override {
+        std::rethrow_exception(error_);
+    }
+
+    void Compile(Compiler& compiler, bool) const override {
+        compiler.CompileError(error_);
+    }
+
+private:
+    std::exception_ptr error_;
+};
+
+class DefineNode : public Node {
+public:
+    DefineNode(const VariableRef& ref, Globals* globals, NodePtr value)
+        : ref_(ref), globals_(globals), value_(std::move(value)) {
+    }
+
+    Value Execute(Frame* env) const override {
+        StoreVariable(ref_, env, globals_, value_->Execute(env));
+        return ref_.name;
+    }
+
+    void Compile(Compiler& compiler, bool) const override {
+        compiler.CompileDefine(ref_, *value_);
+    }
+
+private:
+    VariableRef ref_;
+    Globals* globals_;
+    NodePtr value_;
+};
+
+class SetNode : public Node {
+public:
+    SetNode(const VariableRef& ref, Globals* globals, NodePtr value)
+        : ref_(ref), globals_(globals), value_(std::move(value)) {
+    }
+
+    Value Execute(Frame* env) const override {
+        LoadVariable(ref_, env, globals_);
+        StoreVariable(ref_, env, globals_, value_->Execute(env));
+        return nullptr;
+    }
+
+    void Compile(Compiler& compiler, bool) const override {
+        compiler.CompileSet(ref_, *value_);
+    }
+
+private:
+    VariableRef ref_;
+    Globals* globals_;
+    NodePtr value_;
+};
+
+class IfNode : public Node {
+public:
+    IfNode(NodePtr condition, NodePtr consequent, NodePtr alternative)
+        : condition_(std::move(condition)),
+          consequent_(std::move(consequent)),
+          alternative_(std::move(alternative)) {
+    }
+
+    Value Execute(Frame* env) const override {
+        const auto& branch = IsFalse(condition_->Execute(env)) ? alternative_ : consequent_;
+        return branch ? branch->Execute(env) : nullptr;
+    }
+
+    Value ExecuteTail(Frame* env, TailCall* tail) const override {
+        const auto& branch = IsFalse(condition_->Execute(env)) ? alternative_ : consequent_;
+        return branch ? branch->ExecuteTail(env, tail) : nullptr;
+    }
+
+    void Compile(Compiler& compiler, bool tail) const override {
+        compiler.CompileIf(*condition_, consequent_.get(), alternative_.get(), tail);
+    }
+
+private:
+    NodePtr condition_;
+    NodePtr consequent_;
+    NodePtr alternative_;
+};
+
+class AndNode : public Node {
+public:
+    explicit AndNode(std::vector<NodePtr> operands) : operands_(std::move(operands)) {
+    }
+
+    Value Execute(Frame* env) const override {
+        Value result = kTrue;
+        for (const auto& operand : operands_) {
+            result = operand->Execute(env);
+            if (IsFalse(result)) {
+                return kFalse;
+            }
+        }
+        return result;
+    }
+
+    Value ExecuteTail(Frame* env, TailCall* tail) const override {
+        if (operands_.empty()) {
+            return kTrue;
+        }
+        for (size_t i = 0; i + 1 < operands_.size(); ++i) {
+            if (IsFalse(operands_[i]->Execute(env))) {
+                return kFalse;
+            }
+        }
+        return operands_.back()->ExecuteTail(env, tail);
+    }
+
+    void Compile(Compiler& compiler, bool tail) const override {
+        compiler.CompileAnd(operands_, tail);
+    }
+
+private:
+    std::vector<NodePtr> operands_;
+};
+
+class OrNode : public Node {
+public:
+    explicit OrNode(std::vector<NodePtr> operands) : operands_(std::move(operands)) {
+    }
+
+    Value Execute(Frame* env) const override {
+        for (const auto& operand : operands_) {
+            auto result = operand->Execute(env);
+            if (!IsFalse(result)) {
+                return result;
+            }
+        }
+        return kFalse;
+    }
+
+    Value ExecuteTail(Frame* env, TailCall* tail) const override {
+        if (operands_.empty()) {
+            return kFalse;
+        }
+        for (size_t i = 0; i + 1 < operands_.size(); ++i) {
+            if (auto result = operands_[i]->Execute(env); !IsFalse(result)) {
+                return result;
+            }
+        }
+        return operands_.back()->ExecuteTail(env, tail);
+    }
+
+    void Compile(Compiler& compiler, bool tail) const override {
+        compiler.CompileOr(operands_, tail);
+    }
+
+private:
+    std::vector<NodePtr> operands_;
+};
+
+class BeginNode : public Node {
+public:
+    explicit BeginNode(std::vector<NodePtr> forms) : forms_(std::move(forms)) {
+    }
+
+    Value Execute(Frame* env) const override {
+        Value result;
+        for (const auto& form : forms_) {
+            result = form->Execute(env);
+        }
+        return result;
+    }
+
+    Value ExecuteTail(Frame* env, TailCall* tail) const override {
+        for (size_t i = 0; i + 1 < forms_.size(); ++i) {
+            forms_[i]->Execute(env);
+        }
+        return forms_.back()->ExecuteTail(env, tail);
+    }
+
+    void Compile(Compiler& compiler, bool tail) const override {
+        compiler.CompileBegin(forms_, tail);
+    }
+
+private:
+    std::vector<NodePtr> forms_;
+};
+
+class LambdaNode : public Node {
+public:
+    explicit LambdaNode(std::shared_ptr<const LambdaCode> code) : code_(std::move(code)) {
+    }
+
+    Value Execute(Frame* env) const override {
+        return Make<Closure>(code_, env);
+    }
+
+    void Compile(Compiler& compiler, bool) const override {
+        compiler.CompileLambda(*code_);
+    }
+
+private:
+    std::shared_ptr<const LambdaCode> code_;
+};
+
+class CallNode : public Node {
+public:
+    CallNode(NodePtr function, std::vector<NodePtr> args)
+        : function_(std::move(function)), args_(std::move(args)) {
+    }
+
+    Value Execute(Frame* env) const override {
+        CheckNativeStack();
+        return Apply(EvaluateFunction(env), env);
+    }
+
+    Value ExecuteTail(Frame* env, TailCall* tail) const override {
+        CheckNativeStack();
+        auto function = EvaluateFunction(env);
+        if (!Is<Closure>(function)) {
+            return Apply(function, env);
+        }
+        // The closure releases the arguments, and the closure itself below them.
+        auto& stack = ArgumentStack();
+        stack.push_back(function);
+        for (const auto& arg : args_) {
+            stack.push_back(arg->Execute(env));
+        }
+        tail->closure = As<Closure>(function);
+        tail->argc = args_.size();
+        return nullptr;
+    }
+
+    void Compile(Compiler& compiler, bool tail) const override {
+        if (auto* variable = dynamic_cast<const VariableNode*>(function_.get())) {
+            compiler.CompileCall(variable->GetRef(), args_, tail);
+        } else {
+            compiler.CompileCall(*function_, args_, tail);
+        }
+    }
+
+private:
+    Value EvaluateFunction(Frame* env) const {
+        auto function = function_->Execute(env);
+        if (!Is<Function>(function)) {
+            throw RuntimeError("Expected function applying");
+        }
+        return function;
+    }
+
+    Value Apply(Value function, Frame* env) const {
+        // The function is kept below its arguments while they are evaluated.
+        PushedArguments args;
+        args.Push(function);
+        for (const auto& arg : args_) {
+            args.Push(arg->Execute(env));
+        }
+        Heap::Instance().CollectAtSafePoint();
+        return (*As<Function>(function))(args.Get().subspan(1));
+    }
+
+    NodePtr function_;
+    std::vector<NodePtr> args_;
+};
+
+class Analyzer {
+public:
+    explicit Analyzer(Globals* globals) : globals_(globals) {
+    }
+
+    NodePtr Analyze(Value expr) {
+        // Analysis, compilation and execution recurse on the nesting of the expression.
+        if (nesting_ == kMaxNesting) {
+            return std::make_unique<ErrorNode>(
+                std::make_exception_ptr(RuntimeError("expression is nested too deeply")));
+        }
+        ++nesting_;
+        NodePtr node;
+        try {
+            node = AnalyzeExpression(expr);
+        } catch (const SyntaxError&) {
+            node = std::make_unique<ErrorNode>(std::current_exception());
+        } catch (const RuntimeError&) {
+            node = std::make_unique<ErrorNode>(std::current_exception());
+        }
+        --nesting_;
+        return node;
+    }
+
+private:
+    NodePtr AnalyzeExpression(Value expr) {
+        if (IsNumeric(expr) || expr.IsBoolean() || Is<Vector>(expr) || Is<String>(expr)) {
+            return std::make_unique<ConstantNode>(expr);
+        }
+        if (Is<Symbol>(expr)) {
+            return std::make_unique<VariableNode>(Resolve(As<Symbol>(expr)), globals_);
+        }
+        if (!Is<Cell>(expr)) {
+            throw RuntimeError("can't evaluate list");
+        }
+        return AnalyzeList(expr);
+    }
+
+    NodePtr AnalyzeList(Value expr) {
+        using SpecialForm = NodePtr (Analyzer::*)(Value);
+        // Symbols are per thread, so is the table.
+        thread_local const std::pair<Symbol*, SpecialForm> kSpecialForms[] = {
+            {Symbol::Intern("quote"), &Analyzer::AnalyzeQuote},
+            {Symbol::Intern("define"), &Analyzer::AnalyzeDefine},
+            {Symbol::Intern("set!"), &Analyzer::AnalyzeSet},
+            {Symbol::Intern("if"), &Analyzer::AnalyzeIf},
+            {Symbol::Intern("lambda"), &Analyzer::AnalyzeLambdaForm},
+            {Symbol::Intern("and"), &Analyzer::AnalyzeAnd},
+            {Symbol::Intern("or"), &Analyzer::AnalyzeOr},
+            {Symbol::Intern("begin"), &Analyzer::AnalyzeBegin}};
+
+        auto head = As<Cell>(expr)->GetFirst();
+        // A parameter or a local named like a special form shadows it.
+        if (Is<Symbol>(head) && Resolve(As<Symbol>(head)).global) {
+            for (const auto& [name, analyze] : kSpecialForms) {
+                if (head == Value(name)) {
+                    return (this->*analyze)(expr);
+                }
+            }
+        }
+        return AnalyzeCall(expr);
+    }
+
+    std::vector<NodePtr> AnalyzeAll(const std::vector<Value>& exprs) {
+        std::vector<NodePtr> nodes;
+        nodes.reserve(exprs.size());
+        for (auto expr : exprs) {
+            nodes.push_back(Analyze(expr));
+        }
+        return nodes;
+    }
+
+    NodePtr AnalyzeQuote(Value expr) {
+        auto args = As<Cell>(expr)->GetSecond();
+        if (!Is<Cell>(args) || !As<Cell>(args)->GetSecond().IsNil()) {
+            throw RuntimeError("Wrong structure for quote function");
+        }
+        return std::make_unique<ConstantNode>(As<Cell>(args)->GetFirst());
+    }
+
+    NodePtr AnalyzeDefine(Value expr) {
+        auto args = CellToVector(As<Cell>(expr)->GetSecond());
+        if (args.empty()) {
+            throw SyntaxError("\"define\" takes 2 arguments");
+        }
+        if (Is<Symbol>(args[0])) {
+            if (args.size() != 2) {
+                throw SyntaxError("\"define\" takes 2 arguments");
+            }
+            return std::make_unique<DefineNode>(Resolve(As<Symbol>(args[0])), globals_,
+                                                Analyze(args[1]));
+        }
+        if (Is<Cell>(args[0])) {
+            if (args.size() < 2) {
+                throw SyntaxError("\"define\" with lambda-sugar takes at least 2 arguments");
+            }
+            auto signature = As<Cell>(args[0]);
+            if (!Is<Symbol>(signature->GetFirst())) {
+                throw SyntaxError("\"define\" 1st argument must be symbol or list");
+            }
+            auto body = As<Cell>(As<Cell>(expr)->GetSecond())->GetSecond();
+            return std::make_unique<DefineNode>(Resolve(As<Symbol>(signature->GetFirst())),
+                                                globals_,
+                                                AnalyzeLambda(signature->GetSecond(), body, expr));
+        }
+        throw SyntaxError("\"define\" 1st argument must be symbol or list");
+    }
+
+    NodePtr AnalyzeSet(Value expr) {
+        auto args = CellToVector(As<Cell>(expr)->GetSecond());
+        if (args.size() != 2) {
+            throw SyntaxError("\"set!\" takes 2 arguments");
+        }
+        if (!Is<Symbol>(args[0])) {
+            throw SyntaxError("\"set!\" 1st argument must be symbol");
+        }
+        return std::make_unique<SetNode>(Resolve(As<Symbol>(args[0])), globals_,
+                                         Analyze(args[1]));
+    }
+
+    NodePtr AnalyzeIf(Value expr) {
+        auto args = CellToVector(As<Cell>(expr)->GetSecond());
+        if (args.empty() || args.size() > 3) {
+            throw SyntaxError("\"if\" must have at least 1 argument and at most 3 arguments");
+        }
+        auto nodes = AnalyzeAll(args);
+        nodes.resize(3);
+        return std::make_unique<IfNode>(std::move(nodes[0]), std::move(nodes[1]),
+                                        std::move(nodes[2]));
+    }
+
+    NodePtr AnalyzeLambdaForm(Value expr) {
+        auto args = As<Cell>(expr)->GetSecond();
+        if (CellToVector(args).size() < 2) {
+            throw SyntaxError("\"lambda\" must have at least 2 arguments");
+        }
+        return AnalyzeLambda(As<Cell>(args)->GetFirst(), As<Cell>(args)->GetSecond(), expr);
+    }
+
+    NodePtr AnalyzeAnd(Value expr) {
+        return std::make_unique<AndNode>(AnalyzeAll(CellToVector(As<Cell>(expr)->GetSecond())));
+    }
+
+    NodePtr AnalyzeOr(Value expr) {
+        return std::make_unique<OrNode>(AnalyzeAll(CellToVector(As<Cell>(expr)->GetSecond())));
+    }
+
+    NodePtr AnalyzeBegin(Value expr) {
+        auto forms = CellToVector(As<Cell>(expr)->GetSecond());
+        if (forms.empty()) {
+            throw SyntaxError("\"begin\" must have at least 1 argument");
+        }
+        return std::make_unique<BeginNode>(AnalyzeAll(forms));
+    }
+
+    NodePtr AnalyzeCall(Value expr) {
+        auto function = Analyze(As<Cell>(expr)->GetFirst());
+        return std::make_unique<CallNode>(std::move(function),
+                                          AnalyzeAll(CellToVector(As<Cell>(expr)->GetSecond())));
+    }
+
+    // params is the parameter list, body the list of body forms.
+    NodePtr AnalyzeLambda(Value params, Value body, Value source) {
+        auto code = std::make_shared<LambdaCode>();
+        for (auto name : CellToVector(params)) {
+            if (!Is<Symbol>(name)) {
+                throw SyntaxError("lambda args names must be symbols");
+            }
+            code->params.push_back(As<Symbol>(name));
+        }
+        auto body_forms = CellToVector(body);
+        CollectDefinitions(body_forms, *code);
+        if (code->GetFrameSize() > std::numeric_limits<uint16_t>::max()) {
+            throw SyntaxError("lambda has too many variables");
+        }
+
+        // Closures of the new lambda keep the frames of the enclosing ones.
+        for (auto* lambda : lambdas_) {
+            lambda->frame_captured = true;
+        }
+        lambdas_.push_back(code.get());
+        try {
+            code->body = AnalyzeAll(body_forms);
+        } catch (...) {
+            lambdas_.pop_back();
+            throw;
+        }
+        lambdas_.pop_back();
+        code->source = source;
+        return std::make_unique<LambdaNode>(std::move(code));
+    }
+
+    // Declares in the lambda every name a define in the body binds, wherever the define is,
+    // before the body is analyzed: the body may refer to a name defined after the reference.
+    static void CollectDefinitions(const std::vector<Value>& body, LambdaCode& code) {
+        thread_local Symbol* const kQuote = Symbol::Intern("quote");
+        thread_local Symbol* const kLambda = Symbol::Intern("lambda");
+        thread_local Symbol* const kDefine = Symbol::Intern("define");
+
+        // The body isn't analyzed yet, so its nesting is not bounded: no recursion here.
+        std::vector<Value> forms(body.rbegin(), body.rend());
+        while (!forms.empty()) {
+            auto form = forms.back();
+            forms.pop_back();
+            if (!Is<Cell>(form)) {
+                continue;
+            }
+            auto head = As<Cell>(form)->GetFirst();
+            if (head == Value(kQuote) || head == Value(kLambda)) {
+                continue;
+            }
+            auto rest = As<Cell>(form)->GetSecond();
+            if (head == Value(kDefine) && Is<Cell>(rest)) {
+                auto target = As<Cell>(rest)->GetFirst();
+                if (Is<Cell>(target)) {
+                    // The rest is the body of a lambda.
+                    if (Is<Symbol>(As<Cell>(target)->GetFirst())) {
+                        Declare(As<Symbol>(As<Cell>(target)->GetFirst()), code);
+                    }
+                    continue;
+                }
+                if (Is<Symbol>(target)) {
+                    Declare(As<Symbol>(target), code);
+                }
+            }
+            // Parts are visited in order, the order of the locals depends on it.
+            auto parts_begin = forms.size();
+            for (auto part = form; Is<Cell>(part); part = As<Cell>(part)->GetSecond()) {
+                forms.push_back(As<Cell>(part)->GetFirst());
+            }
+            std::reverse(forms.begin() + parts_begin, forms.end());
+        }
+    }
+
+    static void Declare(Symbol* name, LambdaCode& code) {
+        if (std::ranges::find(code.params, name) == code.params.end() &&
+            std::ranges::find(code.locals, name) == code.locals.end()) {
+            code.locals.push_back(name);
+        }
+    }
+
+    VariableRef Resolve(Symbol* name) const {
+        uint16_t depth = 0;
+        for (auto it = lambdas_.rbegin(); it != lambdas_.rend(); ++it) {
+            const auto& params = (*it)->params;
+            if (auto param = std::ranges::find(params, name); param != params.end()) {
+                return {.name = name,
+                        .global = false,
+                        .depth = depth,
+                        .slot = static_cast<uint16_t>(param - params.begin()),
+                        .checked = false};
+            }
+            const auto& locals = (*it)->locals;
+            if (auto local = std::ranges::find(locals, name); local != locals.end()) {
+                return {.name = name,
+                        .global = false,
+                        .depth = depth,
+                        .slot = static_cast<uint16_t>(params.size() + (local - locals.begin())),
+                        .checked = true};
+            }
+            if ((*it)->GetFrameSize() != 0) {
+                if (depth == std::numeric_limits<uint16_t>::max()) {
+                    throw SyntaxError("lambdas are nested too deeply");
+                }
+                ++depth;
+            }
+        }
+        return {.name = name, .global = true, .depth = 0, .slot = 0, .checked = false};
+    }
+
+    static constexpr size_t kMaxNesting = 2000;
+
+    Globals* globals_;
+    size_t nesting_ = 0;
+    // Lambdas whose bodies are being analyzed, innermost last.
+    std::vector<LambdaCode*> lambdas_;
+};
+}  // namespace
+
+NodePtr Analyze(Value expr, Globals* globals) {
+    return Analyzer(globals).Analyze(expr);
+}
+
+Value Execute(const Node& node, size_t max_call_depth) {
+    auto& depth = GetCallDepth();
+    auto saved = depth;
+    // A nested Execute goes on counting the native stack from the outermost one.
+    depth = {.current = 0,
+             .max = max_call_depth,
+             .stack_base = saved.stack_base != 0 ? saved.stack_base : GetStackAddress()};
+    try {
+        auto result = node.Execute(nullptr);
+        depth = saved;
+        return result;
+    } catch (...) {
+        depth = saved;
+        throw;
+    }
+}
+
+Closure::Closure(std::shared_ptr<const LambdaCode> code, Frame* env)
+    : Function(kType), code_(std::move(code)), env_(env) {
+}
+
+Value Closure::operator()(std::span<const Value> args) {
+    // Every nested call takes native stack, tail calls come back here instead of nesting.
+    auto& depth = GetCallDepth();
+    if (depth.current == depth.max) {
+        throw RuntimeError("maximum call depth exceeded");
+    }
+    ++depth.current;
+    struct DepthGuard {
+        CallDepth& depth;
+        ~DepthGuard() {
+            --depth.current;
+        }
+    } depth_guard{depth};
+    TailCall tail;
+    auto* closure = this;
+    FramePool::Scope frames(FramePool::Instance());
+    Activation activation;
+    PushedArguments tail_args;
+    for (;;) {
+        const auto& code = *closure->code_;
+        if (args.size() != code.params.size()) {
+            throw RuntimeError("\"lambda\": not equal amount of arguments");
+        }
+        // The frame of the previous tail call is dead.
+        frames.Release();
+        auto* env = closure->env_;
+        auto pooled = false;
+        if (auto frame_size = code.GetFrameSize(); frame_size != 0) {
+            pooled = !code.frame_captured;
+            env = pooled ? FramePool::Instance().Acquire(env, frame_size)
+                         : Frame::Create(env, frame_size);
+            std::ranges::copy(args, env->GetSlots());
+        }
+        activation.Set(closure, pooled ? nullptr : env);
+        tail_args.Release();
+        for (size_t i = 0; i + 1 < code.body.size(); ++i) {
+            code.body[i]->Execute(env);
+        }
+        tail.closure = nullptr;
+        auto result = code.body.back()->ExecuteTail(env, &tail);
+        if (tail.closure == nullptr) {
+            return result;
+        }
+        closure = tail.closure;
+        args = tail_args.Get().subspan(1);
+        assert(args.size() == tail.argc);
+        Heap::Instance().CollectAtSafePoint();
+    }
+}
+
+void Closure::Trace(Heap& heap) const {
+    heap.Mark(code_->source);
+    heap.Mark(env_);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "object.h"
+#include "scope.h"
+
+class Closure;
+class Compiler;
+
+// Where a variable lives. Parameters and internal definitions are slots of a frame, counted
+// outwards from the current one; frames are only created for lambdas that have variables.
+// Everything else is a global.
+struct VariableRef {
+    Symbol* name;
+    bool global;
+    uint16_t depth;
+    uint16_t slot;
+    // Internal definitions may be read before they are made.
+    bool checked;
+};
+
+// A call to a closure in tail position, left for the caller to make, so that tail calls run in
+// constant native stack. Its arguments are the last argc values on the argument stack, with the
+// closure below them.
+struct TailCall {
+    Closure* closure = nullptr;
+    size_t argc = 0;
+};
+
+// Expressions are analyzed once into a tree of nodes: special forms are recognized, their
+// syntax checked and variables resolved up front, so executing a node only evaluates.
+class Node {
+public:
+    virtual ~Node() = default;
+
+    virtual Value Execute(Frame* env) const = 0;
+    // Executes the node in tail position. A call to a closure is not made but stored in tail.
+    virtual Value ExecuteTail(Frame* env, TailCall* /*tail*/) const {
+        return Execute(env);
+    }
+    // Emits the bytecode of the node. tail is true when its value is returned by the enclosing
+    // procedure.
+    virtual void Compile(Compiler& compiler, bool tail) const = 0;
+};
+
+using NodePtr = std::unique_ptr<Node>;
+
+// Body of a lambda expression, shared by every closure created from it.
+struct LambdaCode {
+    std::vector<Symbol*> params;
+    // Names defined by the body, other than the params. They take the frame slots after them.
+    std::vector<Symbol*> locals;
+    std::vector<NodePtr> body;
+    // The lambda expression itself, which keeps the quoted constants of the body alive.
+    Value source;
+    // A lambda in the body may capture the frame, which then outlives the call. Other frames
+    // come from the FramePool.
+    bool frame_captured = false;
+
+    uint32_t GetFrameSize() const {
+        return params.size() + locals.size();
+    }
+};
+
+class Closure : public Function {
+public:
+    static constexpr ObjectType kType = ObjectType::kClosure;
+
+    Closure(std::shared_ptr<const LambdaCode> code, Frame* env);
+
+    Value operator()(std::span<const Value> args) override;
+
+    void Trace(Heap& heap) const override;
+
+private:
+    std::shared_ptr<const LambdaCode> code_;
+    Frame* env_;
+};
+
+// Syntax errors are reported when the offending form is executed, as the list-walking
+// evaluator did: an unevaluated branch may hold anything. Global variables are resolved
+// in globals.
+NodePtr Analyze(Value expr, Globals* globals);
+
+// The tree walker recurses on the native stack for every non-tail call and for the nesting of
+// the expressions around it. It raises a RuntimeError before its recursion takes more than
+// kMaxNativeStack bytes, whatever the call depth, so it needs that much native stack and some
+// to spare.
+inline constexpr size_t kDefaultMaxCallDepth = 1'000'000;
+inline constexpr size_t kMaxNativeStack = 6 << 20;
+
+// Executes a top-level form with the tree walker. Nesting more than max_call_depth non-tail
+// calls raises a RuntimeError.
+Value Execute(const Node& node, size_t max_call_depth);
@@ -0,0 +1,70 @@
+#include "scheme.h"
+
+#include <chrono>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <utility>
+
+// Runs the same programs under every execution mode.
+//   fib:   non-tail recursion, global lookups and arithmetic on fixnums;
+//   loop:  a self tail call counting down, in a loop of its own;
+//   lists: building and walking short lists;
+//   dedup: counting the distinct keys among many, half of them repeated, in an equal? table;
+//   format: building log lines out of literals and numbers with string-append.
+
+namespace {
+
+struct Program {
+    const char* name;
+    std::initializer_list<const char*> setup;
+    const char* run;
+};
+
+const Program kPrograms[] = {
+    {"fib",
+     {"(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))"},
+     "(fib 25)"},
+    {"loop",
+     {"(define (count n acc) (if (= n 0) acc (count (- n 1) (+ acc 1))))",
+      "(define (repeat k acc) (if (= k 0) acc (repeat (- k 1) (+ acc (count 1000 0)))))"},
+     "(repeat 300 0)"},
+    {"lists",
+     {"(define (build n acc) (if (= n 0) acc (build (- n 1) (cons n acc))))",
+      "(define (sum l acc) (if (null? l) acc (sum (cdr l) (+ acc (car l)))))",
+      "(define (run k acc) (if (= k 0) acc (run (- k 1) (+ acc (sum (build 500 '()) 0)))))"},
+     "(run 300 0)"},
+    {"dedup",
+     {"(define t (make-hash-table))",
+      "(define (key i) (list (- i (* (/ i 100000) 100000)) 'k))",
+      "(define (dedup i n) (if (= i n) (hash-table-count t) "
+      "(begin (hash-table-set! t (key i) i) (dedup (+ i 1) n))))"},
+     "(dedup 0 200000)"},
+    {"format",
+     {"(define (line i) (string-append \"[\" (number->string i) \"] level=info \" "
+      "\"user=\" (symbol->string 'root) \" msg=\" \"request served\"))",
+      "(define (format i n total) (if (= i n) total "
+      "(format (+ i 1) n (+ total (string-length (line i))))))"},
+     "(format 0 100000 0)"},
+};
+
+void Measure(const char* mode_name, ExecutionMode mode, const Program& program) {
+    Scheme scheme(mode);
+    for (const auto* form : program.setup) {
+        scheme.Evaluate(form);
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto result = scheme.Evaluate(program.run);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << program.name << " " << mode_name << ": " << elapsed.count() << " ms (" << result
+              << ")\n";
+}
+
+}  // namespace
+
+int main() {
+    for (const auto& program : kPrograms) {
+        Measure("tree-walker", ExecutionMode::kTreeWalker, program);
+        Measure("bytecode", ExecutionMode::kBytecode, program);
+    }
+}
@@ -0,0 +1,65 @@
+#include "scheme.h"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Startup of a bytecode Scheme that serves requests with a generated prelude of procedures and
+// tables, by evaluating the prelude and by restoring an image saved after evaluating it.
+
+namespace {
+
+constexpr int kProcedures = 5000;
+constexpr int kRules = 20000;
+
+std::string MakePrelude() {
+    std::string prelude = "(define rules (make-hash-table))\n";
+    for (int i = 0; i < kProcedures; ++i) {
+        auto id = std::to_string(i);
+        prelude += "(define (handler-" + id + " request) (if (< request " + id +
+                   ") (list 'below request) (helper-" + id + " (- request 1))))\n";
+        prelude += "(define (helper-" + id + " x) (* x " + id + "))\n";
+    }
+    for (int i = 0; i < kRules; ++i) {
+        auto id = std::to_string(i);
+        prelude += "(hash-table-set! rules 'rule-" + id + " '(match (path \"/api/" + id +
+                   "\") (weight " + std::to_string(i % 97) + ") (action allow)))\n";
+    }
+    return prelude;
+}
+
+template <class Start>
+void Measure(const char* name, Start start) {
+    auto begin = std::chrono::steady_clock::now();
+    Scheme scheme(ExecutionMode::kBytecode);
+    start(scheme);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+    std::cout << name << ": " << elapsed.count() << " ms ("
+              << scheme.Evaluate("(list (handler-4999 7) (hash-table-count rules))") << ")\n";
+}
+
+}  // namespace
+
+int main() {
+    auto directory = std::filesystem::temp_directory_path();
+    auto prelude = directory / "scheme-bench-prelude.scm";
+    auto image = directory / "scheme-bench-prelude.image";
+    std::ofstream(prelude) << MakePrelude();
+    {
+        Scheme scheme(ExecutionMode::kBytecode);
+        scheme.Load(prelude);
+        scheme.SaveImage(image);
+    }
+    std::cout << "prelude: " << std::filesystem::file_size(prelude) / double(1 << 20)
+              << " MB of text, " << std::filesystem::file_size(image) / double(1 << 20)
+              << " MB of image\n";
+
+    Measure("evaluate prelude", [&](Scheme& scheme) { scheme.Load(prelude); });
+    Measure("restore image", [&](Scheme& scheme) { scheme.LoadImage(image); });
+
+    std::filesystem::remove(prelude);
+    std::filesystem::remove(image);
+}
@@ -0,0 +1,64 @@
+#include "scheme.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Loading a program of many small top-level forms, as rule files are:
+//   per-form: one Evaluate call per form, the program split up beforehand;
+//   program:  EvaluateAll over the program text;
+//   stream:   EvaluateAll reading a std::istringstream.
+
+namespace {
+
+constexpr int kRules = 50000;
+
+std::vector<std::string> MakeForms() {
+    std::vector<std::string> forms;
+    forms.push_back("(define rules (make-hash-table))");
+    for (int i = 0; i < kRules; ++i) {
+        auto id = std::to_string(i);
+        forms.push_back("(hash-table-set! rules 'rule-" + id + " '(match (path \"/api/" + id +
+                        "\") (weight " + std::to_string(i % 97) + ") (action allow)))");
+    }
+    forms.push_back("(hash-table-count rules)");
+    return forms;
+}
+
+template <class Load>
+void Measure(const char* name, ExecutionMode mode, Load load) {
+    Scheme scheme(mode);
+    auto start = std::chrono::steady_clock::now();
+    auto result = load(scheme);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() << " ms (" << result << ")\n";
+}
+
+}  // namespace
+
+int main() {
+    auto forms = MakeForms();
+    std::string program;
+    for (const auto& form : forms) {
+        program += form;
+        program += '\n';
+    }
+    for (auto mode : {ExecutionMode::kTreeWalker, ExecutionMode::kBytecode}) {
+        std::cout << (mode == ExecutionMode::kTreeWalker ? "tree-walker\n" : "bytecode\n");
+        Measure("  per-form", mode, [&forms](Scheme& scheme) {
+            std::string result;
+            for (const auto& form : forms) {
+                result = scheme.Evaluate(form);
+            }
+            return result;
+        });
+        Measure("  program", mode,
+                [&program](Scheme& scheme) { return scheme.EvaluateAll(program); });
+        Measure("  stream", mode, [&program](Scheme& scheme) {
+            std::istringstream input{program};
+            return scheme.EvaluateAll(&input);
+        });
+    }
+}
@@ -0,0 +1,66 @@
+#include "scheme.h"
+
+#include <chrono>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+// Numeric code under every execution mode.
+//   fixnum:    a loop of additions and multiplications that never leaves the fixnum range,
+//              so it measures the cost of the overflow checks;
+//   factorial: products growing into bignums of a few hundred limbs;
+//   flonum:    long variadic sums of flonums, which take the vectorized reduction;
+//   dot:       one dot product of f64vectors written in Scheme, against a hundred by the
+//              native kernel.
+
+namespace {
+
+struct Program {
+    const char* name;
+    std::initializer_list<const char*> setup;
+    const char* run;
+};
+
+const Program kPrograms[] = {
+    {"fixnum",
+     {"(define (sum n acc) (if (= n 0) acc (sum (- n 1) (+ acc (* n 3)))))"},
+     "(sum 1000000 0)"},
+    {"factorial",
+     {"(define (fact n acc) (if (= n 0) acc (fact (- n 1) (* acc n))))",
+      "(define (repeat k) (if (= k 0) (fact 1000 1) (begin (fact 1000 1) (repeat (- k 1)))))"},
+     "(< 0 (repeat 20))"},
+    {"flonum",
+     {"(define (sum k acc) (if (= k 0) acc (sum (- k 1) (+ acc (+ 0.5 1.5 2.5 3.5 4.5 5.5 6.5 "
+      "7.5 8.5 9.5 10.5 11.5 12.5 13.5 14.5 15.5)))))"},
+     "(sum 100000 0.0)"},
+    {"dot interpreted",
+     {"(define v (make-f64vector 100000 1.5))",
+      "(define (dot i acc) (if (= i 100000) acc "
+      "(dot (+ i 1) (+ acc (* (f64vector-ref v i) (f64vector-ref v i))))))"},
+     "(dot 0 0.0)"},
+    {"dot kernel",
+     {"(define v (make-f64vector 100000 1.5))",
+      "(define (repeat k acc) (if (= k 0) acc (repeat (- k 1) (+ acc (f64vector-dot v v)))))"},
+     "(repeat 100 0.0)"},
+};
+
+void Measure(const char* mode_name, ExecutionMode mode, const Program& program) {
+    Scheme scheme(mode);
+    for (const auto* form : program.setup) {
+        scheme.Evaluate(form);
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto result = scheme.Evaluate(program.run);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << program.name << " " << mode_name << ": " << elapsed.count() << " ms (" << result
+              << ")\n";
+}
+
+}  // namespace
+
+int main() {
+    for (const auto& program : kPrograms) {
+        Measure("tree-walker", ExecutionMode::kTreeWalker, program);
+        Measure("bytecode", ExecutionMode::kBytecode, program);
+    }
+}
@@ -0,0 +1,54 @@
+#include "scheme.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+// Printing a result list of about 20 MB, as batch jobs do:
+//   string: Evaluate returning the printed result;
+//   stream: Evaluate writing it to a stream as it goes, here one that only counts bytes.
+
+namespace {
+
+struct CountingBuffer : std::streambuf {
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        size += count;
+        return count;
+    }
+
+    int_type overflow(int_type c) override {
+        ++size;
+        return c;
+    }
+
+    size_t size = 0;
+};
+
+template <class Print>
+void Measure(const char* name, Print print) {
+    auto start = std::chrono::steady_clock::now();
+    auto size = print();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() << " ms (" << size << " bytes)\n";
+}
+
+}  // namespace
+
+int main() {
+    Scheme scheme(ExecutionMode::kBytecode);
+    scheme.Evaluate(
+        "(define (row i) (list i (number->string i) 1.5 (vector 'allow i) '(edge internal)))");
+    scheme.Evaluate("(define (rows n acc) (if (= n 0) acc (rows (- n 1) (cons (row n) acc))))");
+    scheme.Evaluate("(define result (rows 400000 '()))");
+
+    Measure("string", [&] { return scheme.Evaluate("result").size(); });
+    Measure("stream", [&] {
+        CountingBuffer counter;
+        std::ostream out(&counter);
+        scheme.Evaluate("result", &out);
+        return counter.size;
+    });
+}
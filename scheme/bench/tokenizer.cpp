@@ -0,0 +1,72 @@
+#include "tokenizer.h"
+#include "vector-kernels.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+// Tokenizer throughput on a generated corpus of definitions, as configuration files would have:
+// indentation, symbols, numbers and string literals.
+//   view:   scanning the corpus in place;
+//   stream: reading it through a std::istringstream.
+// The scanner uses SSE2 or AVX2 on x86-64; configure with -DSCHEME_AVX2=0 to measure the
+// portable loops instead.
+
+namespace {
+
+constexpr size_t kCorpusSize = 32 << 20;
+constexpr int kRounds = 5;
+
+std::string MakeCorpus() {
+    std::mt19937 random{20240917};
+    std::uniform_int_distribution<int> number{-100000, 100000};
+    std::string corpus;
+    for (size_t i = 0; corpus.size() < kCorpusSize; ++i) {
+        auto id = std::to_string(i);
+        corpus += "(define (handler-" + id + " request-id retry-count)\n";
+        corpus += "    (if (<= retry-count " + std::to_string(number(random)) + ")\n";
+        corpus += "        \"request handled by handler number " + id + "\"\n";
+        corpus += "        (list 'error-code " + std::to_string(number(random)) + " 2.5e-3 #t)))\n";
+    }
+    return corpus;
+}
+
+template <class F>
+void Measure(const char* name, size_t bytes, F&& tokenize) {
+    size_t tokens = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+        tokens = tokenize();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << bytes * kRounds / elapsed.count() / (1 << 20) << " MB/s ("
+              << tokens << " tokens)\n";
+}
+
+size_t CountTokens(Tokenizer* tokenizer) {
+    size_t tokens = 0;
+    for (; !tokenizer->IsEnd(); tokenizer->Next()) {
+        ++tokens;
+    }
+    return tokens;
+}
+
+}  // namespace
+
+int main() {
+    auto corpus = MakeCorpus();
+    std::cout << "AVX2: " << (HasVectorKernelsAvx2() ? "yes" : "no") << "\n";
+    Measure("view", corpus.size(), [&corpus] {
+        Tokenizer tokenizer{std::string_view{corpus}};
+        return CountTokens(&tokenizer);
+    });
+    Measure("stream", corpus.size(), [&corpus] {
+        std::istringstream stream{corpus};
+        Tokenizer tokenizer{&stream};
+        return CountTokens(&tokenizer);
+    });
+}
@@ -1,638 +1,871 @@
 #include "builtin-functions.h"
-#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <compare>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "continuation.h"
+#include "equality.h"
 #include "error.h"
+#include "fasl.h"
+#include "hash-table.h"
+#include "heap.h"
 #include "object.h"
+#include "scheme-string.h"
+#include "vector-kernels.h"
+#include "vector.h"
 
-std::shared_ptr<Object> Evaluate(std::shared_ptr<Object> obj, std::shared_ptr<Scope> scope) {
-    if (Is<Number>(obj) || Is<Boolean>(obj)) {
-        return obj;
+void Builtin::ThrowArityError() const {
+    auto quoted = "\"" + std::string(name_) + "\"";
+    auto arguments = [](uint32_t count) {
+        return std::to_string(count) + (count == 1 ? " argument" : " arguments");
+    };
+    if (min_args_ == max_args_) {
+        throw RuntimeError(quoted + " must have " + arguments(min_args_));
     }
-    if (Is<Symbol>(obj)) {
-        return scope->Get(As<Symbol>(obj)->GetName());
+    if (max_args_ == kVariadic) {
+        throw RuntimeError(quoted + " must have at least " + arguments(min_args_));
     }
-    if (obj == nullptr || !Is<Cell>(obj)) {
-        throw RuntimeError("can't evaluate list");
+    throw RuntimeError(quoted + " must have from " + std::to_string(min_args_) + " to " +
+                       arguments(max_args_));
+}
+
+void Builtin::ThrowTypeError() const {
+    throw RuntimeError("\"" + std::string(name_) + "\" arguments must be numbers");
+}
+
+Value IsBoolean::Apply(std::span<const Value> args) {
+    if (args[0].IsBoolean()) {
+        return kTrue;
     }
-    std::shared_ptr<Cell> func_list = As<Cell>(obj);
-    auto func_expr = func_list->GetFirst();
-    auto args = func_list->GetSecond();
+    return kFalse;
+}
 
-    auto functor = Evaluate(func_expr, scope);
-    if (!Is<Function>(functor)) {
-        throw RuntimeError("Expected function applying");
+Value Not::Apply(std::span<const Value> args) {
+    if (args[0].IsBoolean() && args[0].GetBoolean() == false) {
+        return kTrue;
     }
-    return (*As<Function>(functor))(args, scope);
+    return kFalse;
 }
 
 namespace {
-std::vector<std::shared_ptr<Object>> CellToVector(std::shared_ptr<Object> arg, bool proper = true) {
-    if (arg == nullptr) {
-        return {};
+// The values of args when there are some and all of them are flonums, gathered for a
+// vectorized reduction into a buffer reused across calls.
+std::optional<std::span<const double>> GatherFlonums(std::span<const Value> args) {
+    thread_local std::vector<double> values;
+    if (args.empty()) {
+        return std::nullopt;
     }
-    if (!Is<Cell>(arg)) {
-        if (proper) {
-            throw SyntaxError("Expected proper list");
-        }
-        return {arg};
-    }
-    auto cell = As<Cell>(arg);
-    std::vector<std::shared_ptr<Object>> result;
-    while (cell) {
-        result.push_back(cell->GetFirst());
-        auto second = cell->GetSecond();
-        if (second == nullptr) {
-            break;
-        }
-        if (Is<Cell>(second)) {
-            cell = As<Cell>(second);
-        } else {
-            if (proper) {
-                throw SyntaxError("Expected proper list");
-            }
-            result.push_back(second);
-            break;
+    values.clear();
+    for (auto arg : args) {
+        if (!Is<Flonum>(arg)) {
+            return std::nullopt;
         }
+        values.push_back(As<Flonum>(arg)->GetValue());
+    }
+    return values;
+}
+
+// The chosen argument, inexact if any argument is.
+Value WithContagion(Value result, std::span<const Value> args) {
+    if (!Is<Flonum>(result) && std::ranges::any_of(args, [](Value arg) {
+            return Is<Flonum>(arg);
+        })) {
+        return MakeFlonum(ToDouble(result));
     }
     return result;
 }
+}  // namespace
 
-std::vector<std::shared_ptr<Object>> Evaluate(const std::vector<std::shared_ptr<Object>>& objs,
-                                              std::shared_ptr<Scope> scope) {
-    std::vector<std::shared_ptr<Object>> result;
-    for (auto obj : objs) {
-        result.push_back(Evaluate(obj, scope));
+Value Add::Apply(std::span<const Value> args) {
+    if (auto flonums = GatherFlonums(args)) {
+        return MakeFlonum(VectorSum(*flonums));
+    }
+    Value result = Value::Fixnum(0);
+    for (auto arg : args) {
+        result = AddNumbers(result, arg);
     }
     return result;
 }
 
-void CheckNonEmpty(const std::vector<std::shared_ptr<Object>>& args, const std::string& name) {
-    if (args.empty()) {
-        throw RuntimeError("\"" + name + "\" must have arguments");
+Value Sub::Apply(std::span<const Value> args) {
+    if (args.size() == 1) {
+        return NegateNumber(args[0]);
     }
+    Value result = args[0];
+    for (size_t i = 1; i < args.size(); ++i) {
+        result = SubtractNumbers(result, args[i]);
+    }
+    return result;
 }
 
-void CheckAllNumbers(const std::vector<std::shared_ptr<Object>>& args, const std::string& name) {
+Value Mul::Apply(std::span<const Value> args) {
+    if (auto flonums = GatherFlonums(args)) {
+        return MakeFlonum(VectorProduct(*flonums));
+    }
+    Value result = Value::Fixnum(1);
     for (auto arg : args) {
-        if (!Is<Number>(arg)) {
-            throw RuntimeError("\"" + name + "\" arguments must be numbers");
+        result = MultiplyNumbers(result, arg);
+    }
+    return result;
+}
+
+Value Div::Apply(std::span<const Value> args) {
+    if (args.size() == 1) {
+        return DivideNumbers(Value::Fixnum(1), args[0]);
+    }
+    Value result = args[0];
+    for (size_t i = 1; i < args.size(); ++i) {
+        result = DivideNumbers(result, args[i]);
+    }
+    return result;
+}
+
+namespace {
+// Whether every two adjacent arguments compare as the predicate wants.
+template <class Predicate>
+Value IsMonotonic(std::span<const Value> args, Predicate predicate) {
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (!predicate(CompareNumbers(args[i - 1], args[i]))) {
+            return kFalse;
         }
     }
+    return kTrue;
 }
 }  // namespace
 
-std::shared_ptr<Object> Define::operator()(std::shared_ptr<Object> args,
-                                           std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.empty()) {
-        throw SyntaxError("\"define\" takes 2 arguments");
+Value Less::Apply(std::span<const Value> args) {
+    return IsMonotonic(args, [](std::partial_ordering order) { return order < 0; });
+}
+
+Value LessOrEqual::Apply(std::span<const Value> args) {
+    return IsMonotonic(args, [](std::partial_ordering order) { return order <= 0; });
+}
+
+Value Greater::Apply(std::span<const Value> args) {
+    return IsMonotonic(args, [](std::partial_ordering order) { return order > 0; });
+}
+
+Value GreaterOrEqual::Apply(std::span<const Value> args) {
+    return IsMonotonic(args, [](std::partial_ordering order) { return order >= 0; });
+}
+
+Value Equal::Apply(std::span<const Value> args) {
+    return IsMonotonic(args, [](std::partial_ordering order) { return order == 0; });
+}
+
+Value IsNumber::Apply(std::span<const Value> args) {
+    if (IsNumeric(args[0])) {
+        return kTrue;
     }
-    if (Is<Symbol>(flatten_args[0])) {
-        if (flatten_args.size() != 2) {
-            throw SyntaxError("\"define\" takes 2 arguments");
-        }
-        scope->Set(As<Symbol>(flatten_args[0])->GetName(), Evaluate(flatten_args[1], scope));
-        return flatten_args[0];
+    return kFalse;
+}
+
+Value Min::Apply(std::span<const Value> args) {
+    if (auto flonums = GatherFlonums(args)) {
+        return MakeFlonum(VectorMin(*flonums));
     }
-    if (Is<Cell>(flatten_args[0])) {
-        if (flatten_args.size() < 2) {
-            throw SyntaxError("\"define\" with lambda-sugar takes at least 2 arguments");
+    Value result = args[0];
+    for (auto arg : args) {
+        auto order = CompareNumbers(arg, result);
+        if (order == std::partial_ordering::unordered) {
+            // A NaN makes the result NaN, as in VectorMin.
+            return MakeFlonum(std::numeric_limits<double>::quiet_NaN());
         }
-        auto flatten_func = CellToVector(flatten_args[0]);
-        if (!Is<Symbol>(flatten_func[0])) {
-            throw SyntaxError("\"define\" 1st argument must be symbol or list");
+        if (order < 0) {
+            result = arg;
         }
-        auto lmbd = Lambda()(std::make_shared<Cell>(As<Cell>(flatten_args[0])->GetSecond(),
-                                                    As<Cell>(args)->GetSecond()),
-                             scope);
-        scope->Set(As<Symbol>(flatten_func[0])->GetName(), lmbd);
-        return flatten_func[0];
     }
-    throw SyntaxError("\"define\" 1st argument must be symbol or list");
+    return WithContagion(result, args);
 }
 
-std::shared_ptr<Object> Quote::operator()(std::shared_ptr<Object> args,
-                                          std::shared_ptr<Scope> scope) {
-    if (!Is<Cell>(args) || As<Cell>(args)->GetSecond() != nullptr) {
-        throw RuntimeError("Wrong structure for quote function");
+Value Max::Apply(std::span<const Value> args) {
+    if (auto flonums = GatherFlonums(args)) {
+        return MakeFlonum(VectorMax(*flonums));
     }
-    // std::cout << Scheme::ToString(As<Cell>(args)->GetFirst()) << std::endl;
-    return As<Cell>(args)->GetFirst();
+    Value result = args[0];
+    for (auto arg : args) {
+        auto order = CompareNumbers(arg, result);
+        if (order == std::partial_ordering::unordered) {
+            // A NaN makes the result NaN, as in VectorMax.
+            return MakeFlonum(std::numeric_limits<double>::quiet_NaN());
+        }
+        if (order > 0) {
+            result = arg;
+        }
+    }
+    return WithContagion(result, args);
 }
 
-std::shared_ptr<Object> Set::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.size() != 2) {
-        throw SyntaxError("\"set!\" takes 2 arguments");
+Value Abs::Apply(std::span<const Value> args) {
+    if (Is<Flonum>(args[0])) {
+        return MakeFlonum(std::fabs(As<Flonum>(args[0])->GetValue()));
     }
-    if (!Is<Symbol>(flatten_args[0])) {
-        throw SyntaxError("\"set!\" 1st argument must be symbol");
+    if (CompareNumbers(args[0], Value::Fixnum(0)) < 0) {
+        return NegateNumber(args[0]);
     }
-    const std::string& name = As<Symbol>(flatten_args[0])->GetName();
-    scope->Get(name);
-    scope->Set(name, Evaluate(flatten_args[1], scope));
-    return nullptr;
+    return args[0];
 }
 
-std::shared_ptr<Object> IsBoolean::operator()(std::shared_ptr<Object> args,
-                                              std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.size() != 1) {
-        throw RuntimeError("bool? expects one argument");
-    }
-    if (Is<Boolean>(Evaluate(flatten_args.front(), scope))) {
-        return kTrue;
+Value IsPair::Apply(std::span<const Value> args) {
+    if (args[0].IsNil() || !Is<Cell>(args[0])) {
+        return kFalse;
     }
-    return kFalse;
+    return kTrue;
 }
 
-std::shared_ptr<Object> Not::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.size() != 1) {
-        throw RuntimeError("\"not\" expects 1 argument");
-    }
-    auto evaluated = Evaluate(flatten_args.front(), scope);
-    if (Is<Boolean>(evaluated) && As<Boolean>(evaluated)->GetValue() == false) {
+Value IsNull::Apply(std::span<const Value> args) {
+    if (args[0].IsNil()) {
         return kTrue;
     }
     return kFalse;
 }
 
-std::shared_ptr<Object> And::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    std::shared_ptr<Object> evaluated = kTrue;
-    for (auto arg : flatten_args) {
-        evaluated = Evaluate(arg, scope);
-        if (Is<Boolean>(evaluated) && As<Boolean>(evaluated)->GetValue() == false) {
+Value IsList::Apply(std::span<const Value> args) {
+    // The hare takes two steps for every step of the tortoise, so on a cycle it meets it.
+    auto tortoise = args[0];
+    auto hare = args[0];
+    for (;;) {
+        for (int step = 0; step < 2; ++step) {
+            if (hare.IsNil()) {
+                return kTrue;
+            }
+            if (!Is<Cell>(hare)) {
+                return kFalse;
+            }
+            hare = As<Cell>(hare)->GetSecond();
+        }
+        tortoise = As<Cell>(tortoise)->GetSecond();
+        if (hare == tortoise) {
             return kFalse;
         }
     }
-    return evaluated;
 }
 
-std::shared_ptr<Object> Or::operator()(std::shared_ptr<Object> args, std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    for (auto arg : flatten_args) {
-        auto evaluated = Evaluate(arg, scope);
-        if (!Is<Boolean>(evaluated) || As<Boolean>(evaluated)->GetValue() == true) {
-            return evaluated;
-        }
-    }
-    return kFalse;
+Value Cons::Apply(std::span<const Value> args) {
+    return Make<Cell>(args[0], args[1]);
 }
 
-std::shared_ptr<Object> Add::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    CheckAllNumbers(evaluated, "+");
-    int result = 0;
-    for (auto arg : evaluated) {
-        result += As<Number>(arg)->GetValue();
+Value Car::Apply(std::span<const Value> args) {
+    if (!Is<Cell>(args[0])) {
+        throw RuntimeError("\"car\" argument must be pair-like structure");
+    }
+    if (args[0].IsNil()) {
+        throw RuntimeError("\"cdr\" on nil");
     }
-    return std::make_shared<Number>(result);
+    auto head = As<Cell>(args[0])->GetFirst();
+    return head;
 }
 
-std::shared_ptr<Object> Sub::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.empty()) {
-        throw RuntimeError("\"-\" must have argument");
-    }
-    CheckAllNumbers(evaluated, "-");
-    int result = As<Number>(evaluated[0])->GetValue();
-    if (evaluated.size() == 1) {
-        return std::make_shared<Number>(-result);
+Value Cdr::Apply(std::span<const Value> args) {
+    if (!Is<Cell>(args[0])) {
+        throw RuntimeError("\"cdr\" argument must be pair-like structure");
     }
-    for (size_t i = 1; i < evaluated.size(); ++i) {
-        result -= As<Number>(evaluated[i])->GetValue();
+    if (args[0].IsNil()) {
+        throw RuntimeError("\"cdr\" on nil");
     }
-    return std::make_shared<Number>(result);
+    auto tail = As<Cell>(args[0])->GetSecond();
+    return tail;
 }
 
-std::shared_ptr<Object> Mul::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    CheckAllNumbers(evaluated, "*");
-    int result = 1;
-    for (auto arg : evaluated) {
-        result *= As<Number>(arg)->GetValue();
+Value SetCar::Apply(std::span<const Value> args) {
+    if (!Is<Cell>(args[0])) {
+        throw RuntimeError("\"set-car!\" argument must be pair-like structure");
     }
-    return std::make_shared<Number>(result);
+    As<Cell>(args[0])->SetFirst(args[1]);
+    return nullptr;
 }
 
-std::shared_ptr<Object> Div::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.empty()) {
-        throw RuntimeError("\"/\" must have argument");
+Value SetCdr::Apply(std::span<const Value> args) {
+    if (!Is<Cell>(args[0])) {
+        throw RuntimeError("\"set-cdr!\" argument must be pair-like structure");
     }
-    CheckAllNumbers(evaluated, "/");
-    int result = As<Number>(evaluated[0])->GetValue();
-    if (evaluated.size() == 1) {
-        return std::make_shared<Number>(result == 1 ? 1 : 0);
-    }
-    for (size_t i = 1; i < evaluated.size(); ++i) {
-        result /= As<Number>(evaluated[i])->GetValue();
-    }
-    return std::make_shared<Number>(result);
+    As<Cell>(args[0])->SetSecond(args[1]);
+    return nullptr;
 }
 
-std::shared_ptr<Object> Less::operator()(std::shared_ptr<Object> args,
-                                         std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.empty()) {
-        return kTrue;
-    }
-    CheckAllNumbers(evaluated, "<");
-    int first = As<Number>(evaluated[0])->GetValue();
-    for (size_t i = 1; i < evaluated.size(); ++i) {
-        int next = As<Number>(evaluated[i])->GetValue();
-        if (first >= next) {
-            return kFalse;
-        }
-        first = next;
+Value List::Apply(std::span<const Value> args) {
+    Cell* result = nullptr;
+    size_t last_idx = args.size();
+    while (last_idx) {
+        --last_idx;
+        result = Make<Cell>(args[last_idx], result);
     }
-    return kTrue;
+    return result;
 }
 
-std::shared_ptr<Object> LessOrEqual::operator()(std::shared_ptr<Object> args,
-                                                std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.empty()) {
-        return kTrue;
+Value ListRef::Apply(std::span<const Value> args) {
+    if (!args[1].IsFixnum()) {
+        throw RuntimeError("\"list-ref\" 2nd argument must be number");
     }
-    CheckAllNumbers(evaluated, "<=");
-    int first = As<Number>(evaluated[0])->GetValue();
-    for (size_t i = 1; i < evaluated.size(); ++i) {
-        int next = As<Number>(evaluated[i])->GetValue();
-        if (first > next) {
-            return kFalse;
+    if (args[0].IsNil() || !Is<Cell>(args[0])) {
+        throw RuntimeError("\"list-ref\" 1st argument must be list");
+    }
+    int64_t idx = args[1].GetFixnum();
+    if (idx < 0) {
+        throw RuntimeError("\"list-ref\": index out of range");
+    }
+    auto cell = As<Cell>(args[0]);
+    for (; idx > 0; --idx) {
+        if (!Is<Cell>(cell->GetSecond())) {
+            throw RuntimeError("\"list-ref\": index out of range");
         }
-        first = next;
+        cell = As<Cell>(cell->GetSecond());
     }
-    return kTrue;
+    return cell->GetFirst();
 }
 
-std::shared_ptr<Object> Greater::operator()(std::shared_ptr<Object> args,
-                                            std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.empty()) {
-        return kTrue;
+Value ListTail::Apply(std::span<const Value> args) {
+    if (!args[1].IsFixnum()) {
+        throw RuntimeError("\"list-ref\" 2nd argument must be number");
     }
-    CheckAllNumbers(evaluated, ">");
-    int first = As<Number>(evaluated[0])->GetValue();
-    for (size_t i = 1; i < evaluated.size(); ++i) {
-        int next = As<Number>(evaluated[i])->GetValue();
-        if (first <= next) {
-            return kFalse;
+    if (args[0].IsNil() || !Is<Cell>(args[0])) {
+        throw RuntimeError("\"list-ref\" 1st argument must be list");
+    }
+    int64_t idx = args[1].GetFixnum();
+    auto cell = As<Cell>(args[0]);
+    for (int64_t i = 0; i < idx; ++i) {
+        if (cell == nullptr) {
+            throw RuntimeError("\"list-tail\": index out of range");
         }
-        first = next;
+        if (!Is<Cell>(cell->GetSecond())) {
+            if (i + 1 == idx) {
+                return cell->GetSecond();
+            }
+            throw RuntimeError("\"list-tail\": index out of range");
+        }
+        cell = As<Cell>(cell->GetSecond());
     }
-    return kTrue;
+    return cell ? cell : nullptr;
+}
+
+Value IsEq::Apply(std::span<const Value> args) {
+    return Value::Boolean(args[0] == args[1]);
+}
+
+Value IsEqv::Apply(std::span<const Value> args) {
+    return Value::Boolean(AreEqv(args[0], args[1]));
 }
 
-std::shared_ptr<Object> GreaterOrEqual::operator()(std::shared_ptr<Object> args,
-                                                   std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.empty()) {
+Value IsEqual::Apply(std::span<const Value> args) {
+    return Value::Boolean(AreEqual(args[0], args[1]));
+}
+
+Value IsSymbol::Apply(std::span<const Value> args) {
+    if (Is<Symbol>(args[0])) {
         return kTrue;
     }
-    CheckAllNumbers(evaluated, ">=");
-    int first = As<Number>(evaluated[0])->GetValue();
-    for (size_t i = 1; i < evaluated.size(); ++i) {
-        int next = As<Number>(evaluated[i])->GetValue();
-        if (first < next) {
-            return kFalse;
-        }
-        first = next;
+    return kFalse;
+}
+
+Value IsString::Apply(std::span<const Value> args) {
+    return Value::Boolean(Is<String>(args[0]));
+}
+
+namespace {
+String* CheckString(const char* name, Value value) {
+    if (!Is<String>(value)) {
+        throw RuntimeError("\"" + std::string(name) + "\" arguments must be strings");
     }
-    return kTrue;
+    return As<String>(value);
 }
+}  // namespace
 
-std::shared_ptr<Object> Equal::operator()(std::shared_ptr<Object> args,
-                                          std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.empty()) {
-        return kTrue;
+Value StringLength::Apply(std::span<const Value> args) {
+    return Value::Fixnum(CheckString("string-length", args[0])->GetSize());
+}
+
+Value Substring::Apply(std::span<const Value> args) {
+    auto text = CheckString("substring", args[0])->GetView();
+    auto end = args.size() == 3 ? args[2] : Value::Fixnum(text.size());
+    if (!args[1].IsFixnum() || !end.IsFixnum()) {
+        throw RuntimeError("\"substring\" indices must be numbers");
     }
-    CheckAllNumbers(evaluated, "=");
-    int first = As<Number>(evaluated[0])->GetValue();
-    for (size_t i = 1; i < evaluated.size(); ++i) {
-        int next = As<Number>(evaluated[i])->GetValue();
-        if (first != next) {
-            return kFalse;
-        }
+    auto from = args[1].GetFixnum();
+    auto to = end.GetFixnum();
+    if (from < 0 || from > to || static_cast<uint64_t>(to) > text.size()) {
+        throw RuntimeError("\"substring\": index out of range");
     }
-    return kTrue;
+    return String::Create(text.substr(from, to - from));
 }
 
-std::shared_ptr<Object> IsNumber::operator()(std::shared_ptr<Object> args,
-                                             std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.size() != 1) {
-        throw RuntimeError("\"number?\" expects one argument");
+Value StringAppend::Apply(std::span<const Value> args) {
+    size_t size = 0;
+    for (auto arg : args) {
+        size += CheckString("string-append", arg)->GetSize();
     }
-    if (Is<Number>(Evaluate(flatten_args.front(), scope))) {
-        return kTrue;
+    // The result is allocated once, at its final size.
+    auto* result = String::Allocate(size);
+    auto out = result->GetChars().begin();
+    for (auto arg : args) {
+        out = std::ranges::copy(As<String>(arg)->GetView(), out).out;
     }
-    return kFalse;
+    return result;
 }
 
-std::shared_ptr<Object> Min::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    CheckNonEmpty(evaluated, "min");
-    CheckAllNumbers(evaluated, "min");
-    int result = As<Number>(evaluated[0])->GetValue();
-    for (auto arg : evaluated) {
-        result = std::min(result, As<Number>(arg)->GetValue());
+Value StringEqual::Apply(std::span<const Value> args) {
+    auto first = CheckString("string=?", args[0])->GetView();
+    bool equal = true;
+    // Every argument is checked, even past a mismatch.
+    for (auto arg : args.subspan(1)) {
+        if (CheckString("string=?", arg)->GetView() != first) {
+            equal = false;
+        }
     }
-    return std::make_shared<Number>(result);
+    return Value::Boolean(equal);
 }
 
-std::shared_ptr<Object> Max::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    CheckNonEmpty(evaluated, "max");
-    CheckAllNumbers(evaluated, "max");
-    int result = As<Number>(evaluated[0])->GetValue();
-    for (auto arg : evaluated) {
-        result = std::max(result, As<Number>(arg)->GetValue());
-    }
-    return std::make_shared<Number>(result);
+Value StringToSymbol::Apply(std::span<const Value> args) {
+    return Symbol::Intern(CheckString("string->symbol", args[0])->GetView());
 }
 
-std::shared_ptr<Object> Abs::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.size() != 1) {
-        throw RuntimeError("\"abs\" must have 1 argument");
+Value SymbolToString::Apply(std::span<const Value> args) {
+    if (!Is<Symbol>(args[0])) {
+        throw RuntimeError("\"symbol->string\" argument must be symbol");
     }
-    CheckAllNumbers(evaluated, "min");
-    return std::make_shared<Number>(abs(As<Number>(evaluated[0])->GetValue()));
+    return String::Create(As<Symbol>(args[0])->GetName());
 }
 
-std::shared_ptr<Object> IsPair::operator()(std::shared_ptr<Object> args,
-                                           std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.size() != 1) {
-        throw RuntimeError("\"pair?\" must have 1 argument");
-    }
-    if (evaluated[0] == nullptr || !Is<Cell>(evaluated[0])) {
-        return kFalse;
-    }
-    return kTrue;
+Value FormatNumber::Apply(std::span<const Value> args) {
+    return String::Create(NumberToString(args[0]));
 }
 
-std::shared_ptr<Object> IsNull::operator()(std::shared_ptr<Object> args,
-                                           std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.size() != 1) {
-        throw RuntimeError("\"null?\" must have 1 argument");
-    }
-    if (evaluated[0] == nullptr) {
+Value IsVector::Apply(std::span<const Value> args) {
+    if (Is<Vector>(args[0])) {
         return kTrue;
     }
     return kFalse;
 }
 
-std::shared_ptr<Object> IsList::operator()(std::shared_ptr<Object> args,
-                                           std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args, false), scope);
-    if (evaluated.size() != 1) {
-        throw RuntimeError("\"list?\" must have 1 argument");
+namespace {
+Vector* CheckVector(const char* name, Value value) {
+    if (!Is<Vector>(value)) {
+        throw RuntimeError("\"" + std::string(name) + "\" 1st argument must be vector");
     }
-    if (evaluated[0] != nullptr && !Is<Cell>(evaluated[0])) {
-        return kFalse;
+    return As<Vector>(value);
+}
+
+size_t CheckIndex(const char* name, Value index, size_t size) {
+    if (!index.IsFixnum()) {
+        throw RuntimeError("\"" + std::string(name) + "\" 2nd argument must be number");
     }
-    try {
-        CellToVector(evaluated[0], true);
-    } catch (...) {
-        return kFalse;
+    if (index.GetFixnum() < 0 || static_cast<uint64_t>(index.GetFixnum()) >= size) {
+        throw RuntimeError("\"" + std::string(name) + "\": index out of range");
     }
-
-    return kTrue;
+    return index.GetFixnum();
 }
+}  // namespace
 
-std::shared_ptr<Object> Cons::operator()(std::shared_ptr<Object> args,
-                                         std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args, false), scope);
-    if (evaluated.size() != 2) {
-        throw RuntimeError("\"cons\" must have 2 argument");
+Value MakeVector::Apply(std::span<const Value> args) {
+    if (!args[0].IsFixnum() || args[0].GetFixnum() < 0) {
+        throw RuntimeError("\"make-vector\" 1st argument must be non-negative number");
     }
+    return Vector::Create(args[0].GetFixnum(), args.size() == 2 ? args[1] : Value::Fixnum(0));
+}
 
-    return std::make_shared<Cell>(evaluated[0], evaluated[1]);
+Value VectorOf::Apply(std::span<const Value> args) {
+    return Vector::Create(args);
 }
 
-std::shared_ptr<Object> Car::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args, false), scope);
-    if (evaluated.size() != 1) {
-        throw RuntimeError("\"car\" must have 1 argument");
-    }
-    if (!Is<Cell>(evaluated[0])) {
-        throw RuntimeError("\"car\" argument must be pair-like structure");
-    }
-    if (evaluated[0] == nullptr) {
-        throw RuntimeError("\"cdr\" on nil");
+Value VectorLength::Apply(std::span<const Value> args) {
+    return Value::Fixnum(CheckVector("vector-length", args[0])->GetSize());
+}
+
+Value VectorRef::Apply(std::span<const Value> args) {
+    auto* vector = CheckVector("vector-ref", args[0]);
+    return vector->GetElements()[CheckIndex("vector-ref", args[1], vector->GetSize())];
+}
+
+Value VectorSet::Apply(std::span<const Value> args) {
+    auto* vector = CheckVector("vector-set!", args[0]);
+    vector->GetElements()[CheckIndex("vector-set!", args[1], vector->GetSize())] = args[2];
+    return nullptr;
+}
+
+Value VectorFill::Apply(std::span<const Value> args) {
+    std::ranges::fill(CheckVector("vector-fill!", args[0])->GetElements(), args[1]);
+    return nullptr;
+}
+
+Value VectorToList::Apply(std::span<const Value> args) {
+    auto elements = CheckVector("vector->list", args[0])->GetElements();
+    Value result = nullptr;
+    for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+        result = Make<Cell>(*it, result);
     }
-    auto head = As<Cell>(evaluated[0])->GetFirst();
-    return head;
+    return result;
 }
 
-std::shared_ptr<Object> Cdr::operator()(std::shared_ptr<Object> args,
-                                        std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args, false), scope);
-    if (evaluated.size() != 1) {
-        throw RuntimeError("\"cdr\" must have 1 argument");
+Value ListToVector::Apply(std::span<const Value> args) {
+    std::vector<Value> elements;
+    Value rest = args[0];
+    for (; Is<Cell>(rest); rest = As<Cell>(rest)->GetSecond()) {
+        elements.push_back(As<Cell>(rest)->GetFirst());
     }
-    if (!Is<Cell>(evaluated[0])) {
-        throw RuntimeError("\"cdr\" argument must be pair-like structure");
+    if (!rest.IsNil()) {
+        throw RuntimeError("\"list->vector\" argument must be list");
     }
-    if (evaluated[0] == nullptr) {
-        throw RuntimeError("\"cdr\" on nil");
-    }
-    auto tail = As<Cell>(evaluated[0])->GetSecond();
-    return tail;
+    return Vector::Create(elements);
 }
 
-std::shared_ptr<Object> SetCar::operator()(std::shared_ptr<Object> args,
-                                           std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.size() != 2) {
-        throw RuntimeError("\"set-car!\" must have 2 arguments");
-    }
-    if (!Is<Symbol>(flatten_args[0])) {
-        throw RuntimeError("\"set-car!\" 1st argument must be symbol");
+namespace {
+bool Unbox(Value value, int64_t* element) {
+    return ToInt64(value, element);
+}
+
+bool Unbox(Value value, double* element) {
+    if (!IsNumeric(value)) {
+        return false;
     }
-    auto evaluated = Evaluate(flatten_args[1], scope);
-    auto val = scope->Get(As<Symbol>(flatten_args[0])->GetName());
-    if (!Is<Cell>(val)) {
-        throw RuntimeError("\"set-car!\" argument is not list");
+    *element = ToDouble(value);
+    return true;
+}
+
+Value Box(int64_t element) {
+    return MakeInteger(element);
+}
+
+Value Box(double element) {
+    return MakeFlonum(element);
+}
+
+template <class T>
+T UnboxElement(const char* name, Value value) {
+    T element;
+    if (!Unbox(value, &element)) {
+        throw RuntimeError("\"" + std::string(name) + "\" elements must be " +
+                           (std::is_same_v<T, int64_t> ? "64-bit integers" : "numbers"));
     }
-    if (val == nullptr) {
-        throw RuntimeError("\"set-car!\" argument can't be nil");
+    return element;
+}
+
+template <class V>
+V* CheckNumericVector(const char* name, Value value) {
+    if (!Is<V>(value)) {
+        throw RuntimeError("\"" + std::string(name) + "\" arguments must be numeric vectors");
     }
-    scope->Set(As<Symbol>(flatten_args[0])->GetName(),
-               std::make_shared<Cell>(evaluated, As<Cell>(val)->GetSecond()));
-    return nullptr;
+    return As<V>(value);
 }
 
-std::shared_ptr<Object> SetCdr::operator()(std::shared_ptr<Object> args,
-                                           std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.size() != 2) {
-        throw RuntimeError("\"set-cdr!\" must have 2 arguments");
+template <class V>
+V* MakeNumericVectorOf(std::span<const Value> elements, const char* name) {
+    auto* vector = V::Create(elements.size());
+    for (size_t i = 0; i < elements.size(); ++i) {
+        vector->GetElements()[i] = UnboxElement<typename V::Element>(name, elements[i]);
     }
-    if (!Is<Symbol>(flatten_args[0])) {
-        throw RuntimeError("\"set-cdr!\" 1st argument must be symbol");
+    return vector;
+}
+}  // namespace
+
+template <class V>
+Value IsNumericVector<V>::Apply(std::span<const Value> args) {
+    if (Is<V>(args[0])) {
+        return kTrue;
     }
-    auto evaluated = Evaluate(flatten_args[1], scope);
-    auto val = scope->Get(As<Symbol>(flatten_args[0])->GetName());
-    if (!Is<Cell>(val)) {
-        throw RuntimeError("\"set-cdr!\" argument is not list");
+    return kFalse;
+}
+
+template <class V>
+Value MakeNumericVector<V>::Apply(std::span<const Value> args) {
+    if (!args[0].IsFixnum() || args[0].GetFixnum() < 0) {
+        throw RuntimeError("\"" + std::string(GetName()) +
+                           "\" 1st argument must be non-negative number");
     }
-    if (val == nullptr) {
-        throw RuntimeError("\"set-cdr!\" argument can't be nil");
+    auto* vector = V::Create(args[0].GetFixnum());
+    if (args.size() == 2) {
+        std::ranges::fill(vector->GetElements(),
+                          UnboxElement<typename V::Element>(GetName(), args[1]));
     }
-    scope->Set(As<Symbol>(flatten_args[0])->GetName(),
-               std::make_shared<Cell>(As<Cell>(val)->GetFirst(), evaluated));
+    return vector;
+}
+
+template <class V>
+Value NumericVectorOf<V>::Apply(std::span<const Value> args) {
+    return MakeNumericVectorOf<V>(args, GetName());
+}
+
+template <class V>
+Value NumericVectorLength<V>::Apply(std::span<const Value> args) {
+    return Value::Fixnum(CheckNumericVector<V>(GetName(), args[0])->GetSize());
+}
+
+template <class V>
+Value NumericVectorRef<V>::Apply(std::span<const Value> args) {
+    auto* vector = CheckNumericVector<V>(GetName(), args[0]);
+    return Box(vector->GetElements()[CheckIndex(GetName(), args[1], vector->GetSize())]);
+}
+
+template <class V>
+Value NumericVectorSet<V>::Apply(std::span<const Value> args) {
+    auto* vector = CheckNumericVector<V>(GetName(), args[0]);
+    auto index = CheckIndex(GetName(), args[1], vector->GetSize());
+    vector->GetElements()[index] = UnboxElement<typename V::Element>(GetName(), args[2]);
     return nullptr;
 }
 
-std::shared_ptr<Object> List::operator()(std::shared_ptr<Object> args,
-                                         std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    std::shared_ptr<Cell> result = nullptr;
-    size_t last_idx = evaluated.size();
-    while (last_idx) {
-        --last_idx;
-        result = std::make_shared<Cell>(evaluated[last_idx], result);
+template <class V>
+Value NumericVectorToList<V>::Apply(std::span<const Value> args) {
+    auto elements = CheckNumericVector<V>(GetName(), args[0])->GetElements();
+    Value result = nullptr;
+    for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+        result = Make<Cell>(Box(*it), result);
     }
     return result;
 }
 
-std::shared_ptr<Object> ListRef::operator()(std::shared_ptr<Object> args,
-                                            std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.size() != 2) {
-        throw RuntimeError("\"list-ref\" must have 2 args");
+template <class V>
+Value ListToNumericVector<V>::Apply(std::span<const Value> args) {
+    std::vector<Value> elements;
+    Value rest = args[0];
+    for (; Is<Cell>(rest); rest = As<Cell>(rest)->GetSecond()) {
+        elements.push_back(As<Cell>(rest)->GetFirst());
     }
-    if (!Is<Number>(evaluated[1])) {
-        throw RuntimeError("\"list-ref\" 2nd argument must be number");
+    if (!rest.IsNil()) {
+        throw RuntimeError("\"" + std::string(GetName()) + "\" argument must be list");
     }
-    if (evaluated[0] == nullptr || !Is<Cell>(evaluated[0])) {
-        throw RuntimeError("\"list-ref\" 1st argument must be list");
+    return MakeNumericVectorOf<V>(elements, GetName());
+}
+
+template <class V>
+Value NumericVectorElementwise<V>::Apply(std::span<const Value> args) {
+    auto a = CheckNumericVector<V>(GetName(), args[0])->GetElements();
+    auto b = CheckNumericVector<V>(GetName(), args[1])->GetElements();
+    if (a.size() != b.size()) {
+        throw RuntimeError("\"" + std::string(GetName()) + "\": vectors differ in length");
     }
-    int idx = As<Number>(evaluated[1])->GetValue();
-    auto elements = CellToVector(evaluated[0]);
-    if (elements.size() <= idx) {
-        throw RuntimeError("\"list-ref\": index out of range");
+    auto* result = V::Create(a.size());
+    bool fits = false;
+    switch (operation_) {
+        case ElementwiseOperation::kAdd:
+            fits = VectorAdd(a, b, result->GetElements());
+            break;
+        case ElementwiseOperation::kSubtract:
+            fits = VectorSubtract(a, b, result->GetElements());
+            break;
+        case ElementwiseOperation::kMultiply:
+            fits = VectorMultiply(a, b, result->GetElements());
+            break;
     }
-    return elements[idx];
+    if (!fits) {
+        throw RuntimeError("\"" + std::string(GetName()) + "\": result out of 64 bits");
+    }
+    return result;
 }
 
-std::shared_ptr<Object> ListTail::operator()(std::shared_ptr<Object> args,
-                                             std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.size() != 2) {
-        throw RuntimeError("\"list-ref\" must have 2 args");
+template <class V>
+Value NumericVectorScale<V>::Apply(std::span<const Value> args) {
+    auto elements = CheckNumericVector<V>(GetName(), args[0])->GetElements();
+    auto factor = UnboxElement<typename V::Element>(GetName(), args[1]);
+    auto* result = V::Create(elements.size());
+    if (!VectorScale(elements, factor, result->GetElements())) {
+        throw RuntimeError("\"" + std::string(GetName()) + "\": result out of 64 bits");
     }
-    if (!Is<Number>(evaluated[1])) {
-        throw RuntimeError("\"list-ref\" 2nd argument must be number");
+    return result;
+}
+
+template <class V>
+Value NumericVectorDot<V>::Apply(std::span<const Value> args) {
+    auto a = CheckNumericVector<V>(GetName(), args[0])->GetElements();
+    auto b = CheckNumericVector<V>(GetName(), args[1])->GetElements();
+    if (a.size() != b.size()) {
+        throw RuntimeError("\"" + std::string(GetName()) + "\": vectors differ in length");
     }
-    if (evaluated[0] == nullptr || !Is<Cell>(evaluated[0])) {
-        throw RuntimeError("\"list-ref\" 1st argument must be list");
+    if constexpr (std::is_same_v<typename V::Element, double>) {
+        return MakeFlonum(VectorDot(a, b));
+    } else {
+        int64_t dot;
+        if (VectorDot(a, b, &dot)) {
+            return MakeInteger(dot);
+        }
+        Value result = Value::Fixnum(0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            result = AddNumbers(result, MultiplyNumbers(Box(a[i]), Box(b[i])));
+        }
+        return result;
     }
-    int idx = As<Number>(evaluated[1])->GetValue();
-    auto cell = As<Cell>(evaluated[0]);
-    for (int i = 0; i < idx; ++i) {
-        if (cell == nullptr) {
-            throw RuntimeError("\"list-tail\": index out of range");
+}
+
+template <class V>
+Value NumericVectorSum<V>::Apply(std::span<const Value> args) {
+    auto elements = CheckNumericVector<V>(GetName(), args[0])->GetElements();
+    if constexpr (std::is_same_v<typename V::Element, double>) {
+        // The lanes start from -0.0, which an empty vector shouldn't sum to.
+        return MakeFlonum(elements.empty() ? 0.0 : VectorSum(elements));
+    } else {
+        int64_t sum;
+        if (VectorSum(elements, &sum)) {
+            return MakeInteger(sum);
         }
-        if (!Is<Cell>(cell->GetSecond())) {
-            if (i + 1 == idx) {
-                return cell->GetSecond();
-            }
-            throw RuntimeError("\"list-tail\": index out of range");
+        Value result = Value::Fixnum(0);
+        for (auto element : elements) {
+            result = AddNumbers(result, Box(element));
         }
-        cell = As<Cell>(cell->GetSecond());
+        return result;
     }
-    return cell ? cell : nullptr;
 }
 
-std::shared_ptr<Object> If::operator()(std::shared_ptr<Object> args, std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.empty() || flatten_args.size() > 3) {
-        throw SyntaxError("\"if\" must have at least 1 argument and at most 3 arguments");
+template <class V>
+Value NumericVectorMin<V>::Apply(std::span<const Value> args) {
+    auto elements = CheckNumericVector<V>(GetName(), args[0])->GetElements();
+    if (elements.empty()) {
+        throw RuntimeError("\"" + std::string(GetName()) + "\": empty vector");
     }
-    auto predicate = Evaluate(flatten_args[0], scope);
-    if (Is<Boolean>(predicate) && As<Boolean>(predicate)->GetValue() == false) {
-        return flatten_args.size() < 3 ? nullptr : Evaluate(flatten_args[2], scope);
-    } else {
-        return flatten_args.size() < 2 ? nullptr : Evaluate(flatten_args[1], scope);
+    return Box(VectorMin(elements));
+}
+
+template <class V>
+Value NumericVectorMax<V>::Apply(std::span<const Value> args) {
+    auto elements = CheckNumericVector<V>(GetName(), args[0])->GetElements();
+    if (elements.empty()) {
+        throw RuntimeError("\"" + std::string(GetName()) + "\": empty vector");
     }
+    return Box(VectorMax(elements));
 }
 
-class LambdaHelper : public Function {
-    std::vector<std::string> arg_names_;
-    std::vector<std::shared_ptr<Object>> evaluation_;
-    std::shared_ptr<Scope> scope_;
+#define INSTANTIATE_NUMERIC_VECTOR_BUILTIN(name) \
+    template class name<S64Vector>;              \
+    template class name<F64Vector>;
+
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(IsNumericVector)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(MakeNumericVector)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorOf)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorLength)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorRef)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorSet)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorToList)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(ListToNumericVector)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorElementwise)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorScale)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorDot)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorSum)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorMin)
+INSTANTIATE_NUMERIC_VECTOR_BUILTIN(NumericVectorMax)
+
+#undef INSTANTIATE_NUMERIC_VECTOR_BUILTIN
 
-public:
-    LambdaHelper(std::vector<std::string> arg_names, std::vector<std::shared_ptr<Object>> eval,
-                 std::shared_ptr<Scope> lambda_scope)
-        : arg_names_(arg_names), evaluation_(eval), scope_(lambda_scope) {
+Value IsHashTable::Apply(std::span<const Value> args) {
+    return Value::Boolean(Is<HashTable>(args[0]));
+}
+
+namespace {
+HashTable* CheckHashTable(const char* name, Value value) {
+    if (!Is<HashTable>(value)) {
+        throw RuntimeError("\"" + std::string(name) + "\" 1st argument must be hash table");
     }
+    return As<HashTable>(value);
+}
+}  // namespace
 
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override {
-        auto evaluated = Evaluate(CellToVector(args), scope);
-        if (evaluated.size() != arg_names_.size()) {
-            throw RuntimeError("\"lambda\": not equal amount of arguments");
-        }
-        for (size_t i = 0; i < arg_names_.size(); ++i) {
-            scope_->Set(arg_names_[i], evaluated[i]);
-        }
-        std::shared_ptr<Object> last_eval;
-        for (auto e : evaluation_) {
-            last_eval = Evaluate(e, scope_);
+void MakeHashTable::Trace(Heap& heap) const {
+    heap.Mark(is_eq_);
+    heap.Mark(is_eqv_);
+    heap.Mark(is_equal_);
+}
+
+Value MakeHashTable::Apply(std::span<const Value> args) {
+    auto equivalence = HashTable::Equivalence::kEqual;
+    if (!args.empty()) {
+        if (args[0] == is_eq_) {
+            equivalence = HashTable::Equivalence::kEq;
+        } else if (args[0] == is_eqv_) {
+            equivalence = HashTable::Equivalence::kEqv;
+        } else if (args[0] != is_equal_) {
+            throw RuntimeError("\"make-hash-table\" argument must be eq?, eqv? or equal?");
         }
-        return last_eval;
     }
-};
+    return Make<HashTable>(equivalence);
+}
 
-std::shared_ptr<Object> Lambda::operator()(std::shared_ptr<Object> args,
-                                           std::shared_ptr<Scope> scope) {
-    auto flatten_args = CellToVector(args);
-    if (flatten_args.size() < 2) {
-        throw SyntaxError("\"lambda\" must have at least 2 arguments");
+Value HashTableRef::Apply(std::span<const Value> args) {
+    auto value = CheckHashTable("hash-table-ref", args[0])->Find(args[1]);
+    if (value.IsUnbound()) {
+        throw RuntimeError("\"hash-table-ref\": no such key");
     }
+    return value;
+}
 
-    std::vector<std::string> names;
+Value HashTableRefDefault::Apply(std::span<const Value> args) {
+    auto value = CheckHashTable("hash-table-ref/default", args[0])->Find(args[1]);
+    return value.IsUnbound() ? args[2] : value;
+}
 
-    for (auto name : CellToVector(flatten_args[0])) {
-        if (!Is<Symbol>(name)) {
-            throw SyntaxError("lambda args names must be symbols");
-        }
-        names.push_back(As<Symbol>(name)->GetName());
-    }
+Value HashTableSet::Apply(std::span<const Value> args) {
+    CheckHashTable("hash-table-set!", args[0])->Set(args[1], args[2]);
+    return nullptr;
+}
 
-    flatten_args.erase(flatten_args.begin());
+Value HashTableDelete::Apply(std::span<const Value> args) {
+    CheckHashTable("hash-table-delete!", args[0])->Remove(args[1]);
+    return nullptr;
+}
+
+Value HashTableContains::Apply(std::span<const Value> args) {
+    auto* table = CheckHashTable("hash-table-contains?", args[0]);
+    return Value::Boolean(!table->Find(args[1]).IsUnbound());
+}
 
-    return std::make_shared<LambdaHelper>(names, flatten_args, std::make_shared<Scope>(scope));
+Value HashTableCount::Apply(std::span<const Value> args) {
+    return Value::Fixnum(CheckHashTable("hash-table-count", args[0])->GetCount());
 }
 
-std::shared_ptr<Object> IsSymbol::operator()(std::shared_ptr<Object> args,
-                                             std::shared_ptr<Scope> scope) {
-    auto evaluated = Evaluate(CellToVector(args), scope);
-    if (evaluated.size() != 1) {
-        throw RuntimeError("\"symbol?\" mush have 1 argument");
+Value HashTableKeys::Apply(std::span<const Value> args) {
+    Value result = nullptr;
+    CheckHashTable("hash-table-keys", args[0])->ForEach([&result](Value key, Value) {
+        result = Make<Cell>(key, result);
+    });
+    return result;
+}
+
+Value HashTableValues::Apply(std::span<const Value> args) {
+    Value result = nullptr;
+    CheckHashTable("hash-table-values", args[0])->ForEach([&result](Value, Value value) {
+        result = Make<Cell>(value, result);
+    });
+    return result;
+}
+
+Value HashTableToAlist::Apply(std::span<const Value> args) {
+    Value result = nullptr;
+    CheckHashTable("hash-table->alist", args[0])->ForEach([&result](Value key, Value value) {
+        result = Make<Cell>(Make<Cell>(key, value), result);
+    });
+    return result;
+}
+
+Value WriteFasl::Apply(std::span<const Value> args) {
+    std::string path{CheckString("write-fasl", args[0])->GetView()};
+    FaslWriter writer;
+    writer.Add(args[1]);
+    auto fasl = writer.Finish();
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(fasl.data(), fasl.size())) {
+        throw RuntimeError("\"write-fasl\": cannot write " + path);
     }
-    if (Is<Symbol>(evaluated[0])) {
-        return kTrue;
+    return nullptr;
+}
+
+Value ReadFasl::Apply(std::span<const Value> args) {
+    FileContents contents{std::string{CheckString("read-fasl", args[0])->GetView()}};
+    FaslReader reader(contents.GetView());
+    if (reader.IsEnd()) {
+        throw RuntimeError("\"read-fasl\": the fasl holds no datum");
     }
-    return kFalse;
+    return reader.Next();
+}
+
+Value GarbageCollect::Apply(std::span<const Value>) {
+    Heap::Instance().RequestCollection();
+    return nullptr;
+}
+
+Value CallWithCurrentContinuation::Apply(std::span<const Value> args) {
+    return CallWithEscape(args[0]);
+}
+
+Value CallWithEscapeContinuation::Apply(std::span<const Value> args) {
+    return CallWithEscape(args[0]);
 }
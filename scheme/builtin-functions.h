@@ -1,211 +1,798 @@
 #pragma once
 
-#include <memory>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include "number.h"
 #include "object.h"
-#include "scope.h"
 
-std::shared_ptr<Object> Evaluate(std::shared_ptr<Object> obj, std::shared_ptr<Scope> scope);
+// A builtin procedure declares its name, arity and the type of its arguments once. They are
+// checked before Apply is called with the arguments, which stay where the caller put them.
+class Builtin : public Function {
+public:
+    Value operator()(std::span<const Value> args) final {
+        CheckArguments(args);
+        return Apply(args);
+    }
+
+    const char* GetName() const {
+        return name_;
+    }
+
+protected:
+    enum class Arguments {
+        kAny,
+        kNumbers
+    };
+
+    static constexpr uint32_t kVariadic = std::numeric_limits<uint32_t>::max();
+
+    Builtin(const char* name, uint32_t min_args, uint32_t max_args, Arguments arguments)
+        : name_(name), min_args_(min_args), max_args_(max_args), arguments_(arguments) {
+    }
+
+    virtual Value Apply(std::span<const Value> args) = 0;
+
+private:
+    void CheckArguments(std::span<const Value> args) const {
+        if (args.size() < min_args_ || args.size() > max_args_) {
+            ThrowArityError();
+        }
+        if (arguments_ == Arguments::kNumbers) {
+            for (auto arg : args) {
+                if (!IsNumeric(arg)) {
+                    ThrowTypeError();
+                }
+            }
+        }
+    }
+
+    [[noreturn]] void ThrowArityError() const;
+    [[noreturn]] void ThrowTypeError() const;
+
+    const char* name_;
+    uint32_t min_args_;
+    uint32_t max_args_;
+    Arguments arguments_;
+};
+
+class Equal : public Builtin {
+public:
+    Equal() : Builtin("=", 0, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
 
-class Define : public Function {
+class IsBoolean : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsBoolean() : Builtin("boolean?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class Not : public Builtin {
+public:
+    Not() : Builtin("not", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class IsEq : public Builtin {
+public:
+    IsEq() : Builtin("eq?", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Quote : public Function {
+class IsEqv : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsEqv() : Builtin("eqv?", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Set : public Function {
+class IsEqual : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsEqual() : Builtin("equal?", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Equal : public Function {
+class IsNumber : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsNumber() : Builtin("number?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class IsBoolean : public Function {
+class Less : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Less() : Builtin("<", 0, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Not : public Function {
+class LessOrEqual : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    LessOrEqual() : Builtin("<=", 0, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class And : public Function {
+class Greater : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Greater() : Builtin(">", 0, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Or : public Function {
+class GreaterOrEqual : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    GreaterOrEqual() : Builtin(">=", 0, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class IsNumber : public Function {
+class Add : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Add() : Builtin("+", 0, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Less : public Function {
+class Sub : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Sub() : Builtin("-", 1, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class LessOrEqual : public Function {
+class Mul : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Mul() : Builtin("*", 0, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Greater : public Function {
+class Div : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Div() : Builtin("/", 1, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class GreaterOrEqual : public Function {
+class Min : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Min() : Builtin("min", 1, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Add : public Function {
+class Max : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Max() : Builtin("max", 1, kVariadic, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Sub : public Function {
+class Abs : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Abs() : Builtin("abs", 1, 1, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Mul : public Function {
+class IsPair : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsPair() : Builtin("pair?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Div : public Function {
+class IsNull : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsNull() : Builtin("null?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Min : public Function {
+class IsList : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsList() : Builtin("list?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Max : public Function {
+class Cons : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Cons() : Builtin("cons", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Abs : public Function {
+class Car : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Car() : Builtin("car", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class IsPair : public Function {
+class Cdr : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Cdr() : Builtin("cdr", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class IsNull : public Function {
+class SetCar : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    SetCar() : Builtin("set-car!", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class IsList : public Function {
+class SetCdr : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    SetCdr() : Builtin("set-cdr!", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Cons : public Function {
+class List : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    List() : Builtin("list", 0, kVariadic, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Car : public Function {
+class ListRef : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    ListRef() : Builtin("list-ref", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Cdr : public Function {
+class ListTail : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    ListTail() : Builtin("list-tail", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class SetCar : public Function {
+class IsSymbol : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsSymbol() : Builtin("symbol?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class SetCdr : public Function {
+class IsString : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    IsString() : Builtin("string?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class List : public Function {
+class StringLength : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    StringLength() : Builtin("string-length", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class ListRef : public Function {
+class Substring : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    Substring() : Builtin("substring", 2, 3, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class ListTail : public Function {
+class StringAppend : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    StringAppend() : Builtin("string-append", 0, kVariadic, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class If : public Function {
+class StringEqual : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    StringEqual() : Builtin("string=?", 1, kVariadic, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class Lambda : public Function {
+class StringToSymbol : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    StringToSymbol() : Builtin("string->symbol", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class SymbolToString : public Builtin {
+public:
+    SymbolToString() : Builtin("symbol->string", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+// number->string, named apart from the function it calls.
+class FormatNumber : public Builtin {
+public:
+    FormatNumber() : Builtin("number->string", 1, 1, Arguments::kNumbers) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class IsVector : public Builtin {
+public:
+    IsVector() : Builtin("vector?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class MakeVector : public Builtin {
+public:
+    MakeVector() : Builtin("make-vector", 1, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class VectorOf : public Builtin {
+public:
+    VectorOf() : Builtin("vector", 0, kVariadic, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class VectorLength : public Builtin {
+public:
+    VectorLength() : Builtin("vector-length", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class VectorRef : public Builtin {
+public:
+    VectorRef() : Builtin("vector-ref", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class VectorSet : public Builtin {
+public:
+    VectorSet() : Builtin("vector-set!", 3, 3, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class VectorFill : public Builtin {
+public:
+    VectorFill() : Builtin("vector-fill!", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class VectorToList : public Builtin {
+public:
+    VectorToList() : Builtin("vector->list", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class ListToVector : public Builtin {
+public:
+    ListToVector() : Builtin("list->vector", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+// Builtins on unboxed numeric vectors, instantiated for S64Vector and F64Vector under the
+// names of SRFI 4 (s64vector-ref, make-f64vector, ...), which are given to the constructor.
+template <class V>
+class IsNumericVector : public Builtin {
+public:
+    explicit IsNumericVector(const char* name) : Builtin(name, 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class MakeNumericVector : public Builtin {
+public:
+    explicit MakeNumericVector(const char* name) : Builtin(name, 1, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class NumericVectorOf : public Builtin {
+public:
+    explicit NumericVectorOf(const char* name) : Builtin(name, 0, kVariadic, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
 
-class IsSymbol : public Function {
+template <class V>
+class NumericVectorLength : public Builtin {
 public:
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                       std::shared_ptr<Scope> scope) override;
+    explicit NumericVectorLength(const char* name) : Builtin(name, 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class NumericVectorRef : public Builtin {
+public:
+    explicit NumericVectorRef(const char* name) : Builtin(name, 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class NumericVectorSet : public Builtin {
+public:
+    explicit NumericVectorSet(const char* name) : Builtin(name, 3, 3, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class NumericVectorToList : public Builtin {
+public:
+    explicit NumericVectorToList(const char* name) : Builtin(name, 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class ListToNumericVector : public Builtin {
+public:
+    explicit ListToNumericVector(const char* name) : Builtin(name, 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+// The bulk operations run native kernels over the unboxed elements. Element-wise ones make a
+// new vector; on s64vectors, a result out of 64 bits is an error.
+enum class ElementwiseOperation {
+    kAdd,
+    kSubtract,
+    kMultiply
+};
+
+template <class V>
+class NumericVectorElementwise : public Builtin {
+public:
+    NumericVectorElementwise(const char* name, ElementwiseOperation operation)
+        : Builtin(name, 2, 2, Arguments::kAny), operation_(operation) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+
+private:
+    ElementwiseOperation operation_;
+};
+
+template <class V>
+class NumericVectorScale : public Builtin {
+public:
+    explicit NumericVectorScale(const char* name) : Builtin(name, 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+// Sums and dot products of s64vectors are exact: past 64 bits they are recomputed as bignums.
+template <class V>
+class NumericVectorDot : public Builtin {
+public:
+    explicit NumericVectorDot(const char* name) : Builtin(name, 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class NumericVectorSum : public Builtin {
+public:
+    explicit NumericVectorSum(const char* name) : Builtin(name, 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class NumericVectorMin : public Builtin {
+public:
+    explicit NumericVectorMin(const char* name) : Builtin(name, 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+template <class V>
+class NumericVectorMax : public Builtin {
+public:
+    explicit NumericVectorMax(const char* name) : Builtin(name, 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+// A table compares keys with the equivalence predicate given to make-hash-table, equal? by
+// default.
+class IsHashTable : public Builtin {
+public:
+    IsHashTable() : Builtin("hash-table?", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+// Takes the builtin eq?, eqv? and equal?, which pick the equivalence of a table under whatever
+// name they are passed.
+class MakeHashTable : public Builtin {
+public:
+    MakeHashTable(Value is_eq, Value is_eqv, Value is_equal)
+        : Builtin("make-hash-table", 0, 1, Arguments::kAny),
+          is_eq_(is_eq),
+          is_eqv_(is_eqv),
+          is_equal_(is_equal) {
+    }
+
+    void Trace(Heap& heap) const override;
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+
+private:
+    Value is_eq_;
+    Value is_eqv_;
+    Value is_equal_;
+};
+
+class HashTableRef : public Builtin {
+public:
+    HashTableRef() : Builtin("hash-table-ref", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class HashTableRefDefault : public Builtin {
+public:
+    HashTableRefDefault() : Builtin("hash-table-ref/default", 3, 3, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class HashTableSet : public Builtin {
+public:
+    HashTableSet() : Builtin("hash-table-set!", 3, 3, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class HashTableDelete : public Builtin {
+public:
+    HashTableDelete() : Builtin("hash-table-delete!", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class HashTableContains : public Builtin {
+public:
+    HashTableContains() : Builtin("hash-table-contains?", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class HashTableCount : public Builtin {
+public:
+    HashTableCount() : Builtin("hash-table-count", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class HashTableKeys : public Builtin {
+public:
+    HashTableKeys() : Builtin("hash-table-keys", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class HashTableValues : public Builtin {
+public:
+    HashTableValues() : Builtin("hash-table-values", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class HashTableToAlist : public Builtin {
+public:
+    HashTableToAlist() : Builtin("hash-table->alist", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+// A file holding the fasl of one datum. read-fasl gives the first datum of any fasl.
+class WriteFasl : public Builtin {
+public:
+    WriteFasl() : Builtin("write-fasl", 2, 2, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class ReadFasl : public Builtin {
+public:
+    ReadFasl() : Builtin("read-fasl", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class GarbageCollect : public Builtin {
+public:
+    GarbageCollect() : Builtin("gc", 0, 0, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+// Both capture escape-only continuations when called by the tree walker. The virtual machine
+// runs them itself.
+class CallWithCurrentContinuation : public Builtin {
+public:
+    CallWithCurrentContinuation() : Builtin("call/cc", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
+};
+
+class CallWithEscapeContinuation : public Builtin {
+public:
+    CallWithEscapeContinuation() : Builtin("call/ec", 1, 1, Arguments::kAny) {
+    }
+
+protected:
+    Value Apply(std::span<const Value> args) override;
 };
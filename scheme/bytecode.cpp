@@ -0,0 +1,13 @@
+#include "bytecode.h"
+#include "heap.h"
+
+void Code::Trace(Heap& heap) const {
+    for (auto constant : constants) {
+        heap.Mark(constant);
+    }
+}
+
+void CompiledClosure::Trace(Heap& heap) const {
+    heap.Mark(code_);
+    heap.Mark(env_);
+}
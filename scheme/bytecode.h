@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <vector>
+#include "object.h"
+#include "scope.h"
+
+// Instruction set of the virtual machine. An instruction is an opcode byte followed by its
+// operands, u8/u16/u32 in native byte order:
+//   Constant k          push constants[k]
+//   Nil                 push ()
+//   Pop                 drop the top of the stack
+//   LoadLocal d s       push slot s of the frame d levels up
+//   LoadLocalChecked d s k
+//                       same, raising NameError for constants[k] if the slot is unbound
+//   StoreLocal d s      pop into slot s of the frame d levels up
+//   LoadGlobal id       push the global bound to the symbol with the given id
+//   StoreGlobal id      pop into that global
+//   Jump to             continue at offset to
+//   JumpIfFalse to      pop, jump if it was #f
+//   JumpIfFalseKeep to  jump if the top is #f, pop it otherwise
+//   JumpIfTrueKeep to   jump unless the top is #f, pop it otherwise
+//   MakeClosure k       push a closure of the code constants[k] over the current frame
+//   Call n              call the procedure below n arguments, replacing them with the result
+//   TailCall n          same, reusing the caller's activation
+//   Return              return the top of the stack to the caller
+//   Raise k             rethrow the analysis error errors[k]
+//   Add p .. NumEqual p  binary primitive p applied to the two topmost values
+#define SCHEME_OPCODES(X) \
+    X(Constant)           \
+    X(Nil)                \
+    X(Pop)                \
+    X(LoadLocal)          \
+    X(LoadLocalChecked)   \
+    X(StoreLocal)         \
+    X(LoadGlobal)         \
+    X(StoreGlobal)        \
+    X(Jump)               \
+    X(JumpIfFalse)        \
+    X(JumpIfFalseKeep)    \
+    X(JumpIfTrueKeep)     \
+    X(MakeClosure)        \
+    X(Call)               \
+    X(TailCall)           \
+    X(Return)             \
+    X(Raise)              \
+    X(Add)                \
+    X(Sub)                \
+    X(Mul)                \
+    X(Less)               \
+    X(LessOrEqual)        \
+    X(Greater)            \
+    X(GreaterOrEqual)     \
+    X(NumEqual)
+
+enum class Opcode : uint8_t {
+#define SCHEME_OPCODE_ENUM(name) k##name,
+    SCHEME_OPCODES(SCHEME_OPCODE_ENUM)
+#undef SCHEME_OPCODE_ENUM
+};
+
+// The binary primitives, which have an opcode each from Add to NumEqual.
+inline constexpr size_t kPrimitiveCount =
+    static_cast<size_t>(Opcode::kNumEqual) - static_cast<size_t>(Opcode::kAdd) + 1;
+
+// Bytes of operands that follow the opcode.
+constexpr size_t GetOperandSize(Opcode opcode) {
+    switch (opcode) {
+        case Opcode::kNil:
+        case Opcode::kPop:
+        case Opcode::kReturn:
+            return 0;
+        case Opcode::kConstant:
+        case Opcode::kMakeClosure:
+        case Opcode::kCall:
+        case Opcode::kTailCall:
+        case Opcode::kRaise:
+            return 2;
+        case Opcode::kLoadLocal:
+        case Opcode::kStoreLocal:
+        case Opcode::kLoadGlobal:
+        case Opcode::kStoreGlobal:
+        case Opcode::kJump:
+        case Opcode::kJumpIfFalse:
+        case Opcode::kJumpIfFalseKeep:
+        case Opcode::kJumpIfTrueKeep:
+            return 4;
+        case Opcode::kLoadLocalChecked:
+            return 6;
+        default:
+            // The binary primitives, Add to NumEqual.
+            return 1;
+    }
+}
+
+template <class T>
+T ReadOperand(const uint8_t* ip) {
+    T value;
+    std::memcpy(&value, ip, sizeof(T));
+    return value;
+}
+
+// Compiled body of a lambda expression or a top-level form.
+class Code : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kCode;
+
+    Code() : Object(kType) {
+    }
+
+    void Trace(Heap& heap) const override;
+
+    std::vector<uint8_t> bytecode;
+    // Quoted data, names for error messages and the code of nested lambdas.
+    std::vector<Value> constants;
+    std::vector<std::exception_ptr> errors;
+    uint32_t param_count = 0;
+    // Parameters and internal definitions; no frame is created when it is zero.
+    uint32_t frame_size = 0;
+    // The frame may be captured by a closure, so it is allocated on the heap rather than taken
+    // from the FramePool.
+    bool frame_captured = false;
+    // Number of stack slots the code needs at most.
+    uint32_t max_stack = 0;
+};
+
+class CompiledClosure : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kCompiledClosure;
+
+    CompiledClosure(Code* code, Frame* env) : Object(kType), code_(code), env_(env) {
+    }
+
+    Code* GetCode() const {
+        return code_;
+    }
+
+    Frame* GetEnv() const {
+        return env_;
+    }
+
+    void Trace(Heap& heap) const override;
+
+private:
+    // Reads the closures of an image before their code and environment.
+    friend class FaslReader;
+
+    Code* code_;
+    Frame* env_;
+};
+
+// A builtin that binary calls are compiled to an opcode for. The opcode only takes its fast
+// path while the global still holds the builtin.
+struct Primitive {
+    uint32_t symbol_id;
+    Opcode opcode;
+    Value function;
+};
@@ -0,0 +1,226 @@
+#include "compiler.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "error.h"
+#include "heap.h"
+
+namespace {
+template <class T>
+T CheckedOperand(size_t value, const char* what) {
+    if (value > std::numeric_limits<T>::max()) {
+        throw RuntimeError(std::string("compiler: too many ") + what);
+    }
+    return static_cast<T>(value);
+}
+}  // namespace
+
+Compiler::Compiler(std::span<const Primitive> primitives) : primitives_(primitives) {
+}
+
+Code* Compiler::Compile(const Node& node) {
+    Unit unit{.code = Make<Code>(), .enclosing = unit_};
+    unit_ = &unit;
+    node.Compile(*this, true);
+    Emit(Opcode::kReturn, -1);
+    unit_ = unit.enclosing;
+    // Room for the callee a primitive pushes when it falls back to a call.
+    ++unit.code->max_stack;
+    return unit.code;
+}
+
+void Compiler::CompileConstant(Value value) {
+    Emit(Opcode::kConstant, 1);
+    EmitOperand(AddConstant(value));
+}
+
+void Compiler::CompileVariable(const VariableRef& ref) {
+    if (ref.global) {
+        Emit(Opcode::kLoadGlobal, 1);
+        EmitOperand(ref.name->GetId());
+        return;
+    }
+    Emit(ref.checked ? Opcode::kLoadLocalChecked : Opcode::kLoadLocal, 1);
+    EmitOperand(ref.depth);
+    EmitOperand(ref.slot);
+    if (ref.checked) {
+        EmitOperand(AddConstant(ref.name));
+    }
+}
+
+void Compiler::CompileDefine(const VariableRef& ref, const Node& value) {
+    value.Compile(*this, false);
+    CompileStore(ref);
+    CompileConstant(ref.name);
+}
+
+void Compiler::CompileSet(const VariableRef& ref, const Node& value) {
+    if (ref.global || ref.checked) {
+        // The variable must exist before the value is evaluated.
+        CompileVariable(ref);
+        Emit(Opcode::kPop, -1);
+    }
+    value.Compile(*this, false);
+    CompileStore(ref);
+    Emit(Opcode::kNil, 1);
+}
+
+void Compiler::CompileIf(const Node& condition, const Node* consequent, const Node* alternative,
+                         bool tail) {
+    auto compile_branch = [&](const Node* branch) {
+        if (branch) {
+            branch->Compile(*this, tail);
+        } else {
+            Emit(Opcode::kNil, 1);
+        }
+    };
+    condition.Compile(*this, false);
+    auto to_alternative = EmitJump(Opcode::kJumpIfFalse, -1);
+    compile_branch(consequent);
+    auto to_end = EmitJump(Opcode::kJump, 0);
+    // The alternative starts without the value of the consequent on the stack.
+    --unit_->stack_depth;
+    PatchJump(to_alternative);
+    compile_branch(alternative);
+    PatchJump(to_end);
+}
+
+void Compiler::CompileAnd(const std::vector<NodePtr>& operands, bool tail) {
+    if (operands.empty()) {
+        CompileConstant(kTrue);
+        return;
+    }
+    std::vector<size_t> to_end;
+    for (size_t i = 0; i + 1 < operands.size(); ++i) {
+        operands[i]->Compile(*this, false);
+        to_end.push_back(EmitJump(Opcode::kJumpIfFalseKeep, -1));
+    }
+    operands.back()->Compile(*this, tail);
+    for (auto operand : to_end) {
+        PatchJump(operand);
+    }
+}
+
+void Compiler::CompileOr(const std::vector<NodePtr>& operands, bool tail) {
+    if (operands.empty()) {
+        CompileConstant(kFalse);
+        return;
+    }
+    std::vector<size_t> to_end;
+    for (size_t i = 0; i + 1 < operands.size(); ++i) {
+        operands[i]->Compile(*this, false);
+        to_end.push_back(EmitJump(Opcode::kJumpIfTrueKeep, -1));
+    }
+    operands.back()->Compile(*this, tail);
+    for (auto operand : to_end) {
+        PatchJump(operand);
+    }
+}
+
+void Compiler::CompileBegin(const std::vector<NodePtr>& forms, bool tail) {
+    for (size_t i = 0; i + 1 < forms.size(); ++i) {
+        forms[i]->Compile(*this, false);
+        Emit(Opcode::kPop, -1);
+    }
+    forms.back()->Compile(*this, tail);
+}
+
+void Compiler::CompileLambda(const LambdaCode& lambda) {
+    Unit unit{.code = Make<Code>(), .enclosing = unit_};
+    unit.code->param_count = lambda.params.size();
+    unit.code->frame_size = lambda.GetFrameSize();
+    unit.code->frame_captured = lambda.frame_captured;
+    unit_ = &unit;
+    CompileBegin(lambda.body, true);
+    Emit(Opcode::kReturn, -1);
+    unit_ = unit.enclosing;
+    ++unit.code->max_stack;
+
+    Emit(Opcode::kMakeClosure, 1);
+    EmitOperand(AddConstant(unit.code));
+}
+
+void Compiler::CompileCall(const Node& function, const std::vector<NodePtr>& args, bool tail) {
+    function.Compile(*this, false);
+    for (const auto& arg : args) {
+        arg->Compile(*this, false);
+    }
+    auto argc = CheckedOperand<uint16_t>(args.size(), "arguments");
+    Emit(tail ? Opcode::kTailCall : Opcode::kCall, -argc);
+    EmitOperand(argc);
+}
+
+void Compiler::CompileCall(const VariableRef& function, const std::vector<NodePtr>& args,
+                           bool tail) {
+    if (function.global && args.size() == 2) {
+        for (size_t i = 0; i < primitives_.size(); ++i) {
+            if (primitives_[i].symbol_id != function.name->GetId()) {
+                continue;
+            }
+            args[0]->Compile(*this, false);
+            args[1]->Compile(*this, false);
+            Emit(primitives_[i].opcode, -1);
+            EmitOperand(static_cast<uint8_t>(i));
+            return;
+        }
+    }
+    CompileVariable(function);
+    for (const auto& arg : args) {
+        arg->Compile(*this, false);
+    }
+    auto argc = CheckedOperand<uint16_t>(args.size(), "arguments");
+    Emit(tail ? Opcode::kTailCall : Opcode::kCall, -argc);
+    EmitOperand(argc);
+}
+
+void Compiler::CompileError(std::exception_ptr error) {
+    auto& errors = unit_->code->errors;
+    errors.push_back(std::move(error));
+    Emit(Opcode::kRaise, 1);
+    EmitOperand(CheckedOperand<uint16_t>(errors.size() - 1, "errors"));
+}
+
+void Compiler::CompileStore(const VariableRef& ref) {
+    if (ref.global) {
+        Emit(Opcode::kStoreGlobal, -1);
+        EmitOperand(ref.name->GetId());
+    } else {
+        Emit(Opcode::kStoreLocal, -1);
+        EmitOperand(ref.depth);
+        EmitOperand(ref.slot);
+    }
+}
+
+void Compiler::Emit(Opcode opcode, int stack_effect) {
+    auto& code = *unit_->code;
+    code.bytecode.push_back(static_cast<uint8_t>(opcode));
+    unit_->stack_depth += stack_effect;
+    code.max_stack = std::max(code.max_stack, unit_->stack_depth);
+}
+
+template <class T>
+void Compiler::EmitOperand(T operand) {
+    auto& bytecode = unit_->code->bytecode;
+    auto offset = bytecode.size();
+    bytecode.resize(offset + sizeof(T));
+    std::memcpy(bytecode.data() + offset, &operand, sizeof(T));
+}
+
+size_t Compiler::EmitJump(Opcode opcode, int stack_effect) {
+    Emit(opcode, stack_effect);
+    auto operand = unit_->code->bytecode.size();
+    EmitOperand<uint32_t>(0);
+    return operand;
+}
+
+void Compiler::PatchJump(size_t operand) {
+    auto& bytecode = unit_->code->bytecode;
+    auto target = CheckedOperand<uint32_t>(bytecode.size(), "instructions");
+    std::memcpy(bytecode.data() + operand, &target, sizeof(target));
+}
+
+uint16_t Compiler::AddConstant(Value value) {
+    auto& constants = unit_->code->constants;
+    constants.push_back(value);
+    return CheckedOperand<uint16_t>(constants.size() - 1, "constants");
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <vector>
+#include "analyzer.h"
+#include "bytecode.h"
+
+// Translates analyzed expressions to bytecode.
+class Compiler {
+public:
+    explicit Compiler(std::span<const Primitive> primitives);
+
+    // Compiles a top-level form into code taking no arguments.
+    Code* Compile(const Node& node);
+
+    // Called by the nodes to emit themselves.
+    void CompileConstant(Value value);
+    void CompileVariable(const VariableRef& ref);
+    void CompileDefine(const VariableRef& ref, const Node& value);
+    void CompileSet(const VariableRef& ref, const Node& value);
+    void CompileIf(const Node& condition, const Node* consequent, const Node* alternative,
+                   bool tail);
+    void CompileAnd(const std::vector<NodePtr>& operands, bool tail);
+    void CompileOr(const std::vector<NodePtr>& operands, bool tail);
+    void CompileBegin(const std::vector<NodePtr>& forms, bool tail);
+    void CompileLambda(const LambdaCode& lambda);
+    void CompileCall(const Node& function, const std::vector<NodePtr>& args, bool tail);
+    void CompileCall(const VariableRef& function, const std::vector<NodePtr>& args, bool tail);
+    void CompileError(std::exception_ptr error);
+
+private:
+    // Code being emitted, innermost first.
+    struct Unit {
+        Code* code;
+        Unit* enclosing;
+        uint32_t stack_depth = 0;
+    };
+
+    void CompileStore(const VariableRef& ref);
+
+    void Emit(Opcode opcode, int stack_effect);
+    template <class T>
+    void EmitOperand(T operand);
+    size_t EmitJump(Opcode opcode, int stack_effect);
+    void PatchJump(size_t operand);
+    uint16_t AddConstant(Value value);
+
+    std::span<const Primitive> primitives_;
+    Unit* unit_ = nullptr;
+};
@@ -0,0 +1,78 @@
+#include "continuation.h"
+#include <algorithm>
+#include "error.h"
+#include "heap.h"
+
+ContinuationFrame::ContinuationFrame(Code* code, uint32_t ip, Frame* env, Continuation* escape,
+                                     std::span<const Value> operands, ContinuationFrame* next)
+    : Object(kType),
+      code_(code),
+      env_(env),
+      escape_(escape),
+      next_(next),
+      depth_(next ? next->depth_ + 1 : 1),
+      ip_(ip),
+      operand_count_(operands.size()) {
+    std::ranges::copy(operands, reinterpret_cast<Value*>(this + 1));
+}
+
+ContinuationFrame* ContinuationFrame::Create(Code* code, uint32_t ip, Frame* env,
+                                             Continuation* escape,
+                                             std::span<const Value> operands,
+                                             ContinuationFrame* next) {
+    return Heap::Instance().MakeSized<ContinuationFrame>(
+        sizeof(ContinuationFrame) + operands.size() * sizeof(Value), code, ip, env, escape,
+        operands, next);
+}
+
+void ContinuationFrame::Trace(Heap& heap) const {
+    heap.Mark(code_);
+    heap.Mark(env_);
+    heap.Mark(escape_);
+    heap.Mark(next_);
+    for (auto operand : GetOperands()) {
+        heap.Mark(operand);
+    }
+}
+
+Continuation::Continuation(ContinuationFrame* frames) : Function(kType), frames_(frames) {
+}
+
+Value Continuation::operator()(std::span<const Value> args) {
+    if (args.size() != 1) {
+        throw RuntimeError("continuation must have 1 argument");
+    }
+    if (!active_) {
+        throw RuntimeError("continuation called after its call/cc returned");
+    }
+    throw ContinuationInvoked{this, args[0]};
+}
+
+void Continuation::Trace(Heap& heap) const {
+    heap.Mark(frames_);
+}
+
+Value CallWithEscape(Value function) {
+    if (!Is<Function>(function)) {
+        throw RuntimeError("Expected function applying");
+    }
+    auto* continuation = Make<Continuation>();
+    // The function may drop its argument, the continuation is still deactivated afterwards.
+    ScopedRoot root(continuation);
+    continuation->SetActive(true);
+    Value arg = continuation;
+    try {
+        auto result = (*As<Function>(function))(std::span<const Value>(&arg, 1));
+        continuation->SetActive(false);
+        return result;
+    } catch (const ContinuationInvoked& invoked) {
+        continuation->SetActive(false);
+        if (invoked.continuation != continuation) {
+            throw;
+        }
+        return invoked.value;
+    } catch (...) {
+        continuation->SetActive(false);
+        throw;
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "bytecode.h"
+#include "object.h"
+#include "scope.h"
+
+class Continuation;
+
+// Activation of compiled code moved to the heap when a continuation is captured: where it
+// resumes and the operands it had on the stack, stored right after the object. Saved
+// activations never change and point to the one they return to, so capturing the stack again
+// only saves the activations made since.
+class ContinuationFrame : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kContinuationFrame;
+
+    static ContinuationFrame* Create(Code* code, uint32_t ip, Frame* env, Continuation* escape,
+                                     std::span<const Value> operands, ContinuationFrame* next);
+
+    Code* GetCode() const {
+        return code_;
+    }
+
+    // Offset of the next instruction in the bytecode.
+    uint32_t GetIp() const {
+        return ip_;
+    }
+
+    Frame* GetEnv() const {
+        return env_;
+    }
+
+    // The escape-only continuation that returns to this activation, if any.
+    Continuation* GetEscape() const {
+        return escape_;
+    }
+
+    std::span<const Value> GetOperands() const {
+        return {reinterpret_cast<const Value*>(this + 1), operand_count_};
+    }
+
+    ContinuationFrame* GetNext() const {
+        return next_;
+    }
+
+    // Number of activations up to the bottom one, this one included.
+    uint64_t GetDepth() const {
+        return depth_;
+    }
+
+    void Trace(Heap& heap) const override;
+
+private:
+    friend class Heap;
+
+    ContinuationFrame(Code* code, uint32_t ip, Frame* env, Continuation* escape,
+                      std::span<const Value> operands, ContinuationFrame* next);
+
+    Code* code_;
+    Frame* env_;
+    Continuation* escape_;
+    ContinuationFrame* next_;
+    uint64_t depth_;
+    uint32_t ip_;
+    uint32_t operand_count_;
+};
+
+// The rest of a computation, captured by call/cc or call/ec and called with the value to
+// continue with.
+//
+// The virtual machine captures whole continuations, which can be called any number of times
+// from anywhere. The tree walker runs on the native stack, so its continuations can only
+// escape: they work until the call/cc that made them returns.
+class Continuation : public Function {
+public:
+    static constexpr ObjectType kType = ObjectType::kContinuation;
+
+    // Without frames the continuation only escapes.
+    explicit Continuation(ContinuationFrame* frames = nullptr);
+
+    ContinuationFrame* GetFrames() const {
+        return frames_;
+    }
+
+    bool IsEscapeOnly() const {
+        return frames_ == nullptr;
+    }
+
+    // Unwinds the native stack to the call/cc of the tree walker that made the continuation.
+    Value operator()(std::span<const Value> args) override;
+
+    // Whether the tree walker is still inside the call/cc that made the continuation.
+    void SetActive(bool active) {
+        active_ = active;
+    }
+
+    void Trace(Heap& heap) const override;
+
+private:
+    ContinuationFrame* frames_;
+    bool active_ = false;
+};
+
+// Thrown by a continuation of the tree walker, caught by the call/cc that made it.
+struct ContinuationInvoked {
+    Continuation* continuation;
+    Value value;
+};
+
+// Calls function with an escape-only continuation as its argument, the tree walker's call/cc.
+Value CallWithEscape(Value function);
@@ -0,0 +1,184 @@
+#include "equality.h"
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "number.h"
+#include "scheme-string.h"
+#include "vector.h"
+
+namespace {
+// The finalizer of splitmix64: spreads every input bit over the whole word.
+uint64_t Mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+uint64_t Combine(uint64_t hash, uint64_t value) {
+    return Mix(hash ^ (value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2)));
+}
+
+template <class V>
+bool AreEqualNumericVectors(const V* a, const V* b) {
+    auto x = a->GetElements();
+    auto y = b->GetElements();
+    return std::ranges::equal(x, y, [](auto p, auto q) {
+        if constexpr (std::is_same_v<decltype(p), double>) {
+            return std::bit_cast<uint64_t>(p) == std::bit_cast<uint64_t>(q);
+        } else {
+            return p == q;
+        }
+    });
+}
+
+// Pairs and vectors that AreEqual compares before it remembers which it has compared. Past it,
+// meeting the same two again means a cycle, and they are equal unless another path tells.
+constexpr size_t kMaxUnrememberedCompares = 1024;
+
+struct PairHash {
+    size_t operator()(const std::pair<Value, Value>& pair) const {
+        return Combine(Mix(pair.first.GetBits()), pair.second.GetBits());
+    }
+};
+
+// Pairs, vectors and their elements visited by HashEqual at most.
+constexpr size_t kMaxHashedNodes = 64;
+// Leading bytes of a string and elements of a numeric vector that HashEqual reads at most.
+constexpr size_t kMaxHashedBytes = 256;
+constexpr size_t kMaxHashedElements = 32;
+
+template <class V>
+uint64_t HashNumericVector(const V* vector) {
+    auto elements = vector->GetElements();
+    uint64_t hash = Mix(elements.size());
+    for (auto element : elements.first(std::min(elements.size(), kMaxHashedElements))) {
+        hash = Combine(hash, std::bit_cast<uint64_t>(element));
+    }
+    return hash;
+}
+
+uint64_t HashString(std::string_view text) {
+    auto prefix = text.substr(0, kMaxHashedBytes);
+    return Combine(Mix(text.size()), std::hash<std::string_view>{}(prefix));
+}
+}  // namespace
+
+bool AreEqv(Value a, Value b) {
+    if (a == b) {
+        return true;
+    }
+    if (Is<Bignum>(a) && Is<Bignum>(b)) {
+        return CompareNumbers(a, b) == 0;
+    }
+    if (Is<Flonum>(a) && Is<Flonum>(b)) {
+        return std::bit_cast<uint64_t>(As<Flonum>(a)->GetValue()) ==
+               std::bit_cast<uint64_t>(As<Flonum>(b)->GetValue());
+    }
+    return false;
+}
+
+bool AreEqual(Value a, Value b) {
+    std::vector<std::pair<Value, Value>> pending{{a, b}};
+    size_t compares = 0;
+    std::unordered_set<std::pair<Value, Value>, PairHash> compared;
+    while (!pending.empty()) {
+        auto [x, y] = pending.back();
+        pending.pop_back();
+        if (AreEqv(x, y)) {
+            continue;
+        }
+        if ((Is<Cell>(x) && Is<Cell>(y)) || (Is<Vector>(x) && Is<Vector>(y))) {
+            if (compares == kMaxUnrememberedCompares) {
+                if (!compared.emplace(x, y).second) {
+                    continue;
+                }
+            } else {
+                ++compares;
+            }
+        }
+        if (Is<Cell>(x) && Is<Cell>(y)) {
+            pending.emplace_back(As<Cell>(x)->GetSecond(), As<Cell>(y)->GetSecond());
+            pending.emplace_back(As<Cell>(x)->GetFirst(), As<Cell>(y)->GetFirst());
+        } else if (Is<Vector>(x) && Is<Vector>(y)) {
+            auto xs = As<Vector>(x)->GetElements();
+            auto ys = As<Vector>(y)->GetElements();
+            if (xs.size() != ys.size()) {
+                return false;
+            }
+            for (size_t i = xs.size(); i-- > 0;) {
+                pending.emplace_back(xs[i], ys[i]);
+            }
+        } else if (Is<String>(x) && Is<String>(y)) {
+            if (As<String>(x)->GetView() != As<String>(y)->GetView()) {
+                return false;
+            }
+        } else if (Is<S64Vector>(x) && Is<S64Vector>(y)) {
+            if (!AreEqualNumericVectors(As<S64Vector>(x), As<S64Vector>(y))) {
+                return false;
+            }
+        } else if (Is<F64Vector>(x) && Is<F64Vector>(y)) {
+            if (!AreEqualNumericVectors(As<F64Vector>(x), As<F64Vector>(y))) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t HashEq(Value value) {
+    return Mix(value.GetBits());
+}
+
+uint64_t HashEqv(Value value) {
+    if (Is<Bignum>(value)) {
+        auto* bignum = As<Bignum>(value);
+        uint64_t hash = Mix(bignum->IsNegative());
+        for (auto limb : bignum->GetMagnitude()) {
+            hash = Combine(hash, limb);
+        }
+        return hash;
+    }
+    if (Is<Flonum>(value)) {
+        return Mix(std::bit_cast<uint64_t>(As<Flonum>(value)->GetValue()));
+    }
+    return HashEq(value);
+}
+
+uint64_t HashEqual(Value value) {
+    uint64_t hash = 0;
+    size_t budget = kMaxHashedNodes;
+    std::vector<Value> pending{value};
+    while (!pending.empty() && budget > 0) {
+        --budget;
+        auto next = pending.back();
+        pending.pop_back();
+        if (Is<Cell>(next)) {
+            hash = Combine(hash, static_cast<uint64_t>(ObjectType::kCell));
+            pending.push_back(As<Cell>(next)->GetSecond());
+            pending.push_back(As<Cell>(next)->GetFirst());
+        } else if (Is<Vector>(next)) {
+            auto elements = As<Vector>(next)->GetElements();
+            hash = Combine(hash, Mix(elements.size()));
+            // Only the elements the budget can still visit are pushed.
+            for (size_t i = std::min(elements.size(), budget); i-- > 0;) {
+                pending.push_back(elements[i]);
+            }
+        } else if (Is<String>(next)) {
+            hash = Combine(hash, HashString(As<String>(next)->GetView()));
+        } else if (Is<S64Vector>(next)) {
+            hash = Combine(hash, HashNumericVector(As<S64Vector>(next)));
+        } else if (Is<F64Vector>(next)) {
+            hash = Combine(hash, HashNumericVector(As<F64Vector>(next)));
+        } else {
+            hash = Combine(hash, HashEqv(next));
+        }
+    }
+    return hash;
+}
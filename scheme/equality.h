@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include "object.h"
+
+// The equivalences of eq?, eqv? and equal?, with hash functions that agree with them: equivalent
+// values hash the same.
+//
+// eq? is identity. eqv? also holds for numbers of the same exactness and value; flonums must
+// have the same bits, so NaNs are eqv? to themselves and 0.0 isn't eqv? to -0.0. equal?
+// compares pairs and vectors element by element, and strings by their characters, and holds
+// for cyclic data that unfolds the same. Neither traversal recurses.
+
+bool AreEqv(Value a, Value b);
+bool AreEqual(Value a, Value b);
+
+uint64_t HashEq(Value value);
+uint64_t HashEqv(Value value);
+// Hashes a bounded prefix of the structure, and of the strings and numeric vectors in it, so it
+// takes constant time on large data.
+uint64_t HashEqual(Value value);
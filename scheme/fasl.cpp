@@ -0,0 +1,982 @@
+#include "fasl.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include "builtin-functions.h"
+#include "bytecode.h"
+#include "error.h"
+#include "hash-table.h"
+#include "heap.h"
+#include "number.h"
+#include "scheme-string.h"
+#include "vector.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SCHEME_MMAP 1
+#else
+#define SCHEME_MMAP 0
+#endif
+
+// Layout, with every count and index a varint (LEB128):
+//   magic, symbol count, symbols as length and bytes, datum count, data.
+// A datum is a tag byte and what the tag needs:
+//   fixnum: zigzag varint;          bignum: sign byte, limb count, limbs as varints;
+//   flonum: 8 bytes, little-endian; symbol: index into the table;
+//   string: length, bytes;          cell: car, cdr;
+//   vector: size, elements;         s64vector: size, zigzag varints;
+//   f64vector: size, 8 bytes each;  label: the object that follows is referred to later;
+//   reference: the index of a label of the same datum, in the order they were read.
+// An image has its own magic and adds:
+//   unbound;                        builtin: symbol index of its name;
+//   hash table: equivalence byte, entry count, then each key and its value;
+//   code: parameter count, frame size, captured byte, stack size, bytecode as length and
+//         bytes with the ids of globals replaced by symbol indices, errors as kind byte and
+//         message, constant count, constants;
+//   closure: code, environment;     frame: slot count, parent, slots.
+
+namespace {
+constexpr std::string_view kMagic{"\0SCMFASL", 8};
+constexpr std::string_view kImageMagic{"\0SCMIMAG", 8};
+constexpr uint64_t kVersion = 1;
+
+enum class Tag : uint8_t {
+    kNil,
+    kFalse,
+    kTrue,
+    kFixnum,
+    kBignum,
+    kFlonum,
+    kSymbol,
+    kString,
+    kCell,
+    kVector,
+    kS64Vector,
+    kF64Vector,
+    kLabel,
+    kReference,
+    kUnbound,
+    kBuiltin,
+    kHashTable,
+    kCode,
+    kClosure,
+    kFrame
+};
+
+// The analysis errors code raises, which are rethrown as they were made.
+enum class ErrorKind : uint8_t {
+    kSyntax,
+    kRuntime,
+    kName
+};
+
+constexpr std::string_view kNamePrefix = "Name not found: ";
+
+// Every plain function is a builtin, closures and continuations have types of their own.
+const Builtin* AsBuiltin(Value value) {
+    return Is<Function>(value) && value.GetObject()->GetType() == ObjectType::kFunction
+               ? static_cast<const Builtin*>(As<Function>(value))
+               : nullptr;
+}
+
+uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+[[noreturn]] void ThrowMalformed() {
+    throw SyntaxError("malformed fasl");
+}
+
+// Calls visit with the opcode and the operands of each instruction of bytecode that has been
+// checked to hold whole instructions.
+template <class Visit>
+void ForEachInstruction(const Code& code, Visit visit) {
+    const auto& bytecode = code.bytecode;
+    for (size_t ip = 0; ip < bytecode.size(); ip += 1 + GetOperandSize(Opcode{bytecode[ip]})) {
+        visit(Opcode{bytecode[ip]}, bytecode.data() + ip + 1);
+    }
+}
+
+// Checks that the bytecode of a code stays within the code as it runs. Operands must index its
+// constants, its errors and the slots of its own frame. Jumps must go forward, as compiled
+// ones do, to an instruction, and no instruction may run off the end. The stack must have one
+// height at each instruction, however it is reached, never drop below where the code started
+// it and stay below max_stack.
+void CheckBytecode(const Code& code) {
+    const auto& bytecode = code.bytecode;
+    if (code.frame_size > UINT16_MAX || code.param_count > code.frame_size ||
+        code.max_stack == 0 || code.max_stack > bytecode.size() + 1) {
+        ThrowMalformed();
+    }
+    auto check_index = [](size_t index, size_t size) {
+        if (index >= size) {
+            ThrowMalformed();
+        }
+    };
+    std::vector<bool> starts(bytecode.size());
+    for (size_t ip = 0; ip < bytecode.size(); ip += 1 + GetOperandSize(Opcode{bytecode[ip]})) {
+        starts[ip] = true;
+        auto opcode = Opcode{bytecode[ip]};
+        const auto* operands = bytecode.data() + ip + 1;
+        switch (opcode) {
+            case Opcode::kLoadLocalChecked:
+                check_index(ReadOperand<uint16_t>(operands + 4), code.constants.size());
+                [[fallthrough]];
+            case Opcode::kLoadLocal:
+            case Opcode::kStoreLocal:
+                // Frames further out are checked once the datum is whole.
+                if (ReadOperand<uint16_t>(operands) == 0 && code.frame_size != 0) {
+                    check_index(ReadOperand<uint16_t>(operands + 2), code.frame_size);
+                }
+                break;
+            case Opcode::kConstant:
+                check_index(ReadOperand<uint16_t>(operands), code.constants.size());
+                break;
+            case Opcode::kMakeClosure:
+                check_index(ReadOperand<uint16_t>(operands), code.constants.size());
+                // The closure keeps the frame, which mustn't come from the FramePool then.
+                if (code.frame_size != 0 && !code.frame_captured) {
+                    ThrowMalformed();
+                }
+                break;
+            case Opcode::kRaise:
+                check_index(ReadOperand<uint16_t>(operands), code.errors.size());
+                break;
+            default:
+                if (opcode >= Opcode::kAdd) {
+                    check_index(*operands, kPrimitiveCount);
+                }
+        }
+    }
+
+    constexpr uint32_t kUnreached = UINT32_MAX;
+    std::vector<uint32_t> heights(bytecode.size(), kUnreached);
+    std::vector<size_t> pending;
+    auto reach = [&](size_t ip, uint32_t height) {
+        if (ip >= bytecode.size() || !starts[ip]) {
+            ThrowMalformed();
+        }
+        if (heights[ip] == kUnreached) {
+            heights[ip] = height;
+            pending.push_back(ip);
+        } else if (heights[ip] != height) {
+            ThrowMalformed();
+        }
+    };
+    reach(0, 0);
+    while (!pending.empty()) {
+        auto ip = pending.back();
+        pending.pop_back();
+        auto opcode = Opcode{bytecode[ip]};
+        const auto* operands = bytecode.data() + ip + 1;
+        auto height = heights[ip];
+        uint32_t pops = 0;
+        uint32_t pushes = 0;
+        bool jumps = false;
+        // Whether the jump leaves the value it tests on the stack.
+        bool keeps = false;
+        bool falls_through = true;
+        switch (opcode) {
+            case Opcode::kConstant:
+            case Opcode::kNil:
+            case Opcode::kLoadLocal:
+            case Opcode::kLoadLocalChecked:
+            case Opcode::kLoadGlobal:
+            case Opcode::kMakeClosure:
+                pushes = 1;
+                break;
+            case Opcode::kPop:
+            case Opcode::kStoreLocal:
+            case Opcode::kStoreGlobal:
+                pops = 1;
+                break;
+            case Opcode::kJump:
+                jumps = true;
+                falls_through = false;
+                break;
+            case Opcode::kJumpIfFalse:
+                jumps = true;
+                pops = 1;
+                break;
+            case Opcode::kJumpIfFalseKeep:
+            case Opcode::kJumpIfTrueKeep:
+                jumps = true;
+                keeps = true;
+                pops = 1;
+                break;
+            case Opcode::kCall:
+                pops = ReadOperand<uint16_t>(operands) + 1;
+                pushes = 1;
+                break;
+            case Opcode::kTailCall:
+                pops = ReadOperand<uint16_t>(operands) + 1;
+                falls_through = false;
+                break;
+            case Opcode::kReturn:
+                pops = 1;
+                falls_through = false;
+                break;
+            case Opcode::kRaise:
+                falls_through = false;
+                break;
+            default:
+                // A binary primitive, whose fallback call takes one more slot, above the
+                // height it starts at: below max_stack as every height is.
+                pops = 2;
+                pushes = 1;
+        }
+        if (height < pops) {
+            ThrowMalformed();
+        }
+        auto after = height - pops + pushes;
+        if (after >= code.max_stack) {
+            ThrowMalformed();
+        }
+        if (jumps) {
+            auto target = ReadOperand<uint32_t>(operands);
+            if (target <= ip) {
+                ThrowMalformed();
+            }
+            reach(target, keeps ? height : after);
+        }
+        if (falls_through) {
+            reach(ip + 1 + GetOperandSize(opcode), after);
+        }
+    }
+}
+
+// Slot counts of the frames a code needs around the closures of it, innermost first.
+using FrameNeeds = std::vector<uint32_t>;
+
+void Need(FrameNeeds* needs, size_t depth, uint32_t slots) {
+    if (depth >= needs->size()) {
+        needs->resize(depth + 1);
+    }
+    (*needs)[depth] = std::max((*needs)[depth], slots);
+}
+
+// Finds the objects reachable more than once from datum, mapped to true, and checks that
+// every object has a fasl form of the kind.
+std::unordered_map<Object*, bool> FindShared(Value datum, FaslKind kind) {
+    bool image = kind == FaslKind::kImage;
+    std::unordered_map<Object*, bool> shared;
+    std::vector<Value> stack{datum};
+    while (!stack.empty()) {
+        auto value = stack.back();
+        stack.pop_back();
+        if (!value.IsObject() || Is<Symbol>(value) || (image && AsBuiltin(value))) {
+            continue;
+        }
+        auto [it, inserted] = shared.emplace(value.GetObject(), false);
+        if (!inserted) {
+            it->second = true;
+            continue;
+        }
+        if (Is<Cell>(value)) {
+            stack.push_back(As<Cell>(value)->GetSecond());
+            stack.push_back(As<Cell>(value)->GetFirst());
+        } else if (Is<Vector>(value)) {
+            auto elements = As<Vector>(value)->GetElements();
+            stack.insert(stack.end(), elements.begin(), elements.end());
+        } else if (image && Is<HashTable>(value)) {
+            As<HashTable>(value)->ForEach([&stack](Value key, Value entry) {
+                stack.push_back(key);
+                stack.push_back(entry);
+            });
+        } else if (image && Is<Code>(value)) {
+            auto& constants = As<Code>(value)->constants;
+            stack.insert(stack.end(), constants.begin(), constants.end());
+        } else if (image && Is<CompiledClosure>(value)) {
+            stack.push_back(As<CompiledClosure>(value)->GetCode());
+            stack.push_back(As<CompiledClosure>(value)->GetEnv());
+        } else if (image && Is<Frame>(value)) {
+            auto* frame = As<Frame>(value);
+            stack.push_back(frame->GetParent());
+            stack.insert(stack.end(), frame->GetSlots(), frame->GetSlots() + frame->GetSize());
+        } else if (!Is<Bignum>(value) && !Is<Flonum>(value) && !Is<String>(value) &&
+                   !Is<S64Vector>(value) && !Is<F64Vector>(value)) {
+            throw RuntimeError(image ? "only data and compiled procedures can be saved in an image"
+                                     : "only data can be written to a fasl");
+        }
+    }
+    std::erase_if(shared, [](const auto& entry) { return !entry.second; });
+    return shared;
+}
+}  // namespace
+
+bool IsFasl(std::string_view bytes) {
+    return bytes.starts_with(kMagic);
+}
+
+bool IsImage(std::string_view bytes) {
+    return bytes.starts_with(kImageMagic);
+}
+
+void FaslWriter::Add(Value datum) {
+    auto shared = FindShared(datum, kind_);
+    Write(datum, shared);
+    ++count_;
+}
+
+std::string FaslWriter::Finish() const {
+    FaslWriter header;
+    header.data_ = kind_ == FaslKind::kImage ? kImageMagic : kMagic;
+    header.WriteVarint(kVersion);
+    header.WriteVarint(symbols_.size());
+    for (auto* symbol : symbols_) {
+        header.WriteBytes(symbol->GetName());
+    }
+    header.WriteVarint(count_);
+    return header.data_ + data_;
+}
+
+void FaslWriter::Write(Value datum, const std::unordered_map<Object*, bool>& shared) {
+    // Labels of the shared objects, numbered as they are written.
+    std::unordered_map<Object*, uint64_t> labels;
+    auto tag = [this](Tag tag) { data_ += static_cast<char>(tag); };
+    std::vector<Value> stack{datum};
+    while (!stack.empty()) {
+        auto value = stack.back();
+        stack.pop_back();
+        if (value.IsNil()) {
+            tag(Tag::kNil);
+        } else if (value.IsBoolean()) {
+            tag(value.GetBoolean() ? Tag::kTrue : Tag::kFalse);
+        } else if (value.IsFixnum()) {
+            tag(Tag::kFixnum);
+            WriteVarint(ZigZag(value.GetFixnum()));
+        } else if (value.IsUnbound()) {
+            tag(Tag::kUnbound);
+        } else if (Is<Symbol>(value)) {
+            tag(Tag::kSymbol);
+            WriteVarint(GetSymbolIndex(As<Symbol>(value)));
+        } else if (auto* builtin = AsBuiltin(value)) {
+            tag(Tag::kBuiltin);
+            WriteVarint(GetSymbolIndex(Symbol::Intern(builtin->GetName())));
+        } else {
+            auto* object = value.GetObject();
+            if (shared.contains(object)) {
+                if (auto it = labels.find(object); it != labels.end()) {
+                    tag(Tag::kReference);
+                    WriteVarint(it->second);
+                    continue;
+                }
+                labels.emplace(object, labels.size());
+                tag(Tag::kLabel);
+            }
+            if (Is<Cell>(value)) {
+                tag(Tag::kCell);
+                stack.push_back(As<Cell>(value)->GetSecond());
+                stack.push_back(As<Cell>(value)->GetFirst());
+            } else if (Is<Vector>(value)) {
+                auto elements = As<Vector>(value)->GetElements();
+                tag(Tag::kVector);
+                WriteVarint(elements.size());
+                stack.insert(stack.end(), elements.rbegin(), elements.rend());
+            } else if (Is<String>(value)) {
+                tag(Tag::kString);
+                WriteBytes(As<String>(value)->GetView());
+            } else if (Is<Flonum>(value)) {
+                tag(Tag::kFlonum);
+                WriteFixed64(std::bit_cast<uint64_t>(As<Flonum>(value)->GetValue()));
+            } else if (Is<Bignum>(value)) {
+                auto* bignum = As<Bignum>(value);
+                tag(Tag::kBignum);
+                data_ += static_cast<char>(bignum->IsNegative());
+                WriteVarint(bignum->GetMagnitude().size());
+                for (auto limb : bignum->GetMagnitude()) {
+                    WriteVarint(limb);
+                }
+            } else if (Is<S64Vector>(value)) {
+                auto elements = As<S64Vector>(value)->GetElements();
+                tag(Tag::kS64Vector);
+                WriteVarint(elements.size());
+                for (auto element : elements) {
+                    WriteVarint(ZigZag(element));
+                }
+            } else if (Is<HashTable>(value)) {
+                auto* table = As<HashTable>(value);
+                tag(Tag::kHashTable);
+                data_ += static_cast<char>(table->GetEquivalence());
+                WriteVarint(table->GetCount());
+                auto entries = stack.size();
+                table->ForEach([&stack](Value key, Value entry) {
+                    stack.push_back(key);
+                    stack.push_back(entry);
+                });
+                std::reverse(stack.begin() + entries, stack.end());
+            } else if (Is<Code>(value)) {
+                auto* code = As<Code>(value);
+                tag(Tag::kCode);
+                WriteCode(*code);
+                stack.insert(stack.end(), code->constants.rbegin(), code->constants.rend());
+            } else if (Is<CompiledClosure>(value)) {
+                tag(Tag::kClosure);
+                stack.push_back(As<CompiledClosure>(value)->GetEnv());
+                stack.push_back(As<CompiledClosure>(value)->GetCode());
+            } else if (Is<Frame>(value)) {
+                auto* frame = As<Frame>(value);
+                tag(Tag::kFrame);
+                WriteVarint(frame->GetSize());
+                for (auto i = frame->GetSize(); i-- > 0;) {
+                    stack.push_back(frame->GetSlots()[i]);
+                }
+                stack.push_back(frame->GetParent());
+            } else {
+                auto elements = As<F64Vector>(value)->GetElements();
+                tag(Tag::kF64Vector);
+                WriteVarint(elements.size());
+                for (auto element : elements) {
+                    WriteFixed64(std::bit_cast<uint64_t>(element));
+                }
+            }
+        }
+    }
+}
+
+void FaslWriter::WriteCode(const Code& code) {
+    WriteVarint(code.param_count);
+    WriteVarint(code.frame_size);
+    data_ += static_cast<char>(code.frame_captured);
+    WriteVarint(code.max_stack);
+    // Symbol ids are given out as symbols are interned, so they differ between processes.
+    auto bytecode = code.bytecode;
+    for (size_t ip = 0; ip < bytecode.size(); ip += 1 + GetOperandSize(Opcode{bytecode[ip]})) {
+        auto opcode = Opcode{bytecode[ip]};
+        if (opcode == Opcode::kLoadGlobal || opcode == Opcode::kStoreGlobal) {
+            auto id = ReadOperand<uint32_t>(&bytecode[ip + 1]);
+            auto index = static_cast<uint32_t>(GetSymbolIndex(Symbol::FromId(id)));
+            std::memcpy(&bytecode[ip + 1], &index, sizeof(index));
+        }
+    }
+    WriteBytes({reinterpret_cast<const char*>(bytecode.data()), bytecode.size()});
+    WriteVarint(code.errors.size());
+    for (const auto& error : code.errors) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const SyntaxError& ex) {
+            data_ += static_cast<char>(ErrorKind::kSyntax);
+            WriteBytes(ex.what());
+        } catch (const NameError& ex) {
+            data_ += static_cast<char>(ErrorKind::kName);
+            WriteBytes(std::string_view{ex.what()}.substr(kNamePrefix.size()));
+        } catch (const std::exception& ex) {
+            data_ += static_cast<char>(ErrorKind::kRuntime);
+            WriteBytes(ex.what());
+        }
+    }
+    WriteVarint(code.constants.size());
+}
+
+void FaslWriter::WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+        data_ += static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    data_ += static_cast<char>(value);
+}
+
+void FaslWriter::WriteFixed64(uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        data_ += static_cast<char>(value >> (i * 8));
+    }
+}
+
+void FaslWriter::WriteBytes(std::string_view bytes) {
+    WriteVarint(bytes.size());
+    data_ += bytes;
+}
+
+uint64_t FaslWriter::GetSymbolIndex(Symbol* symbol) {
+    auto [it, inserted] = symbol_indices_.emplace(symbol, symbols_.size());
+    if (inserted) {
+        symbols_.push_back(symbol);
+    }
+    return it->second;
+}
+
+FaslReader::FaslReader(std::string_view bytes) : bytes_(bytes) {
+    if (!IsFasl(bytes)) {
+        throw SyntaxError("not a fasl");
+    }
+    ReadHeader();
+}
+
+FaslReader::FaslReader(std::string_view bytes, const Globals* builtins)
+    : bytes_(bytes), builtins_(builtins) {
+    if (!IsImage(bytes)) {
+        throw SyntaxError("not an image");
+    }
+    ReadHeader();
+}
+
+void FaslReader::ReadHeader() {
+    position_ = kMagic.size();
+    if (ReadVarint() != kVersion) {
+        throw SyntaxError("unsupported fasl version");
+    }
+    symbols_.resize(ReadCount());
+    for (auto& symbol : symbols_) {
+        symbol = Symbol::Intern(ReadBytes(ReadCount()));
+    }
+    remaining_ = ReadCount();
+}
+
+bool FaslReader::IsEnd() const {
+    return remaining_ == 0;
+}
+
+Value FaslReader::Next() {
+    if (IsEnd()) {
+        throw SyntaxError("no more data in fasl");
+    }
+    --remaining_;
+    labels_.clear();
+    codes_.clear();
+    closures_.clear();
+
+    // The objects whose elements are still to be read, innermost last. A cell leaves before its
+    // cdr is read, so long lists don't grow the stack.
+    struct Pending {
+        Value container;
+        size_t index;
+        size_t size;
+    };
+    std::vector<Pending> pending;
+    // Hash tables, keys and values in turn. Entries are added once the datum is whole, so that
+    // keys hash as they are and not as they are while read.
+    std::vector<Value> entries;
+    auto& heap = Heap::Instance();
+    Value result;
+    for (;;) {
+        auto tag = static_cast<Tag>(ReadByte());
+        bool labeled = tag == Tag::kLabel;
+        if (labeled) {
+            tag = static_cast<Tag>(ReadByte());
+        }
+        if (tag >= Tag::kUnbound && !builtins_) {
+            ThrowMalformed();
+        }
+        Value value;
+        size_t size = 0;
+        switch (tag) {
+            case Tag::kNil:
+                break;
+            case Tag::kFalse:
+            case Tag::kTrue:
+                value = Value::Boolean(tag == Tag::kTrue);
+                break;
+            case Tag::kFixnum: {
+                auto fixnum = UnZigZag(ReadVarint());
+                if (!FitsFixnum(fixnum)) {
+                    ThrowMalformed();
+                }
+                value = Value::Fixnum(fixnum);
+                break;
+            }
+            case Tag::kSymbol: {
+                auto index = ReadVarint();
+                if (index >= symbols_.size()) {
+                    ThrowMalformed();
+                }
+                value = symbols_[index];
+                break;
+            }
+            case Tag::kReference: {
+                auto index = ReadVarint();
+                if (index >= labels_.size()) {
+                    ThrowMalformed();
+                }
+                value = labels_[index];
+                break;
+            }
+            case Tag::kCell:
+                value = heap.Make<Cell>(nullptr, nullptr);
+                size = 2;
+                break;
+            case Tag::kVector:
+                size = ReadCount();
+                value = Vector::Create(size, nullptr);
+                break;
+            case Tag::kString:
+                value = String::Create(ReadBytes(ReadCount()));
+                break;
+            case Tag::kFlonum:
+                value = MakeFlonum(std::bit_cast<double>(ReadFixed64()));
+                break;
+            case Tag::kBignum: {
+                bool negative = ReadByte() != 0;
+                std::vector<uint32_t> magnitude(ReadCount());
+                for (auto& limb : magnitude) {
+                    limb = ReadVarint32();
+                }
+                if (magnitude.size() < 2 || magnitude.back() == 0) {
+                    ThrowMalformed();
+                }
+                value = Bignum::Create(negative, magnitude);
+                break;
+            }
+            case Tag::kS64Vector: {
+                auto* vector = S64Vector::Create(ReadCount());
+                for (auto& element : vector->GetElements()) {
+                    element = UnZigZag(ReadVarint());
+                }
+                value = vector;
+                break;
+            }
+            case Tag::kF64Vector: {
+                auto* vector = F64Vector::Create(ReadCount(8));
+                for (auto& element : vector->GetElements()) {
+                    element = std::bit_cast<double>(ReadFixed64());
+                }
+                value = vector;
+                break;
+            }
+            case Tag::kUnbound:
+                value = Value::Unbound();
+                break;
+            case Tag::kBuiltin: {
+                auto index = ReadVarint();
+                if (index >= symbols_.size()) {
+                    ThrowMalformed();
+                }
+                value = builtins_->Find(symbols_[index]->GetId());
+                if (!AsBuiltin(value)) {
+                    throw SyntaxError("no builtin " + symbols_[index]->GetName());
+                }
+                break;
+            }
+            case Tag::kHashTable: {
+                auto equivalence = ReadByte();
+                if (equivalence > static_cast<uint8_t>(HashTable::Equivalence::kEqual)) {
+                    ThrowMalformed();
+                }
+                value = heap.Make<HashTable>(static_cast<HashTable::Equivalence>(equivalence));
+                size = ReadCount(2) * 2;
+                break;
+            }
+            case Tag::kCode: {
+                auto* code = ReadCode();
+                value = code;
+                size = code->constants.size();
+                break;
+            }
+            case Tag::kClosure:
+                closures_.push_back(heap.Make<CompiledClosure>(nullptr, nullptr));
+                value = closures_.back();
+                size = 2;
+                break;
+            case Tag::kFrame: {
+                auto slots = ReadCount();
+                if (slots > UINT32_MAX) {
+                    ThrowMalformed();
+                }
+                value = Frame::Create(nullptr, slots);
+                size = slots + 1;
+                break;
+            }
+            default:
+                ThrowMalformed();
+        }
+        if (labeled) {
+            if (!value.IsObject() || Is<Symbol>(value)) {
+                ThrowMalformed();
+            }
+            labels_.push_back(value);
+        }
+
+        if (pending.empty()) {
+            result = value;
+        } else {
+            auto& parent = pending.back();
+            auto as_frame = [](Value value) {
+                if (!value.IsNil() && !Is<Frame>(value)) {
+                    ThrowMalformed();
+                }
+                return value.IsNil() ? nullptr : As<Frame>(value);
+            };
+            switch (parent.container.GetObject()->GetType()) {
+                case ObjectType::kCell: {
+                    auto* cell = As<Cell>(parent.container);
+                    parent.index == 0 ? cell->SetFirst(value) : cell->SetSecond(value);
+                    break;
+                }
+                case ObjectType::kVector:
+                    As<Vector>(parent.container)->GetElements()[parent.index] = value;
+                    break;
+                case ObjectType::kHashTable:
+                    if (parent.index % 2 == 0) {
+                        entries.push_back(parent.container);
+                    }
+                    entries.push_back(value);
+                    break;
+                case ObjectType::kCode:
+                    As<Code>(parent.container)->constants[parent.index] = value;
+                    break;
+                case ObjectType::kCompiledClosure: {
+                    auto* closure = As<CompiledClosure>(parent.container);
+                    if (parent.index == 1) {
+                        closure->env_ = as_frame(value);
+                    } else if (Is<Code>(value)) {
+                        closure->code_ = As<Code>(value);
+                    } else {
+                        ThrowMalformed();
+                    }
+                    break;
+                }
+                default: {
+                    auto* frame = As<Frame>(parent.container);
+                    if (parent.index == 0) {
+                        frame->parent_ = as_frame(value);
+                    } else {
+                        frame->GetSlots()[parent.index - 1] = value;
+                    }
+                }
+            }
+            if (++parent.index == parent.size) {
+                pending.pop_back();
+            }
+        }
+        if (size != 0) {
+            pending.push_back({value, 0, size});
+        }
+        if (pending.empty()) {
+            CheckCodes();
+            for (size_t i = 0; i < entries.size(); i += 3) {
+                As<HashTable>(entries[i])->Set(entries[i + 1], entries[i + 2]);
+            }
+            labels_.clear();
+            return result;
+        }
+    }
+}
+
+Code* FaslReader::ReadCode() {
+    auto* code = Heap::Instance().Make<Code>();
+    code->param_count = ReadVarint32();
+    code->frame_size = ReadVarint32();
+    code->frame_captured = ReadByte() != 0;
+    code->max_stack = ReadVarint32();
+    auto bytes = ReadBytes(ReadCount());
+    auto& bytecode = code->bytecode;
+    bytecode.assign(bytes.begin(), bytes.end());
+    for (size_t ip = 0; ip < bytecode.size();) {
+        if (bytecode[ip] > static_cast<uint8_t>(Opcode::kNumEqual)) {
+            ThrowMalformed();
+        }
+        auto opcode = Opcode{bytecode[ip]};
+        auto next = ip + 1 + GetOperandSize(opcode);
+        if (next > bytecode.size()) {
+            ThrowMalformed();
+        }
+        if (opcode == Opcode::kLoadGlobal || opcode == Opcode::kStoreGlobal) {
+            auto index = ReadOperand<uint32_t>(&bytecode[ip + 1]);
+            if (index >= symbols_.size()) {
+                ThrowMalformed();
+            }
+            auto id = symbols_[index]->GetId();
+            std::memcpy(&bytecode[ip + 1], &id, sizeof(id));
+        }
+        ip = next;
+    }
+    code->errors.resize(ReadCount(2));
+    for (auto& error : code->errors) {
+        auto kind = static_cast<ErrorKind>(ReadByte());
+        std::string message{ReadBytes(ReadCount())};
+        if (kind == ErrorKind::kSyntax) {
+            error = std::make_exception_ptr(SyntaxError(message));
+        } else if (kind == ErrorKind::kRuntime) {
+            error = std::make_exception_ptr(RuntimeError(message));
+        } else if (kind == ErrorKind::kName) {
+            error = std::make_exception_ptr(NameError(message));
+        } else {
+            ThrowMalformed();
+        }
+    }
+    code->constants.resize(ReadCount());
+    CheckBytecode(*code);
+    codes_.push_back(code);
+    return code;
+}
+
+void FaslReader::CheckCodes() {
+    // The needs of a code take in those of its lambdas, which are found first. Lambdas nest
+    // as the source did, a cycle among codes is malformed.
+    std::unordered_map<Code*, FrameNeeds> needs;
+    std::unordered_set<Code*> open;
+    std::vector<Code*> stack;
+    for (auto* root : codes_) {
+        stack.push_back(root);
+        while (!stack.empty()) {
+            auto* code = stack.back();
+            if (needs.contains(code)) {
+                stack.pop_back();
+                continue;
+            }
+            auto lambda_at = [code](const uint8_t* operands) {
+                auto lambda = code->constants[ReadOperand<uint16_t>(operands)];
+                if (!Is<Code>(lambda)) {
+                    ThrowMalformed();
+                }
+                return As<Code>(lambda);
+            };
+            if (open.insert(code).second) {
+                ForEachInstruction(*code, [&](Opcode opcode, const uint8_t* operands) {
+                    if (opcode == Opcode::kMakeClosure) {
+                        auto* lambda = lambda_at(operands);
+                        if (open.contains(lambda)) {
+                            ThrowMalformed();
+                        }
+                        stack.push_back(lambda);
+                    }
+                });
+                continue;
+            }
+            // Without a frame of its own, the code finds its variables and gives its lambdas
+            // the frames around its closures. Its own frame was checked when it was read.
+            auto outer_depth = [code](size_t depth) -> std::optional<size_t> {
+                if (code->frame_size == 0) {
+                    return depth;
+                }
+                return depth == 0 ? std::nullopt : std::optional(depth - 1);
+            };
+            FrameNeeds own;
+            ForEachInstruction(*code, [&](Opcode opcode, const uint8_t* operands) {
+                if (opcode == Opcode::kLoadLocal || opcode == Opcode::kLoadLocalChecked ||
+                    opcode == Opcode::kStoreLocal) {
+                    if (auto depth = outer_depth(ReadOperand<uint16_t>(operands))) {
+                        Need(&own, *depth, ReadOperand<uint16_t>(operands + 2) + 1);
+                    }
+                }
+                if (opcode == Opcode::kLoadLocalChecked &&
+                    !Is<Symbol>(code->constants[ReadOperand<uint16_t>(operands + 4)])) {
+                    ThrowMalformed();
+                }
+                if (opcode == Opcode::kMakeClosure) {
+                    const auto& lambda_needs = needs.at(lambda_at(operands));
+                    for (size_t depth = 0; depth < lambda_needs.size(); ++depth) {
+                        if (auto outer = outer_depth(depth)) {
+                            Need(&own, *outer, lambda_needs[depth]);
+                        } else if (lambda_needs[depth] > code->frame_size) {
+                            ThrowMalformed();
+                        }
+                    }
+                }
+            });
+            needs.emplace(code, std::move(own));
+            open.erase(code);
+            stack.pop_back();
+        }
+    }
+    for (auto* closure : closures_) {
+        auto* frame = closure->GetEnv();
+        for (auto slots : needs.at(closure->GetCode())) {
+            if (!frame || frame->GetSize() < slots) {
+                ThrowMalformed();
+            }
+            frame = frame->GetParent();
+        }
+    }
+}
+
+uint8_t FaslReader::ReadByte() {
+    if (position_ == bytes_.size()) {
+        ThrowMalformed();
+    }
+    return static_cast<uint8_t>(bytes_[position_++]);
+}
+
+uint64_t FaslReader::ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        auto byte = ReadByte();
+        value |= uint64_t{byte & 0x7fu} << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+    ThrowMalformed();
+}
+
+uint32_t FaslReader::ReadVarint32() {
+    auto value = ReadVarint();
+    if (value > UINT32_MAX) {
+        ThrowMalformed();
+    }
+    return static_cast<uint32_t>(value);
+}
+
+uint64_t FaslReader::ReadFixed64() {
+    auto bytes = ReadBytes(8);
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= uint64_t{static_cast<uint8_t>(bytes[i])} << (i * 8);
+    }
+    return value;
+}
+
+std::string_view FaslReader::ReadBytes(size_t size) {
+    if (size > bytes_.size() - position_) {
+        ThrowMalformed();
+    }
+    auto bytes = bytes_.substr(position_, size);
+    position_ += size;
+    return bytes;
+}
+
+size_t FaslReader::ReadCount(size_t min_size) {
+    auto count = ReadVarint();
+    if (count > (bytes_.size() - position_) / min_size) {
+        ThrowMalformed();
+    }
+    return count;
+}
+
+FileContents::FileContents(const std::string& path) {
+#if SCHEME_MMAP
+    if (int file = open(path.c_str(), O_RDONLY); file != -1) {
+        struct stat status;
+        if (fstat(file, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+            size_ = status.st_size;
+            auto* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const char*>(data);
+                mapped_ = true;
+            }
+        }
+        close(file);
+        if (mapped_) {
+            return;
+        }
+    }
+#endif
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw RuntimeError("cannot open " + path);
+    }
+    buffer_.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+FileContents::~FileContents() {
+#if SCHEME_MMAP
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
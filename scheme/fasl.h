@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "object.h"
+
+// Fasl, for "fast load": a binary form of data, read back without tokenizing or parsing text.
+//
+// A fasl holds a sequence of data. Its symbols are written once, in a table ahead of the data,
+// and referred to by index. Integers are varints, flonums their bits. An object reachable more
+// than once from a datum is written once and referred to after that, so shared structure and
+// cycles survive. Sharing is within a datum, so the data of a fasl read one at a time can be
+// collected one at a time.
+//
+// Procedures, continuations and hash tables have no fasl form. They do in an image, the kind of
+// fasl Scheme::SaveImage writes, which holds hash tables and compiled procedures: their code and
+// the frames they close over. Builtins are written by name there and read as the builtin of that
+// name. Bytecode is checked as it is read, against the constants, frames and stack it will run
+// with, so that a corrupt image is refused like any malformed fasl.
+
+class Code;
+class CompiledClosure;
+class Globals;
+
+enum class FaslKind {
+    kData,
+    kImage
+};
+
+// Whether bytes start like a fasl of data.
+bool IsFasl(std::string_view bytes);
+bool IsImage(std::string_view bytes);
+
+class FaslWriter {
+public:
+    explicit FaslWriter(FaslKind kind = FaslKind::kData) : kind_(kind) {
+    }
+
+    // Throws RuntimeError if the datum holds an object that has no fasl form. Nothing of it is
+    // written then.
+    void Add(Value datum);
+
+    // The fasl of the data added so far.
+    std::string Finish() const;
+
+private:
+    void Write(Value datum, const std::unordered_map<Object*, bool>& shared);
+    void WriteCode(const Code& code);
+    void WriteVarint(uint64_t value);
+    void WriteFixed64(uint64_t value);
+    void WriteBytes(std::string_view bytes);
+    uint64_t GetSymbolIndex(Symbol* symbol);
+
+    FaslKind kind_;
+    std::unordered_map<Symbol*, uint32_t> symbol_indices_;
+    std::vector<Symbol*> symbols_;
+    std::string data_;
+    size_t count_ = 0;
+};
+
+// Reads the data of a fasl in order. Throws SyntaxError on bytes that are not a well-formed
+// fasl.
+class FaslReader {
+public:
+    // The bytes must outlive the reader.
+    explicit FaslReader(std::string_view bytes);
+    // Reads an image, taking its builtins from globals.
+    FaslReader(std::string_view bytes, const Globals* builtins);
+
+    bool IsEnd() const;
+
+    Value Next();
+
+private:
+    void ReadHeader();
+    Code* ReadCode();
+    // Checks what the codes of the datum need of the data they refer to, once it is whole: the
+    // code of their lambdas and the frames their closures find variables in.
+    void CheckCodes();
+    uint8_t ReadByte();
+    uint64_t ReadVarint();
+    uint32_t ReadVarint32();
+    uint64_t ReadFixed64();
+    std::string_view ReadBytes(size_t size);
+    // A count of things taking at least min_size bytes each, checked against the bytes left.
+    size_t ReadCount(size_t min_size = 1);
+
+    std::string_view bytes_;
+    // Only for an image.
+    const Globals* builtins_ = nullptr;
+    size_t position_ = 0;
+    std::vector<Symbol*> symbols_;
+    size_t remaining_ = 0;
+    // The objects written once and referred to again, of the datum being read.
+    std::vector<Value> labels_;
+    // The codes and closures of the datum being read.
+    std::vector<Code*> codes_;
+    std::vector<CompiledClosure*> closures_;
+};
+
+// The contents of a file, mapped into memory where the system can, read otherwise.
+class FileContents {
+public:
+    // Throws RuntimeError if the file can't be read.
+    explicit FileContents(const std::string& path);
+    FileContents(const FileContents&) = delete;
+    FileContents& operator=(const FileContents&) = delete;
+    ~FileContents();
+
+    std::string_view GetView() const {
+        return {data_, size_};
+    }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string buffer_;
+};
@@ -0,0 +1,99 @@
+#include "hash-table.h"
+#include <utility>
+#include "equality.h"
+#include "heap.h"
+
+HashTable::HashTable(Equivalence equivalence) : Object(kType), equivalence_(equivalence) {
+}
+
+Value HashTable::Find(Value key) const {
+    if (count_ == 0) {
+        return Value::Unbound();
+    }
+    const auto& entry = entries_[Probe(key, Hash(key))];
+    return entry.key.IsUnbound() ? Value::Unbound() : entry.value;
+}
+
+void HashTable::Set(Value key, Value value) {
+    // Keeps the load factor at most 3/4, which also guarantees an empty slot to end probes.
+    if ((count_ + 1) * 4 > entries_.size() * 3) {
+        Grow();
+    }
+    auto hash = Hash(key);
+    auto& entry = entries_[Probe(key, hash)];
+    if (entry.key.IsUnbound()) {
+        entry = {key, value, hash};
+        ++count_;
+    } else {
+        entry.value = value;
+    }
+}
+
+bool HashTable::Remove(Value key) {
+    if (count_ == 0) {
+        return false;
+    }
+    auto mask = entries_.size() - 1;
+    auto hole = Probe(key, Hash(key));
+    if (entries_[hole].key.IsUnbound()) {
+        return false;
+    }
+    // Moves back every later entry of the run whose probe sequence passes through the hole.
+    for (auto i = (hole + 1) & mask; !entries_[i].key.IsUnbound(); i = (i + 1) & mask) {
+        auto home = entries_[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            entries_[hole] = entries_[i];
+            hole = i;
+        }
+    }
+    entries_[hole] = Entry{};
+    --count_;
+    return true;
+}
+
+void HashTable::Trace(Heap& heap) const {
+    ForEach([&heap](Value key, Value value) {
+        heap.Mark(key);
+        heap.Mark(value);
+    });
+}
+
+uint64_t HashTable::Hash(Value key) const {
+    if (equivalence_ == Equivalence::kEq) {
+        return HashEq(key);
+    }
+    return equivalence_ == Equivalence::kEqv ? HashEqv(key) : HashEqual(key);
+}
+
+bool HashTable::AreSame(Value a, Value b) const {
+    if (equivalence_ == Equivalence::kEq) {
+        return a == b;
+    }
+    return equivalence_ == Equivalence::kEqv ? AreEqv(a, b) : AreEqual(a, b);
+}
+
+size_t HashTable::Probe(Value key, uint64_t hash) const {
+    auto mask = entries_.size() - 1;
+    for (auto i = hash & mask;; i = (i + 1) & mask) {
+        const auto& entry = entries_[i];
+        if (entry.key.IsUnbound() || (entry.hash == hash && AreSame(entry.key, key))) {
+            return i;
+        }
+    }
+}
+
+void HashTable::Grow() {
+    auto old = std::exchange(entries_, std::vector<Entry>(
+                                           entries_.empty() ? kMinCapacity : entries_.size() * 2));
+    auto mask = entries_.size() - 1;
+    for (const auto& entry : old) {
+        if (entry.key.IsUnbound()) {
+            continue;
+        }
+        auto i = entry.hash & mask;
+        while (!entries_[i].key.IsUnbound()) {
+            i = (i + 1) & mask;
+        }
+        entries_[i] = entry;
+    }
+}
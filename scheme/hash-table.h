@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "object.h"
+
+// A mutable map from values to values under eq?, eqv? or equal?.
+//
+// Open addressing with linear probing over a power-of-two array of slots, each caching the
+// hash of its key, so probes compare keys only on a full hash match. The table doubles before
+// it gets three quarters full, and deletion shifts the following entries back instead of
+// leaving tombstones, so probe sequences stay as short as insertion made them.
+class HashTable : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kHashTable;
+
+    enum class Equivalence { kEq, kEqv, kEqual };
+
+    explicit HashTable(Equivalence equivalence);
+
+    Equivalence GetEquivalence() const {
+        return equivalence_;
+    }
+
+    size_t GetCount() const {
+        return count_;
+    }
+
+    // The value stored under key, or Value::Unbound() if there is none.
+    Value Find(Value key) const;
+    void Set(Value key, Value value);
+    // Whether there was an entry to remove.
+    bool Remove(Value key);
+
+    // Calls f(key, value) for every entry, in no particular order. f must not modify the table.
+    template <class F>
+    void ForEach(F&& f) const {
+        for (const auto& entry : entries_) {
+            if (!entry.key.IsUnbound()) {
+                f(entry.key, entry.value);
+            }
+        }
+    }
+
+    void Trace(Heap& heap) const override;
+
+private:
+    struct Entry {
+        Value key = Value::Unbound();
+        Value value;
+        uint64_t hash = 0;
+    };
+
+    static constexpr size_t kMinCapacity = 8;
+
+    uint64_t Hash(Value key) const;
+    bool AreSame(Value a, Value b) const;
+    // The slot holding key, or the empty slot ending its probe sequence.
+    size_t Probe(Value key, uint64_t hash) const;
+    void Grow();
+
+    std::vector<Entry> entries_;
+    size_t count_ = 0;
+    Equivalence equivalence_;
+};
@@ -0,0 +1,74 @@
+#include "heap.h"
+
+#include <algorithm>
+
+Heap& Heap::Instance() {
+    thread_local Heap heap;
+    return heap;
+}
+
+void Heap::AddRoot(Object* object) {
+    ++roots_[object];
+}
+
+void Heap::RemoveRoot(Object* object) {
+    if (auto it = roots_.find(object); it != roots_.end() && --it->second == 0) {
+        roots_.erase(it);
+    }
+}
+
+void Heap::AddRootSet(const RootSet* roots) {
+    root_sets_.push_back(roots);
+}
+
+void Heap::RemoveRootSet(const RootSet* roots) {
+    std::erase(root_sets_, roots);
+}
+
+void Heap::Mark(Value value) {
+    if (!value.IsObject()) {
+        return;
+    }
+    auto* object = value.GetObject();
+    if (object->marked_) {
+        return;
+    }
+    object->marked_ = true;
+    gray_.push_back(object);
+}
+
+void Heap::Collect() {
+    peak_object_count_ = std::max(peak_object_count_, allocator_.GetObjectCount());
+    for (const auto& [root, count] : roots_) {
+        Mark(root);
+    }
+    for (const auto* roots : root_sets_) {
+        roots->Trace(*this);
+    }
+    // Marking uses an explicit worklist, so long lists don't recurse on the native stack.
+    while (!gray_.empty()) {
+        auto* object = gray_.back();
+        gray_.pop_back();
+        object->Trace(*this);
+    }
+
+    allocator_.Sweep();
+
+    collection_threshold_ = std::max(kMinCollectionThreshold, 2 * allocator_.GetObjectCount());
+}
+
+void Heap::RequestCollection() {
+    collection_threshold_ = 0;
+}
+
+size_t Heap::GetObjectCount() const {
+    return allocator_.GetObjectCount();
+}
+
+size_t Heap::GetPeakObjectCount() const {
+    return std::max(peak_object_count_, allocator_.GetObjectCount());
+}
+
+void Heap::ResetPeakObjectCount() {
+    peak_object_count_ = allocator_.GetObjectCount();
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "allocator.h"
+#include "object.h"
+
+class Heap;
+
+// Values held outside the heap, such as the stacks of the evaluators, which every collection
+// marks along with the roots.
+class RootSet {
+public:
+    virtual void Trace(Heap& heap) const = 0;
+
+protected:
+    ~RootSet() = default;
+};
+
+// Mark-and-sweep collector owning every heap object of the thread.
+//
+// Collection only happens at safe points, where every live value is reachable from the
+// registered roots and root sets: between top-level forms, at every call the evaluators make,
+// and on an explicit CollectGarbage() call. Allocation itself never collects, so native code
+// may hold what it allocates until it makes a call. A collection requested by the program is
+// deferred to the next safe point.
+class Heap {
+public:
+    static Heap& Instance();
+
+    Heap() = default;
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
+
+    template <class T, class... Args>
+    T* Make(Args&&... args) {
+        return MakeSized<T>(sizeof(T), std::forward<Args>(args)...);
+    }
+
+    // Allocates size bytes for an object of type T, which uses the storage past its end.
+    template <class T, class... Args>
+    T* MakeSized(size_t size, Args&&... args) {
+        static_assert(std::is_polymorphic_v<T> && alignof(T) <= ObjectAllocator::kGranularity);
+        assert(size >= sizeof(T));
+        void* memory = allocator_.Allocate(size);
+        T* object;
+        try {
+            object = new (memory) T(std::forward<Args>(args)...);
+        } catch (...) {
+            allocator_.Deallocate(memory, size);
+            throw;
+        }
+        // The allocator treats every slot as an Object.
+        assert(static_cast<Object*>(object) == memory);
+        return object;
+    }
+
+    void AddRoot(Object* object);
+    void RemoveRoot(Object* object);
+
+    void AddRootSet(const RootSet* roots);
+    void RemoveRootSet(const RootSet* roots);
+
+    void Mark(Value value);
+
+    void Collect();
+    void RequestCollection();
+
+    // Whether it was requested or enough objects were allocated since the last cycle.
+    bool IsCollectionDue() const {
+        return allocator_.GetObjectCount() >= collection_threshold_;
+    }
+
+    void CollectAtSafePoint() {
+        if (IsCollectionDue()) {
+            Collect();
+        }
+    }
+
+    size_t GetObjectCount() const;
+
+    // The most objects there were at once since the last reset, which is before a collection
+    // or now: only collections free objects.
+    size_t GetPeakObjectCount() const;
+    void ResetPeakObjectCount();
+
+private:
+    static constexpr size_t kMinCollectionThreshold = 1 << 16;
+
+    ObjectAllocator allocator_;
+    std::unordered_map<Object*, size_t> roots_;
+    std::vector<const RootSet*> root_sets_;
+    std::vector<Object*> gray_;
+    // Zero once a collection is requested, which makes it due at once.
+    size_t collection_threshold_ = kMinCollectionThreshold;
+    size_t peak_object_count_ = 0;
+};
+
+template <class T, class... Args>
+T* Make(Args&&... args) {
+    return Heap::Instance().Make<T>(std::forward<Args>(args)...);
+}
+
+// Roots the object of a value while it is in scope, for a value only native code holds across
+// a call.
+class ScopedRoot {
+public:
+    explicit ScopedRoot(Value value) : object_(value.IsObject() ? value.GetObject() : nullptr) {
+        if (object_) {
+            Heap::Instance().AddRoot(object_);
+        }
+    }
+    ScopedRoot(const ScopedRoot&) = delete;
+    ScopedRoot& operator=(const ScopedRoot&) = delete;
+
+    ~ScopedRoot() {
+        if (object_) {
+            Heap::Instance().RemoveRoot(object_);
+        }
+    }
+
+private:
+    Object* object_;
+};
@@ -0,0 +1,444 @@
+#include "number.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "error.h"
+#include "heap.h"
+
+Bignum::Bignum(bool negative, std::span<const uint32_t> magnitude)
+    : Object(kType), size_(magnitude.size()), negative_(negative) {
+    std::ranges::copy(magnitude, reinterpret_cast<uint32_t*>(this + 1));
+}
+
+Bignum* Bignum::Create(bool negative, std::span<const uint32_t> magnitude) {
+    return Heap::Instance().MakeSized<Bignum>(sizeof(Bignum) + magnitude.size() * sizeof(uint32_t),
+                                              negative, magnitude);
+}
+
+namespace {
+using Magnitude = std::vector<uint32_t>;
+
+constexpr uint64_t kLimbBase = uint64_t{1} << 32;
+
+// Sign and magnitude of any integer, for the slow paths.
+struct Integer {
+    bool negative;
+    Magnitude magnitude;
+};
+
+Integer ToInteger(Value value) {
+    if (value.IsFixnum()) {
+        auto fixnum = value.GetFixnum();
+        // Fixnums are 63-bit, so negating one can't overflow.
+        auto absolute = static_cast<uint64_t>(fixnum < 0 ? -fixnum : fixnum);
+        Magnitude magnitude;
+        if (absolute != 0) {
+            magnitude.push_back(static_cast<uint32_t>(absolute));
+            if (absolute >> 32) {
+                magnitude.push_back(static_cast<uint32_t>(absolute >> 32));
+            }
+        }
+        return {fixnum < 0, std::move(magnitude)};
+    }
+    auto* bignum = As<Bignum>(value);
+    auto magnitude = bignum->GetMagnitude();
+    return {bignum->IsNegative(), Magnitude(magnitude.begin(), magnitude.end())};
+}
+
+Value FromInteger(bool negative, Magnitude magnitude) {
+    while (!magnitude.empty() && magnitude.back() == 0) {
+        magnitude.pop_back();
+    }
+    if (magnitude.size() <= 2) {
+        uint64_t absolute = 0;
+        for (size_t i = magnitude.size(); i-- > 0;) {
+            absolute = (absolute << 32) | magnitude[i];
+        }
+        if (absolute <= static_cast<uint64_t>(kMaxFixnum)) {
+            auto fixnum = static_cast<int64_t>(absolute);
+            return Value::Fixnum(negative ? -fixnum : fixnum);
+        }
+        if (negative && absolute == static_cast<uint64_t>(kMaxFixnum) + 1) {
+            return Value::Fixnum(kMinFixnum);
+        }
+    }
+    return Bignum::Create(negative, magnitude);
+}
+
+int CompareMagnitudes(const Magnitude& a, const Magnitude& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+Magnitude AddMagnitudes(const Magnitude& a, const Magnitude& b) {
+    const auto& longer = a.size() >= b.size() ? a : b;
+    const auto& shorter = a.size() >= b.size() ? b : a;
+    Magnitude result(longer.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < longer.size(); ++i) {
+        carry += longer[i];
+        if (i < shorter.size()) {
+            carry += shorter[i];
+        }
+        result[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    result.back() = static_cast<uint32_t>(carry);
+    return result;
+}
+
+// a - b, where a >= b.
+Magnitude SubtractMagnitudes(const Magnitude& a, const Magnitude& b) {
+    Magnitude result(a.size());
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        int64_t difference = int64_t{a[i]} - borrow - (i < b.size() ? int64_t{b[i]} : 0);
+        borrow = difference < 0;
+        result[i] = static_cast<uint32_t>(difference + (borrow ? kLimbBase : 0));
+    }
+    return result;
+}
+
+Magnitude MultiplyMagnitudes(const Magnitude& a, const Magnitude& b) {
+    Magnitude result(a.size() + b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            carry += uint64_t{a[i]} * b[j] + result[i + j];
+            result[i + j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        result[i + b.size()] = static_cast<uint32_t>(carry);
+    }
+    return result;
+}
+
+// Divides a in place by a single limb, returning the remainder.
+uint32_t DivideMagnitude(Magnitude* a, uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (size_t i = a->size(); i-- > 0;) {
+        auto current = (remainder << 32) | (*a)[i];
+        (*a)[i] = static_cast<uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    return static_cast<uint32_t>(remainder);
+}
+
+// Quotient of a by b, where b has no leading zero limbs (Knuth's algorithm D).
+Magnitude DivideMagnitudes(const Magnitude& a, const Magnitude& b) {
+    if (CompareMagnitudes(a, b) < 0) {
+        return {};
+    }
+    if (b.size() == 1) {
+        auto quotient = a;
+        DivideMagnitude(&quotient, b[0]);
+        return quotient;
+    }
+
+    // Normalizes so that the top bit of the divisor is set, which keeps each estimated
+    // quotient limb at most 2 too large.
+    auto m = a.size();
+    auto n = b.size();
+    auto shift = std::countl_zero(b.back());
+    auto shifted = [shift](uint32_t high, uint32_t low) {
+        return shift == 0 ? high
+                          : static_cast<uint32_t>((high << shift) | (low >> (32 - shift)));
+    };
+    Magnitude v(n);
+    for (size_t i = n - 1; i > 0; --i) {
+        v[i] = shifted(b[i], b[i - 1]);
+    }
+    v[0] = b[0] << shift;
+    Magnitude u(m + 1);
+    u[m] = shifted(0, a[m - 1]);
+    for (size_t i = m - 1; i > 0; --i) {
+        u[i] = shifted(a[i], a[i - 1]);
+    }
+    u[0] = a[0] << shift;
+
+    Magnitude quotient(m - n + 1);
+    for (size_t j = m - n + 1; j-- > 0;) {
+        auto numerator = (uint64_t{u[j + n]} << 32) | u[j + n - 1];
+        auto estimate = numerator / v[n - 1];
+        auto remainder = numerator % v[n - 1];
+        while (estimate >= kLimbBase ||
+               estimate * v[n - 2] > ((remainder << 32) | u[j + n - 2])) {
+            --estimate;
+            remainder += v[n - 1];
+            if (remainder >= kLimbBase) {
+                break;
+            }
+        }
+
+        // Subtracts estimate * v from the current window of u.
+        int64_t borrow = 0;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            auto product = estimate * v[i] + carry;
+            carry = product >> 32;
+            auto difference = int64_t{u[i + j]} - borrow - static_cast<uint32_t>(product);
+            borrow = difference < 0;
+            u[i + j] = static_cast<uint32_t>(difference + (borrow ? kLimbBase : 0));
+        }
+        auto top = int64_t{u[j + n]} - borrow - static_cast<int64_t>(carry);
+        u[j + n] = static_cast<uint32_t>(top);
+
+        // The estimate was one too large: adds v back.
+        if (top < 0) {
+            --estimate;
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += uint64_t{u[i + j]} + v[i];
+                u[i + j] = static_cast<uint32_t>(sum);
+                sum >>= 32;
+            }
+            u[j + n] += static_cast<uint32_t>(sum);
+        }
+        quotient[j] = static_cast<uint32_t>(estimate);
+    }
+    return quotient;
+}
+
+Value AddIntegers(Integer a, Integer b) {
+    if (a.negative == b.negative) {
+        return FromInteger(a.negative, AddMagnitudes(a.magnitude, b.magnitude));
+    }
+    if (CompareMagnitudes(a.magnitude, b.magnitude) >= 0) {
+        return FromInteger(a.negative, SubtractMagnitudes(a.magnitude, b.magnitude));
+    }
+    return FromInteger(b.negative, SubtractMagnitudes(b.magnitude, a.magnitude));
+}
+}  // namespace
+
+bool IsNumeric(Value value) {
+    return value.IsFixnum() || Is<Bignum>(value) || Is<Flonum>(value);
+}
+
+Value MakeInteger(int64_t value) {
+    if (FitsFixnum(value)) {
+        return Value::Fixnum(value);
+    }
+    auto absolute = value < 0 ? -static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    return FromInteger(value < 0,
+                       {static_cast<uint32_t>(absolute), static_cast<uint32_t>(absolute >> 32)});
+}
+
+Value MakeFlonum(double value) {
+    return Make<Flonum>(value);
+}
+
+Value ParseInteger(std::string_view text) {
+    auto negative = text.starts_with('-');
+    if (negative || text.starts_with('+')) {
+        text.remove_prefix(1);
+    }
+    // Nine decimal digits at a time, most significant first, so the first chunk takes what is
+    // left over.
+    constexpr size_t kChunkDigits = 9;
+    Magnitude magnitude;
+    auto size = text.size() % kChunkDigits == 0 ? kChunkDigits : text.size() % kChunkDigits;
+    for (size_t start = 0; start < text.size(); start += size, size = kChunkDigits) {
+        uint32_t chunk = 0;
+        std::from_chars(text.data() + start, text.data() + start + size, chunk);
+        uint64_t scale = 1;
+        for (size_t i = 0; i < size; ++i) {
+            scale *= 10;
+        }
+        uint64_t carry = chunk;
+        for (auto& limb : magnitude) {
+            carry += uint64_t{limb} * scale;
+            limb = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            magnitude.push_back(static_cast<uint32_t>(carry));
+        }
+    }
+    return FromInteger(negative, std::move(magnitude));
+}
+
+bool ToInt64(Value value, int64_t* result) {
+    if (value.IsFixnum()) {
+        *result = value.GetFixnum();
+        return true;
+    }
+    if (!Is<Bignum>(value) || As<Bignum>(value)->GetMagnitude().size() > 2) {
+        return false;
+    }
+    auto* bignum = As<Bignum>(value);
+    auto magnitude = bignum->GetMagnitude();
+    uint64_t absolute = magnitude[0] | (magnitude.size() > 1 ? uint64_t{magnitude[1]} << 32 : 0);
+    if (bignum->IsNegative()) {
+        if (absolute > uint64_t{1} << 63) {
+            return false;
+        }
+        *result = static_cast<int64_t>(0 - absolute);
+    } else {
+        if (absolute > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+            return false;
+        }
+        *result = static_cast<int64_t>(absolute);
+    }
+    return true;
+}
+
+double ToDouble(Value value) {
+    if (value.IsFixnum()) {
+        return static_cast<double>(value.GetFixnum());
+    }
+    if (Is<Flonum>(value)) {
+        return As<Flonum>(value)->GetValue();
+    }
+    auto* bignum = As<Bignum>(value);
+    double result = 0;
+    auto magnitude = bignum->GetMagnitude();
+    for (size_t i = magnitude.size(); i-- > 0;) {
+        result = result * static_cast<double>(kLimbBase) + magnitude[i];
+    }
+    return bignum->IsNegative() ? -result : result;
+}
+
+Value AddNumbers(Value a, Value b) {
+    int64_t result;
+    if (a.IsFixnum() && b.IsFixnum() && AddFixnums(a.GetFixnum(), b.GetFixnum(), &result)) {
+        return Value::Fixnum(result);
+    }
+    if (Is<Flonum>(a) || Is<Flonum>(b)) {
+        return MakeFlonum(ToDouble(a) + ToDouble(b));
+    }
+    return AddIntegers(ToInteger(a), ToInteger(b));
+}
+
+Value SubtractNumbers(Value a, Value b) {
+    int64_t result;
+    if (a.IsFixnum() && b.IsFixnum() && SubtractFixnums(a.GetFixnum(), b.GetFixnum(), &result)) {
+        return Value::Fixnum(result);
+    }
+    if (Is<Flonum>(a) || Is<Flonum>(b)) {
+        return MakeFlonum(ToDouble(a) - ToDouble(b));
+    }
+    auto negated = ToInteger(b);
+    negated.negative = !negated.negative;
+    return AddIntegers(ToInteger(a), std::move(negated));
+}
+
+Value MultiplyNumbers(Value a, Value b) {
+    int64_t result;
+    if (a.IsFixnum() && b.IsFixnum() && MultiplyFixnums(a.GetFixnum(), b.GetFixnum(), &result)) {
+        return Value::Fixnum(result);
+    }
+    if (Is<Flonum>(a) || Is<Flonum>(b)) {
+        return MakeFlonum(ToDouble(a) * ToDouble(b));
+    }
+    auto lhs = ToInteger(a);
+    auto rhs = ToInteger(b);
+    return FromInteger(lhs.negative != rhs.negative,
+                       MultiplyMagnitudes(lhs.magnitude, rhs.magnitude));
+}
+
+Value DivideNumbers(Value a, Value b) {
+    if (b == Value::Fixnum(0)) {
+        throw RuntimeError("division by zero");
+    }
+    if (a.IsFixnum() && b.IsFixnum()) {
+        // Only kMinFixnum / -1 leaves the fixnum range.
+        return MakeInteger(a.GetFixnum() / b.GetFixnum());
+    }
+    if (Is<Flonum>(a) || Is<Flonum>(b)) {
+        return MakeFlonum(ToDouble(a) / ToDouble(b));
+    }
+    auto lhs = ToInteger(a);
+    auto rhs = ToInteger(b);
+    return FromInteger(lhs.negative != rhs.negative,
+                       DivideMagnitudes(lhs.magnitude, rhs.magnitude));
+}
+
+Value NegateNumber(Value value) {
+    if (Is<Flonum>(value)) {
+        return MakeFlonum(-As<Flonum>(value)->GetValue());
+    }
+    return SubtractNumbers(Value::Fixnum(0), value);
+}
+
+std::partial_ordering CompareNumbers(Value a, Value b) {
+    if (a.IsFixnum() && b.IsFixnum()) {
+        return a.GetFixnum() <=> b.GetFixnum();
+    }
+    if (Is<Flonum>(a) || Is<Flonum>(b)) {
+        return ToDouble(a) <=> ToDouble(b);
+    }
+    auto lhs = ToInteger(a);
+    auto rhs = ToInteger(b);
+    if (lhs.negative != rhs.negative) {
+        return lhs.negative ? std::partial_ordering::less : std::partial_ordering::greater;
+    }
+    auto order = CompareMagnitudes(lhs.magnitude, rhs.magnitude);
+    return lhs.negative ? 0 <=> order : order <=> 0;
+}
+
+std::string FlonumToString(double value) {
+    if (std::isnan(value)) {
+        return "+nan.0";
+    }
+    if (std::isinf(value)) {
+        return value < 0 ? "-inf.0" : "+inf.0";
+    }
+    char buffer[32];
+    auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    std::string result(buffer, end);
+    auto exponent = result.find('e');
+    if (exponent == std::string::npos) {
+        if (result.find('.') == std::string::npos) {
+            result += ".0";
+        }
+        return result;
+    }
+    // The exponent is written as 1e21 and 1e-7 rather than with the plus sign and the leading
+    // zeros of C, 1e+21 and 1e-07.
+    auto digits = exponent + 1;
+    if (result[digits] == '+') {
+        result.erase(digits, 1);
+    } else if (result[digits] == '-') {
+        ++digits;
+    }
+    auto zeros = std::min(result.find_first_not_of('0', digits), result.size() - 1) - digits;
+    result.erase(digits, zeros);
+    return result;
+}
+
+std::string NumberToString(Value value) {
+    if (value.IsFixnum()) {
+        return std::to_string(value.GetFixnum());
+    }
+    if (Is<Flonum>(value)) {
+        return FlonumToString(As<Flonum>(value)->GetValue());
+    }
+    auto integer = ToInteger(value);
+    // Nine decimal digits at a time, least significant first.
+    std::vector<uint32_t> chunks;
+    while (!integer.magnitude.empty()) {
+        chunks.push_back(DivideMagnitude(&integer.magnitude, 1'000'000'000));
+        while (!integer.magnitude.empty() && integer.magnitude.back() == 0) {
+            integer.magnitude.pop_back();
+        }
+    }
+    std::string result = integer.negative ? "-" : "";
+    result += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        auto digits = std::to_string(chunks[i]);
+        result.append(9 - digits.size(), '0');
+        result += digits;
+    }
+    return result;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include "object.h"
+
+// Integers are exact: fixnums while they fit in 63 bits and bignums past that. Arithmetic
+// promotes to a bignum only when a result overflows and demotes back once it fits again, so
+// each integer has exactly one representation. Flonums are inexact, and any arithmetic
+// involving one gives a flonum.
+
+inline constexpr int64_t kMinFixnum = -(int64_t{1} << 62);
+inline constexpr int64_t kMaxFixnum = (int64_t{1} << 62) - 1;
+
+constexpr bool FitsFixnum(int64_t value) {
+    return value >= kMinFixnum && value <= kMaxFixnum;
+}
+
+// Overflow-checked fixnum arithmetic: stores the result and returns true when it is a fixnum.
+// Sums and differences of fixnums always fit in 64 bits, so only the range is checked.
+inline bool AddFixnums(int64_t a, int64_t b, int64_t* result) {
+    *result = a + b;
+    return FitsFixnum(*result);
+}
+
+inline bool SubtractFixnums(int64_t a, int64_t b, int64_t* result) {
+    *result = a - b;
+    return FitsFixnum(*result);
+}
+
+inline bool MultiplyFixnums(int64_t a, int64_t b, int64_t* result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_mul_overflow(a, b, result) && FitsFixnum(*result);
+#else
+    // Conservative: a product of exactly kMinFixnum takes the slow path.
+    if (b != 0 && (a < 0 ? -a : a) > kMaxFixnum / (b < 0 ? -b : b)) {
+        return false;
+    }
+    *result = a * b;
+    return true;
+#endif
+}
+
+// An integer out of the fixnum range: sign and magnitude, stored as 32-bit limbs right after
+// the object, least significant first.
+class Bignum : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kBignum;
+
+    // The magnitude has no leading zero limbs and is too large for a fixnum.
+    static Bignum* Create(bool negative, std::span<const uint32_t> magnitude);
+
+    bool IsNegative() const {
+        return negative_;
+    }
+
+    std::span<const uint32_t> GetMagnitude() const {
+        return {reinterpret_cast<const uint32_t*>(this + 1), size_};
+    }
+
+private:
+    friend class Heap;
+
+    Bignum(bool negative, std::span<const uint32_t> magnitude);
+
+    uint32_t size_;
+    bool negative_;
+};
+
+// An inexact number, a double.
+class Flonum : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kFlonum;
+
+    double GetValue() const {
+        return value_;
+    }
+
+private:
+    friend class Heap;
+
+    explicit Flonum(double value) : Object(kType), value_(value) {
+    }
+
+    double value_;
+};
+
+bool IsNumeric(Value value);
+
+// A fixnum, or a bignum if value is out of the fixnum range.
+Value MakeInteger(int64_t value);
+
+Value MakeFlonum(double value);
+
+// The integer written in decimal digits, after an optional sign, of any length.
+Value ParseInteger(std::string_view text);
+
+// Whether value is an integer that fits in 64 bits, which is then stored in result.
+bool ToInt64(Value value, int64_t* result);
+
+// The nearest double to a number.
+double ToDouble(Value value);
+
+// Arithmetic on numbers, which the caller has checked with IsNumeric.
+Value AddNumbers(Value a, Value b);
+Value SubtractNumbers(Value a, Value b);
+Value MultiplyNumbers(Value a, Value b);
+// Truncates towards zero when both are integers. Throws RuntimeError when b is an exact zero.
+Value DivideNumbers(Value a, Value b);
+Value NegateNumber(Value value);
+
+// Unordered when either is NaN.
+std::partial_ordering CompareNumbers(Value a, Value b);
+
+std::string NumberToString(Value value);
+// The shortest digits that read back as the same double, with a point or an exponent, as in
+// 0.5 and 1e21; the values that have no digits are +inf.0, -inf.0 and +nan.0.
+std::string FlonumToString(double value);
@@ -1,46 +1,101 @@
 #include "object.h"
-#include <memory>
+#include "error.h"
+#include "heap.h"
 
-Number::Number(int value) : value_(value) {
-}
+#include <unordered_map>
 
-int Number::GetValue() const {
-    return value_;
+Symbol::Symbol(std::string_view name, uint32_t id) : Object(kType), name_(name), id_(id) {
 }
 
-Boolean::Boolean(bool value) : value_(value) {
-}
+namespace {
+struct SymbolTable {
+    // Keys view the names owned by the symbols, which never die: each one is a heap root.
+    std::unordered_map<std::string_view, Symbol*> by_name;
+    std::vector<Symbol*> by_id;
+};
 
-bool Boolean::GetValue() const {
-    return value_;
+SymbolTable& GetSymbolTable() {
+    thread_local SymbolTable table;
+    return table;
 }
+}  // namespace
 
-Symbol::Symbol(const std::string& name) : name_(name) {
+Symbol* Symbol::Intern(std::string_view name) {
+    auto& table = GetSymbolTable();
+    if (auto it = table.by_name.find(name); it != table.by_name.end()) {
+        return it->second;
+    }
+    auto& heap = Heap::Instance();
+    auto* symbol = heap.Make<Symbol>(name, static_cast<uint32_t>(table.by_id.size()));
+    heap.AddRoot(symbol);
+    table.by_name.emplace(symbol->GetName(), symbol);
+    table.by_id.push_back(symbol);
+    return symbol;
 }
 
-Symbol::Symbol(std::string&& name) : name_(std::move(name)) {
+Symbol* Symbol::FromId(uint32_t id) {
+    return GetSymbolTable().by_id[id];
 }
 
 const std::string& Symbol::GetName() const {
     return name_;
 }
 
-Cell::Cell(std::shared_ptr<Object> first, std::shared_ptr<Object> second)
-    : first_(first), second_(second) {
+uint32_t Symbol::GetId() const {
+    return id_;
+}
+
+Cell::Cell(Value first, Value second) : Object(kType), first_(first), second_(second) {
 }
 
-std::shared_ptr<Object> Cell::GetFirst() const {
+Value Cell::GetFirst() const {
     return first_;
 }
 
-std::shared_ptr<Object> Cell::GetSecond() const {
+Value Cell::GetSecond() const {
     return second_;
 }
 
-void Cell::SetFirst(std::shared_ptr<Object> value) {
+void Cell::SetFirst(Value value) {
     first_ = value;
 }
 
-void Cell::SetSecond(std::shared_ptr<Object> value) {
+void Cell::SetSecond(Value value) {
     second_ = value;
 }
+
+void Cell::Trace(Heap& heap) const {
+    heap.Mark(first_);
+    heap.Mark(second_);
+}
+
+std::vector<Value> CellToVector(Value list, bool proper) {
+    if (list.IsNil()) {
+        return {};
+    }
+    if (!Is<Cell>(list)) {
+        if (proper) {
+            throw SyntaxError("Expected proper list");
+        }
+        return {list};
+    }
+    auto cell = As<Cell>(list);
+    std::vector<Value> result;
+    while (cell) {
+        result.push_back(cell->GetFirst());
+        auto second = cell->GetSecond();
+        if (second.IsNil()) {
+            break;
+        }
+        if (Is<Cell>(second)) {
+            cell = As<Cell>(second);
+        } else {
+            if (proper) {
+                throw SyntaxError("Expected proper list");
+            }
+            result.push_back(second);
+            break;
+        }
+    }
+    return result;
+}
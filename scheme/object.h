@@ -1,82 +1,227 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
-class Scope;
+class Heap;
+class Object;
 
-class Object : public std::enable_shared_from_this<Object> {
+// Machine word holding either an immediate or a pointer to a heap object.
+//   ...0000  heap object pointer (all zero bits is the empty list)
+//   .......1  fixnum, the value is stored in the upper 63 bits
+//   ....b010  boolean, b is the value
+//   .....100  marker of an unbound variable slot, never seen by programs
+class Value {
 public:
-    virtual ~Object() = default;
-};
+    constexpr Value() = default;
 
-class Number : public Object {
-private:
-    int value_;
+    constexpr Value(std::nullptr_t) {
+    }
 
-public:
-    Number(int value);
+    Value(Object* object) : bits_(reinterpret_cast<uintptr_t>(object)) {
+    }
 
-    int GetValue() const;
-};
+    static constexpr Value Fixnum(int64_t value) {
+        return Value((static_cast<uintptr_t>(value) << 1) | kFixnumTag);
+    }
+
+    static constexpr Value Boolean(bool value) {
+        return Value((static_cast<uintptr_t>(value) << kTagBits) | kBooleanTag);
+    }
+
+    static constexpr Value Unbound() {
+        return Value(kUnboundTag);
+    }
+
+    constexpr bool IsNil() const {
+        return bits_ == 0;
+    }
+
+    constexpr bool IsFixnum() const {
+        return (bits_ & kFixnumTag) != 0;
+    }
+
+    constexpr bool IsBoolean() const {
+        return (bits_ & kTagMask) == kBooleanTag;
+    }
+
+    constexpr bool IsUnbound() const {
+        return bits_ == kUnboundTag;
+    }
+
+    constexpr bool IsObject() const {
+        return (bits_ & kTagMask) == kObjectTag && bits_ != 0;
+    }
+
+    constexpr int64_t GetFixnum() const {
+        return static_cast<int64_t>(bits_) >> 1;
+    }
+
+    constexpr bool GetBoolean() const {
+        return (bits_ >> kTagBits) != 0;
+    }
+
+    // The word itself, for hashing by identity.
+    constexpr uintptr_t GetBits() const {
+        return bits_;
+    }
+
+    Object* GetObject() const {
+        return reinterpret_cast<Object*>(bits_);
+    }
+
+    constexpr explicit operator bool() const {
+        return !IsNil();
+    }
+
+    constexpr bool operator==(const Value&) const = default;
 
-class Boolean : public Object {
 private:
-    int value_;
+    static constexpr uintptr_t kTagBits = 3;
+    static constexpr uintptr_t kTagMask = (1 << kTagBits) - 1;
+    static constexpr uintptr_t kObjectTag = 0b000;
+    static constexpr uintptr_t kFixnumTag = 0b001;
+    static constexpr uintptr_t kBooleanTag = 0b010;
+    static constexpr uintptr_t kUnboundTag = 0b100;
+
+    constexpr explicit Value(uintptr_t bits) : bits_(bits) {
+    }
+
+    uintptr_t bits_ = 0;
+};
 
+enum class ObjectType : uint8_t {
+    kSymbol,
+    kCell,
+    kFunction,
+    kClosure,
+    kFrame,
+    kGlobals,
+    kCode,
+    kCompiledClosure,
+    kContinuation,
+    kContinuationFrame,
+    kBignum,
+    kFlonum,
+    kVector,
+    kS64Vector,
+    kF64Vector,
+    kHashTable,
+    kString
+};
+
+class Object {
 public:
-    Boolean(bool value);
+    explicit Object(ObjectType type) : type_(type) {
+    }
+
+    virtual ~Object() = default;
+
+    ObjectType GetType() const {
+        return type_;
+    }
+
+    // Marks every value this object refers to.
+    virtual void Trace(Heap&) const {
+    }
+
+private:
+    friend class Heap;
+    friend class ObjectAllocator;
 
-    bool GetValue() const;
+    ObjectType type_;
+    bool marked_ = false;
 };
 
+// Symbols are interned: equal names always give the same object, so symbols compare by
+// pointer and are keyed by their small dense id.
 class Symbol : public Object {
 private:
+    friend class Heap;
+
     std::string name_;
+    uint32_t id_;
+
+    Symbol(std::string_view name, uint32_t id);
 
 public:
-    Symbol(const std::string& name);
-    Symbol(std::string&& name);
+    static constexpr ObjectType kType = ObjectType::kSymbol;
+
+    static Symbol* Intern(std::string_view name);
+    // The symbol with the given id, which must have been interned.
+    static Symbol* FromId(uint32_t id);
 
     const std::string& GetName() const;
+    uint32_t GetId() const;
 };
 
 class Cell : public Object {
 private:
-    std::shared_ptr<Object> first_;
-    std::shared_ptr<Object> second_;
+    Value first_;
+    Value second_;
 
 public:
-    Cell(std::shared_ptr<Object> first, std::shared_ptr<Object> second);
+    static constexpr ObjectType kType = ObjectType::kCell;
+
+    Cell(Value first, Value second);
+
+    Value GetFirst() const;
+    Value GetSecond() const;
 
-    std::shared_ptr<Object> GetFirst() const;
-    std::shared_ptr<Object> GetSecond() const;
+    void SetFirst(Value value);
+    void SetSecond(Value value);
 
-    void SetFirst(std::shared_ptr<Object> value);
-    void SetSecond(std::shared_ptr<Object> value);
+    void Trace(Heap& heap) const override;
 };
 
 class Function : public Object {
 public:
-    virtual std::shared_ptr<Object> operator()(std::shared_ptr<Object> args,
-                                               std::shared_ptr<Scope> scope) = 0;
+    static constexpr ObjectType kType = ObjectType::kFunction;
+
+    Function() : Object(kType) {
+    }
+
+    virtual Value operator()(std::span<const Value> args) = 0;
+
+protected:
+    // For subclasses that need to be told apart.
+    explicit Function(ObjectType type) : Object(type) {
+    }
 };
 
 template <class T>
-std::shared_ptr<T> As(const std::shared_ptr<Object>& obj) {
-    auto result = std::dynamic_pointer_cast<T>(obj);
-    if (!result) {
-        throw std::runtime_error("As: downcasting to wrong type");
+bool Is(Value value) {
+    return value.IsObject() && value.GetObject()->GetType() == T::kType;
+}
+
+// Closures and continuations are functions too.
+template <>
+inline bool Is<Function>(Value value) {
+    if (!value.IsObject()) {
+        return false;
     }
-    return result;
+    auto type = value.GetObject()->GetType();
+    return type == ObjectType::kFunction || type == ObjectType::kClosure ||
+           type == ObjectType::kContinuation;
 }
 
 template <class T>
-bool Is(const std::shared_ptr<Object>& obj) {
-    return static_cast<bool>(std::dynamic_pointer_cast<T>(obj));
+T* As(Value value) {
+    if (!Is<T>(value)) {
+        throw std::runtime_error("As: downcasting to wrong type");
+    }
+    return static_cast<T*>(value.GetObject());
 }
 
-inline const std::shared_ptr<Boolean> kTrue = std::make_shared<Boolean>(true);
-inline const std::shared_ptr<Boolean> kFalse = std::make_shared<Boolean>(false);
+// Flattens a list into its elements. An improper list throws SyntaxError, unless proper is
+// false: then the final cdr becomes the last element.
+std::vector<Value> CellToVector(Value list, bool proper = true);
+
+inline constexpr Value kTrue = Value::Boolean(true);
+inline constexpr Value kFalse = Value::Boolean(false);
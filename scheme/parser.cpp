@@ -1,9 +1,14 @@
 #include "error.h"
+#include "heap.h"
+#include "number.h"
 #include "object.h"
 #include "parser.h"
+#include "scheme-string.h"
 #include "tokenizer.h"
+#include "vector.h"
 
-#include <memory>
+#include <cstddef>
+#include <span>
 #include <vector>
 #include <variant>
 
@@ -13,47 +18,165 @@ struct Overloaded : Ts... {
     using Ts::operator()...;
 };
 
-std::shared_ptr<Object> ReadImpl(Tokenizer* tokenizer) {
-    if (tokenizer->IsEnd()) {
-        return nullptr;
-    }
-    Token token = tokenizer->GetToken();
-    auto visitor = Overloaded{
-        [&](const ConstantToken& token) {
-            tokenizer->Next();
-            return std::make_shared<Number>(token.value);
-        },
-        [&](const SymbolToken& token) -> std::shared_ptr<Object> {
-            tokenizer->Next();
-            if (token.name == "#t") {
-                return std::make_shared<Boolean>(true);
+// A datum whose reading has started but not finished. Nested data are read with an explicit
+// stack of these, so deeply nested input doesn't exhaust the native stack.
+struct PendingDatum {
+    enum class Kind {
+        // 'datum: wraps the next datum read.
+        kQuote,
+        // Collects data until the closing bracket.
+        kList,
+        // Collects the elements of a vector until the closing bracket.
+        kVector,
+        // After the dot of an improper list, expects its last cdr.
+        kDottedTail,
+        // After the last cdr of an improper list, expects the closing bracket.
+        kClose
+    };
+
+    Kind kind;
+    // A list is built in place as its elements are read: the first and the last of its cells,
+    // null while it is empty.
+    Value head = nullptr;
+    Cell* last = nullptr;
+    // Where the elements of a vector start on the stack of elements, as a vector is created
+    // once its size is known.
+    size_t first_element = 0;
+};
+
+Value ReadImpl(Tokenizer* tokenizer) {
+    using Kind = PendingDatum::Kind;
+    std::vector<PendingDatum> pending;
+    // The elements read so far of every vector being read, innermost last.
+    std::vector<Value> elements;
+    for (;;) {
+        if (tokenizer->IsEnd()) {
+            if (!pending.empty() && pending.back().kind != Kind::kQuote) {
+                throw SyntaxError("expect closing bracket");
+            }
+            if (pending.empty()) {
+                return nullptr;
+            }
+        }
+
+        Value datum;
+        bool complete = true;
+        if (!tokenizer->IsEnd()) {
+            Token token = tokenizer->GetToken();
+            if (!pending.empty() && pending.back().kind == Kind::kClose &&
+                token != Token{BracketToken::CLOSE}) {
+                throw SyntaxError("expect closing bracket");
             }
-            if (token.name == "#f") {
-                return std::make_shared<Boolean>(false);
+            auto visitor = Overloaded{
+                [&](const ConstantToken& token) {
+                    tokenizer->Next();
+                    datum = MakeInteger(token.value);
+                },
+                [&](const FlonumToken& token) {
+                    tokenizer->Next();
+                    datum = MakeFlonum(token.value);
+                },
+                // The text of a token views the tokenizer, so it is used before moving on.
+                [&](const BignumToken& token) {
+                    datum = ParseInteger(token.digits);
+                    tokenizer->Next();
+                },
+                [&](const SymbolToken& token) {
+                    if (token.name == "#t") {
+                        datum = kTrue;
+                    } else if (token.name == "#f") {
+                        datum = kFalse;
+                    } else {
+                        datum = Symbol::Intern(token.name);
+                    }
+                    tokenizer->Next();
+                },
+                [&](const StringToken& token) {
+                    datum = String::Literal(token.value);
+                    tokenizer->Next();
+                },
+                [&](const VectorToken&) {
+                    tokenizer->Next();
+                    pending.push_back({.kind = Kind::kVector, .first_element = elements.size()});
+                    complete = false;
+                },
+                [&](const QuoteToken&) {
+                    tokenizer->Next();
+                    pending.push_back({.kind = Kind::kQuote});
+                    complete = false;
+                },
+                [&](const BracketToken& token) {
+                    if (token == BracketToken::OPEN) {
+                        tokenizer->Next();
+                        pending.push_back({.kind = Kind::kList});
+                        complete = false;
+                        return;
+                    }
+                    if (pending.empty()) {
+                        throw SyntaxError("Read: not matching closing bracket");
+                    }
+                    auto& list = pending.back();
+                    if (list.kind == Kind::kList || list.kind == Kind::kClose) {
+                        datum = list.head;
+                    } else if (list.kind == Kind::kVector) {
+                        auto first = elements.begin() + list.first_element;
+                        datum = Vector::Create(std::span{first, elements.end()});
+                        elements.erase(first, elements.end());
+                    } else {
+                        throw SyntaxError("expect closing bracket");
+                    }
+                    tokenizer->Next();
+                    pending.pop_back();
+                },
+                [&](const DotToken&) {
+                    if (pending.empty() || pending.back().kind != Kind::kList) {
+                        throw SyntaxError("Read: unexpected token");
+                    }
+                    if (!pending.back().last) {
+                        throw SyntaxError("expect object before .");
+                    }
+                    tokenizer->Next();
+                    pending.back().kind = Kind::kDottedTail;
+                    complete = false;
+                }};
+            std::visit(visitor, token);
+            if (!complete) {
+                continue;
             }
-            return std::make_shared<Symbol>(token.name);
-        },
-        [&](const QuoteToken& token) {
-            tokenizer->Next();
-            auto quote_arg = ReadImpl(tokenizer);
-            auto wrapped_quote_arg = std::make_shared<Cell>(quote_arg, nullptr);
-            return std::make_shared<Cell>(std::make_shared<Symbol>("quote"), wrapped_quote_arg);
-        },
-        [&](const BracketToken& token) {
-            if (token == BracketToken::OPEN) {
-                return ReadList(tokenizer);
+        }
+
+        // Hands the datum to the data waiting for it; those completed by it are handed on.
+        for (;;) {
+            if (pending.empty()) {
+                return datum;
+            }
+            auto& parent = pending.back();
+            if (parent.kind == Kind::kQuote) {
+                datum = Make<Cell>(Symbol::Intern("quote"), Make<Cell>(datum, nullptr));
+                pending.pop_back();
+                continue;
             }
-            throw SyntaxError("Read: not matching closing bracket");
-        },
-        [](const auto&) -> std::shared_ptr<Object> {
-            throw SyntaxError("Read: unexpected token");
-        }};
-    return std::visit<std::shared_ptr<Object>>(visitor, token);
-    ;
+            if (parent.kind == Kind::kVector) {
+                elements.push_back(datum);
+            } else if (parent.kind == Kind::kDottedTail) {
+                parent.last->SetSecond(datum);
+                parent.kind = Kind::kClose;
+            } else {
+                auto* cell = Make<Cell>(datum, nullptr);
+                if (parent.last) {
+                    parent.last->SetSecond(cell);
+                } else {
+                    parent.head = cell;
+                }
+                parent.last = cell;
+            }
+            break;
+        }
+    }
 }
 }  // namespace
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+Value Read(Tokenizer* tokenizer) {
     auto result = ReadImpl(tokenizer);
     if (!tokenizer->IsEnd()) {
         throw SyntaxError("expect end of programm");
@@ -61,69 +184,19 @@ std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
     return result;
 }
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
+Value ReadNext(Tokenizer* tokenizer) {
     if (tokenizer->IsEnd()) {
-        throw SyntaxError("expected opening bracket");
+        throw SyntaxError("expect datum");
     }
+    return ReadImpl(tokenizer);
+}
 
-    auto check_bracket = [&](BracketToken expected_bracket) -> bool {
-        const auto token = tokenizer->GetToken();
-        auto bracket_token = std::get_if<BracketToken>(&token);
-        return bracket_token && *bracket_token == expected_bracket;
-    };
-
-    if (!check_bracket(BracketToken::OPEN)) {
+Value ReadList(Tokenizer* tokenizer) {
+    if (tokenizer->IsEnd()) {
         throw SyntaxError("expected opening bracket");
     }
-
-    tokenizer->Next();
-
-    bool read_next = true;
-    bool is_proper = true;
-
-    std::vector<std::shared_ptr<Object>> objects;
-
-    while (!tokenizer->IsEnd() && read_next) {
-        auto visitor = Overloaded{[&](const BracketToken& token) {
-                                      if (token == BracketToken::CLOSE) {
-                                          read_next = false;
-                                      }
-                                  },
-                                  [&](const DotToken& token) {
-                                      if (objects.empty()) {
-                                          throw SyntaxError("expect object before .");
-                                      }
-                                      tokenizer->Next();
-                                      objects.push_back(ReadImpl(tokenizer));
-                                      is_proper = false;
-                                      read_next = false;
-                                  },
-                                  [](const auto&) {}};
-        std::visit(visitor, tokenizer->GetToken());
-        if (read_next) {
-            objects.push_back(ReadImpl(tokenizer));
-        }
-    }
-
-    if (tokenizer->IsEnd() || !check_bracket(BracketToken::CLOSE)) {
-        throw SyntaxError("expect closing bracket");
-    }
-
-    tokenizer->Next();
-
-    if (objects.empty()) {
-        return nullptr;
-    }
-
-    std::shared_ptr<Object> result = is_proper ? nullptr : objects.back();
-    size_t next_index = is_proper ? objects.size() - 1 : objects.size() - 2;
-
-    while (true) {
-        result = std::make_shared<Cell>(objects[next_index], result);
-        if (next_index-- == 0) {
-            break;
-        }
+    if (tokenizer->GetToken() != Token{BracketToken::OPEN}) {
+        throw SyntaxError("expected opening bracket");
     }
-
-    return result;
+    return ReadImpl(tokenizer);
 }
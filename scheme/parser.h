@@ -3,8 +3,10 @@
 #include "object.h"
 #include "tokenizer.h"
 
-#include <memory>
+Value Read(Tokenizer* tokenizer);
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer);
+// Reads the datum at the start of the input and leaves the tokenizer after it, so input holding
+// several data is read one datum at a time. Throws SyntaxError at the end of the input.
+Value ReadNext(Tokenizer* tokenizer);
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer);
+Value ReadList(Tokenizer* tokenizer);
@@ -0,0 +1,293 @@
+#include "printer.h"
+
+#include <charconv>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "hash-table.h"
+#include "heap.h"
+#include "number.h"
+#include "scheme-string.h"
+#include "vector.h"
+
+namespace {
+// Bytes gathered before they are written to a stream.
+constexpr size_t kFlushSize = 1 << 16;
+constexpr size_t kWalksPerObject = 4;
+
+void AppendInteger(std::string* result, int64_t value) {
+    char digits[20];
+    auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    result->append(digits, end);
+}
+
+// Numeric vectors print in the syntax of SRFI 4, as #s64(1 2) and #f64(1.0 2.0).
+template <class V>
+void AppendNumericVector(std::string* result, const char* tag, const V* vector) {
+    *result += tag;
+    *result += '(';
+    auto elements = vector->GetElements();
+    for (size_t i = 0; i < elements.size(); ++i) {
+        if (i != 0) {
+            *result += ' ';
+        }
+        if constexpr (std::is_same_v<typename V::Element, double>) {
+            *result += FlonumToString(elements[i]);
+        } else {
+            AppendInteger(result, elements[i]);
+        }
+    }
+    *result += ')';
+}
+
+// Strings print as literals that read back as the same string.
+void AppendString(std::string* result, std::string_view text) {
+    *result += '"';
+    for (auto c : text) {
+        if (c == '"' || c == '\\') {
+            *result += '\\';
+            *result += c;
+        } else if (c == '\n') {
+            *result += "\\n";
+        } else if (c == '\t') {
+            *result += "\\t";
+        } else {
+            *result += c;
+        }
+    }
+    *result += '"';
+}
+
+// Pairs and vectors, the objects that may need a label.
+bool IsContainer(Value value) {
+    return Is<Cell>(value) || Is<Vector>(value);
+}
+
+// Whether no cycle goes through the pairs and vectors reachable from value, if it returns
+// true. Walks them as a tree, which only a cycle makes endless: sharing makes it longer, but
+// seldom as long as visiting every object of the heap several times over, where it gives up.
+bool IsSurelyAcyclic(Value value) {
+    auto budget = kWalksPerObject * Heap::Instance().GetObjectCount();
+    std::vector<Value> stack{value};
+    while (!stack.empty()) {
+        auto next = stack.back();
+        stack.pop_back();
+        // Lists are walked down their cdrs without the stack.
+        while (IsContainer(next)) {
+            if (budget-- == 0) {
+                return false;
+            }
+            if (Is<Vector>(next)) {
+                for (auto element : As<Vector>(next)->GetElements()) {
+                    if (IsContainer(element)) {
+                        stack.push_back(element);
+                    }
+                }
+                break;
+            }
+            auto* cell = As<Cell>(next);
+            if (IsContainer(cell->GetFirst())) {
+                stack.push_back(cell->GetFirst());
+            }
+            next = cell->GetSecond();
+        }
+    }
+    return true;
+}
+
+// The pairs and vectors to label, mapped to -1 until their label is numbered. A cycle closes
+// where the walk reaches an object whose elements it is still walking; with kShared, reaching an
+// object that was walked before is enough.
+std::unordered_map<Object*, int64_t> FindLabels(Value value, PrintLabels labels) {
+    enum class State { kWalking, kWalked };
+    std::unordered_map<Object*, State> states;
+    std::unordered_map<Object*, int64_t> found;
+    // An object is pushed again under its elements, to be marked walked when it is popped.
+    std::vector<std::pair<Value, bool>> stack{{value, false}};
+    while (!stack.empty()) {
+        auto [next, walked] = stack.back();
+        stack.pop_back();
+        if (walked) {
+            states[next.GetObject()] = State::kWalked;
+            continue;
+        }
+        if (!IsContainer(next)) {
+            continue;
+        }
+        auto [it, inserted] = states.emplace(next.GetObject(), State::kWalking);
+        if (!inserted) {
+            if (it->second == State::kWalking || labels == PrintLabels::kShared) {
+                found.emplace(next.GetObject(), -1);
+            }
+            continue;
+        }
+        stack.emplace_back(next, true);
+        if (Is<Cell>(next)) {
+            stack.emplace_back(As<Cell>(next)->GetSecond(), false);
+            stack.emplace_back(As<Cell>(next)->GetFirst(), false);
+        } else {
+            auto elements = As<Vector>(next)->GetElements();
+            for (size_t i = elements.size(); i-- > 0;) {
+                stack.emplace_back(elements[i], false);
+            }
+        }
+    }
+    return found;
+}
+
+// Prints into result, and moves what it holds to the stream whenever it grows past
+// kFlushSize if there is one.
+void PrintTo(Value obj, std::string* result, std::ostream* stream, PrintLabels mode) {
+    auto labels = mode == PrintLabels::kCycles && IsSurelyAcyclic(obj)
+                      ? std::unordered_map<Object*, int64_t>{}
+                      : FindLabels(obj, mode);
+    int64_t label_count = 0;
+    // Defines the label of an object printed for the first time. Returns true if it was
+    // printed before, having printed a reference to it instead.
+    auto print_label = [&](Value value) {
+        auto it = labels.find(value.GetObject());
+        if (it == labels.end()) {
+            return false;
+        }
+        *result += '#';
+        auto defined = it->second >= 0;
+        if (!defined) {
+            it->second = label_count++;
+        }
+        AppendInteger(result, it->second);
+        *result += defined ? '#' : '=';
+        return defined;
+    };
+
+    auto flush = [&] {
+        if (stream && result->size() >= kFlushSize) {
+            stream->write(result->data(), result->size());
+            result->clear();
+        }
+    };
+    // Prints value unless it is a pair or a vector. Anything else that is no datum is left to
+    // fail as a pair.
+    auto print_atom = [&](Value value) {
+        if (value.IsFixnum()) {
+            AppendInteger(result, value.GetFixnum());
+        } else if (value.IsNil()) {
+            *result += "()";
+        } else if (value.IsBoolean()) {
+            *result += value.GetBoolean() ? "#t" : "#f";
+        } else if (!value.IsObject()) {
+            return false;
+        } else {
+            switch (value.GetObject()->GetType()) {
+                case ObjectType::kSymbol:
+                    *result += As<Symbol>(value)->GetName();
+                    break;
+                case ObjectType::kBignum:
+                case ObjectType::kFlonum:
+                    *result += NumberToString(value);
+                    break;
+                case ObjectType::kString:
+                    AppendString(result, As<String>(value)->GetView());
+                    break;
+                case ObjectType::kS64Vector:
+                    AppendNumericVector(result, "#s64", As<S64Vector>(value));
+                    break;
+                case ObjectType::kF64Vector:
+                    AppendNumericVector(result, "#f64", As<F64Vector>(value));
+                    break;
+                case ObjectType::kHashTable:
+                    *result += "#<hash-table>";
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return true;
+    };
+
+    // Data are printed with an explicit stack of what is left to print.
+    enum class Step {
+        kValue,
+        // The rest of a list after an element.
+        kRest,
+        // Between the elements of a vector.
+        kSpace,
+        kClose
+    };
+    std::vector<std::pair<Step, Value>> steps{{Step::kValue, obj}};
+    // Prints the rest of a list, having printed what comes before it. Atoms are printed right
+    // away; the stack is left with the first element that is not one, and the rest after it.
+    auto print_rest = [&](Value rest) {
+        for (;;) {
+            if (rest.IsNil()) {
+                *result += ')';
+                return;
+            }
+            if (!Is<Cell>(rest) || (!labels.empty() && labels.contains(rest.GetObject()))) {
+                // A labeled rest is printed as a list of its own, so the label has a place.
+                *result += " . ";
+                steps.emplace_back(Step::kClose, nullptr);
+                steps.emplace_back(Step::kValue, rest);
+                return;
+            }
+            *result += ' ';
+            auto* cell = As<Cell>(rest);
+            rest = cell->GetSecond();
+            if (!print_atom(cell->GetFirst())) {
+                steps.emplace_back(Step::kRest, rest);
+                steps.emplace_back(Step::kValue, cell->GetFirst());
+                return;
+            }
+            flush();
+        }
+    };
+    while (!steps.empty()) {
+        flush();
+        auto [step, value] = steps.back();
+        steps.pop_back();
+        if (step == Step::kClose) {
+            *result += ')';
+        } else if (step == Step::kSpace) {
+            *result += ' ';
+        } else if (step == Step::kRest) {
+            print_rest(value);
+        } else if (print_atom(value)) {
+            continue;
+        } else if (!labels.empty() && IsContainer(value) && print_label(value)) {
+            continue;
+        } else if (Is<Vector>(value)) {
+            auto elements = As<Vector>(value)->GetElements();
+            *result += "#(";
+            steps.emplace_back(Step::kClose, nullptr);
+            for (size_t i = elements.size(); i-- > 0;) {
+                steps.emplace_back(Step::kValue, elements[i]);
+                if (i != 0) {
+                    steps.emplace_back(Step::kSpace, nullptr);
+                }
+            }
+        } else {
+            auto cell = As<Cell>(value);
+            *result += '(';
+            steps.emplace_back(Step::kRest, cell->GetSecond());
+            steps.emplace_back(Step::kValue, cell->GetFirst());
+        }
+    }
+    if (stream) {
+        stream->write(result->data(), result->size());
+        result->clear();
+    }
+}
+}  // namespace
+
+void Print(Value value, std::string* out, PrintLabels labels) {
+    PrintTo(value, out, nullptr, labels);
+}
+
+void Print(Value value, std::ostream* out, PrintLabels labels) {
+    std::string buffer;
+    buffer.reserve(kFlushSize + kFlushSize / 4);
+    PrintTo(value, &buffer, out, labels);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include "object.h"
+
+// Which pairs and vectors get datum labels: #n= where one is first printed and #n# wherever it
+// is printed again.
+enum class PrintLabels {
+    // Only those a cycle goes through, without which the output would never end.
+    kCycles,
+    // Also every one reached more than once, so the output shows all sharing.
+    kShared
+};
+
+// Appends the printed form of value. Data print iteratively, so neither long nor deeply
+// nested data grow the native stack. Finding the objects to label takes a table of every pair
+// and vector, unless only cycles are labeled and a quicker walk shows there are none.
+void Print(Value value, std::string* out, PrintLabels labels = PrintLabels::kCycles);
+// Writes to the stream in chunks while printing, so the whole text is never held at once.
+void Print(Value value, std::ostream* out, PrintLabels labels = PrintLabels::kCycles);
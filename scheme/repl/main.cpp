@@ -4,8 +4,20 @@
 #include <stdexcept>
 #include <string>
 
-int main() {
+// Evaluates the files given as arguments, or reads expressions line by line without any.
+int main(int argc, char** argv) {
     Scheme scheme;
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            try {
+                scheme.Load(argv[i]);
+            } catch (const std::runtime_error& ex) {
+                std::cerr << argv[i] << ": " << ex.what() << '\n';
+                return 1;
+            }
+        }
+        return 0;
+    }
     std::string expression;
     std::cout << "Scheme 1.0.0\n";
     while (std::cin) {
@@ -15,7 +27,7 @@ int main() {
             continue;
         }
         try {
-            std::cout << scheme.Evaluate(expression);
+            scheme.Evaluate(expression, &std::cout);
         } catch (const std::runtime_error& ex) {
             std::cout << ex.what();
         }
@@ -0,0 +1,113 @@
+#include "scan-kernels.h"
+
+// Only x86-64 has block classification; elsewhere the tokenizer looks characters up itself.
+#if SCHEME_AVX2
+#include <immintrin.h>
+#include <cstring>
+#include "vector-kernels.h"
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+namespace {
+// The classes on vectors of characters, which set the bytes that are in the class to 0xff. They
+// are written with the vector extensions of GCC and Clang and inlined into the callers, which
+// compile them for SSE2 or AVX2.
+struct SpaceClass {
+    template <class Bytes>
+    [[gnu::always_inline]] static void Match(const Bytes& c, Bytes* in_class) {
+        // Tab, line feed, vertical tab, form feed and carriage return are consecutive.
+        auto control = static_cast<Bytes>(c - '\t') <= '\r' - '\t';
+        *in_class = __builtin_convertvector((c == ' ') | control, Bytes);
+    }
+};
+
+struct DigitClass {
+    template <class Bytes>
+    [[gnu::always_inline]] static void Match(const Bytes& c, Bytes* in_class) {
+        *in_class = __builtin_convertvector(static_cast<Bytes>(c - '0') <= 9, Bytes);
+    }
+};
+
+struct SymbolTailClass {
+    template <class Bytes>
+    [[gnu::always_inline]] static void Match(const Bytes& c, Bytes* in_class) {
+        // Setting 0x20 lowercases letters. '<' to '?' are the four characters <=>?.
+        auto letter = static_cast<Bytes>((c | 0x20) - 'a') < 26;
+        auto digit = static_cast<Bytes>(c - '0') <= 9;
+        auto comparison = static_cast<Bytes>(c - '<') <= '?' - '<';
+        auto other = (c == '*') | (c == '#') | (c == '!') | (c == '-') | (c == '/');
+        *in_class = __builtin_convertvector(letter | digit | comparison | other, Bytes);
+    }
+};
+
+struct StringClass {
+    template <class Bytes>
+    [[gnu::always_inline]] static void Match(const Bytes& c, Bytes* in_class) {
+        *in_class = __builtin_convertvector((c != '"') & (c != '\\'), Bytes);
+    }
+};
+
+using Bytes16 = uint8_t __attribute__((vector_size(16)));
+using Bytes32 = uint8_t __attribute__((vector_size(32)));
+
+// SSE2 is part of x86-64, so it needs no check.
+template <class Class>
+uint64_t ClassifySse2(const char* text) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < kScanBlockSize / sizeof(Bytes16); ++i) {
+        auto data = reinterpret_cast<const __m128i*>(text) + i;
+        Bytes16 in_class;
+        Class::Match(__builtin_bit_cast(Bytes16, _mm_loadu_si128(data)), &in_class);
+        auto bits = static_cast<uint32_t>(_mm_movemask_epi8(__builtin_bit_cast(__m128i, in_class)));
+        mask |= uint64_t{bits} << (i * sizeof(Bytes16));
+    }
+    return mask;
+}
+
+template <class Class>
+AVX2_TARGET uint64_t ClassifyAvx2(const char* text) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < kScanBlockSize / sizeof(Bytes32); ++i) {
+        auto data = reinterpret_cast<const __m256i*>(text) + i;
+        Bytes32 in_class;
+        Class::Match(__builtin_bit_cast(Bytes32, _mm256_loadu_si256(data)), &in_class);
+        auto bits =
+            static_cast<uint32_t>(_mm256_movemask_epi8(__builtin_bit_cast(__m256i, in_class)));
+        mask |= uint64_t{bits} << (i * sizeof(Bytes32));
+    }
+    return mask;
+}
+
+template <class Class>
+uint64_t Classify(const char* text) {
+    return HasVectorKernelsAvx2() ? ClassifyAvx2<Class>(text) : ClassifySse2<Class>(text);
+}
+}  // namespace
+
+uint64_t ClassifyBlock(const char* text, size_t size, CharClass char_class) {
+    // A short block is classified from a copy, so nothing past the text is read.
+    char padded[kScanBlockSize];
+    if (size < kScanBlockSize) {
+        std::memset(padded, 0, sizeof(padded));
+        // At the end of the source there may be no text at all, not even a pointer to it.
+        if (size != 0) {
+            std::memcpy(padded, text, size);
+        }
+        text = padded;
+    }
+    uint64_t mask = 0;
+    if (char_class == kSpaceChar) {
+        mask = Classify<SpaceClass>(text);
+    } else if (char_class == kDigitChar) {
+        mask = Classify<DigitClass>(text);
+    } else if (char_class == kSymbolTailChar) {
+        mask = Classify<SymbolTailClass>(text);
+    } else if (char_class == kStringChar) {
+        mask = Classify<StringClass>(text);
+    }
+    if (size < kScanBlockSize) {
+        mask &= (uint64_t{1} << size) - 1;
+    }
+    return mask;
+}
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Classes of characters in source text, for the tokenizer.
+//
+// On x86-64, text is classified a block at a time into a bitmask, 32 characters at a time with
+// AVX2 when the processor has it and 16 at a time with SSE2 otherwise. The end of a run of one
+// class is then found with a count of trailing zeros rather than a loop over the characters.
+// Elsewhere a loop looking each character up in a table is faster.
+
+// The same switch as for the vector kernels: set to 0 for the portable loops.
+#ifndef SCHEME_AVX2
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define SCHEME_AVX2 1
+#else
+#define SCHEME_AVX2 0
+#endif
+#endif
+
+inline constexpr bool kVectorizedScan = SCHEME_AVX2;
+
+enum CharClass : uint8_t {
+    kSpaceChar = 1 << 0,
+    kDigitChar = 1 << 1,
+    kSymbolHeadChar = 1 << 2,
+    kSymbolTailChar = 1 << 3,
+    // Anything in a string literal but the closing quote and a backslash.
+    kStringChar = 1 << 4
+};
+
+inline constexpr std::array<uint8_t, 256> kCharClasses = [] {
+    std::array<uint8_t, 256> classes{};
+    auto add = [&classes](int from, int to, uint8_t flags) {
+        for (int c = from; c <= to; ++c) {
+            classes[c] |= flags;
+        }
+    };
+    add(0, 255, kStringChar);
+    classes['"'] = classes['\\'] = 0;
+    add('\t', '\r', kSpaceChar);
+    add(' ', ' ', kSpaceChar);
+    add('0', '9', kDigitChar | kSymbolTailChar);
+    add('a', 'z', kSymbolHeadChar | kSymbolTailChar);
+    add('A', 'Z', kSymbolHeadChar | kSymbolTailChar);
+    for (char c : {'<', '=', '>', '*', '#', '-', '/'}) {
+        add(c, c, kSymbolHeadChar | kSymbolTailChar);
+    }
+    add('+', '+', kSymbolHeadChar);
+    add('?', '?', kSymbolTailChar);
+    add('!', '!', kSymbolTailChar);
+    return classes;
+}();
+
+// Whether c, a character or EOF, is in any of the classes.
+constexpr bool HasCharClass(int c, uint8_t classes) {
+    return c != EOF && (kCharClasses[static_cast<unsigned char>(c)] & classes) != 0;
+}
+
+inline constexpr size_t kScanBlockSize = 64;
+
+// Bit i of the result is set when character i of text is in the class, for the first
+// min(size, kScanBlockSize) characters; the bits past them are clear. Only with kVectorizedScan,
+// and only for the classes but kSymbolHeadChar.
+uint64_t ClassifyBlock(const char* text, size_t size, CharClass char_class);
@@ -0,0 +1,48 @@
+#include "scheme-string.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include "heap.h"
+
+struct String::LiteralPool {
+    // The pool may go before or after the heap, whose destruction destroys the literals.
+    ~LiteralPool() {
+        for (auto [text, literal] : literals) {
+            literal->literal_ = false;
+        }
+    }
+
+    std::unordered_map<std::string_view, String*> literals;
+};
+
+String* String::Create(std::string_view text) {
+    auto* string = Allocate(text.size());
+    std::ranges::copy(text, string->GetChars().begin());
+    return string;
+}
+
+String* String::Allocate(size_t size) {
+    return Heap::Instance().MakeSized<String>(sizeof(String) + size, size);
+}
+
+String* String::Literal(std::string_view text) {
+    auto& literals = GetLiteralPool().literals;
+    if (auto it = literals.find(text); it != literals.end()) {
+        return it->second;
+    }
+    auto* string = Create(text);
+    string->literal_ = true;
+    literals.emplace(string->GetView(), string);
+    return string;
+}
+
+String::~String() {
+    if (literal_) {
+        GetLiteralPool().literals.erase(GetView());
+    }
+}
+
+String::LiteralPool& String::GetLiteralPool() {
+    thread_local LiteralPool pool;
+    return pool;
+}
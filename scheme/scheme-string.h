@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include "object.h"
+
+// A string of bytes, stored right after the object, so any string takes a single allocation
+// and short ones land in the small size classes of the allocator.
+//
+// No builtin modifies a string, so literals read from the source are shared: reading the same
+// text again gives the same object for as long as it is alive.
+class String : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kString;
+
+    static String* Create(std::string_view text);
+    // A string of size bytes for the caller to fill in before it is used.
+    static String* Allocate(size_t size);
+    static String* Literal(std::string_view text);
+
+    ~String() override;
+
+    size_t GetSize() const {
+        return size_;
+    }
+
+    std::string_view GetView() const {
+        return {reinterpret_cast<const char*>(this + 1), size_};
+    }
+
+    // For filling in a string made by Allocate.
+    std::span<char> GetChars() {
+        return {reinterpret_cast<char*>(this + 1), size_};
+    }
+
+private:
+    friend class Heap;
+
+    // Holds the live literals weakly: a literal leaves it when it is collected.
+    struct LiteralPool;
+
+    static LiteralPool& GetLiteralPool();
+
+    explicit String(size_t size) : Object(kType), size_(size) {
+    }
+
+    size_t size_;
+    bool literal_ = false;
+};
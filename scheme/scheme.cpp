@@ -1,109 +1,326 @@
 #include "scheme.h"
 
+#include <fstream>
+#include <istream>
 #include <memory>
-#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "analyzer.h"
+#include "error.h"
+#include "fasl.h"
+#include "hash-table.h"
+#include "heap.h"
+#include "number.h"
 #include "object.h"
 #include "parser.h"
+#include "printer.h"
+#include "scheme-string.h"
 #include "tokenizer.h"
+#include "vector.h"
+#include "vm.h"
 #include "builtin-functions.h"
 
-Scheme::Scheme() {
-    scope_ = std::make_shared<Scope>(std::unordered_map<std::string, std::shared_ptr<Object>>{
-        {{"quote", std::make_shared<Quote>()},
-         {"define", std::make_shared<Define>()},
-         {"set!", std::make_shared<Set>()},
-         {"boolean?", std::make_shared<IsBoolean>()},
-         {"not", std::make_shared<Not>()},
-         {"and", std::make_shared<And>()},
-         {"or", std::make_shared<Or>()},
-         {"number?", std::make_shared<IsNumber>()},
-         {"<", std::make_shared<Less>()},
-         {"<=", std::make_shared<LessOrEqual>()},
-         {">", std::make_shared<Greater>()},
-         {">=", std::make_shared<GreaterOrEqual>()},
-         {"=", std::make_shared<Equal>()},
-         {"+", std::make_shared<Add>()},
-         {"-", std::make_shared<Sub>()},
-         {"*", std::make_shared<Mul>()},
-         {"/", std::make_shared<Div>()},
-         {"min", std::make_shared<Min>()},
-         {"max", std::make_shared<Max>()},
-         {"abs", std::make_shared<Abs>()},
-         {"pair?", std::make_shared<IsPair>()},
-         {"null?", std::make_shared<IsNull>()},
-         {"list?", std::make_shared<IsList>()},
-         {"cons", std::make_shared<Cons>()},
-         {"car", std::make_shared<Car>()},
-         {"cdr", std::make_shared<Cdr>()},
-         {"set-car!", std::make_shared<SetCar>()},
-         {"set-cdr!", std::make_shared<SetCdr>()},
-         {"list", std::make_shared<List>()},
-         {"list-ref", std::make_shared<ListRef>()},
-         {"list-tail", std::make_shared<ListTail>()},
-         {"if", std::make_shared<If>()},
-         {"lambda", std::make_shared<Lambda>()},
-         {"symbol?", std::make_shared<IsSymbol>()}}});
+Scheme::Scheme(ExecutionMode mode) : mode_(mode) {
+    Value call_cc = Make<CallWithCurrentContinuation>();
+    Value call_ec = Make<CallWithEscapeContinuation>();
+    Value is_eq = Make<IsEq>();
+    Value is_eqv = Make<IsEqv>();
+    Value is_equal = Make<IsEqual>();
+    std::initializer_list<std::pair<std::string_view, Value>> builtins{
+        {"boolean?", Make<IsBoolean>()},
+        {"not", Make<Not>()},
+        {"eq?", is_eq},
+        {"eqv?", is_eqv},
+        {"equal?", is_equal},
+        {"number?", Make<IsNumber>()},
+        {"<", Make<Less>()},
+        {"<=", Make<LessOrEqual>()},
+        {">", Make<Greater>()},
+        {">=", Make<GreaterOrEqual>()},
+        {"=", Make<Equal>()},
+        {"+", Make<Add>()},
+        {"-", Make<Sub>()},
+        {"*", Make<Mul>()},
+        {"/", Make<Div>()},
+        {"min", Make<Min>()},
+        {"max", Make<Max>()},
+        {"abs", Make<Abs>()},
+        {"pair?", Make<IsPair>()},
+        {"null?", Make<IsNull>()},
+        {"list?", Make<IsList>()},
+        {"cons", Make<Cons>()},
+        {"car", Make<Car>()},
+        {"cdr", Make<Cdr>()},
+        {"set-car!", Make<SetCar>()},
+        {"set-cdr!", Make<SetCdr>()},
+        {"list", Make<List>()},
+        {"list-ref", Make<ListRef>()},
+        {"list-tail", Make<ListTail>()},
+        {"symbol?", Make<IsSymbol>()},
+        {"string?", Make<IsString>()},
+        {"string-length", Make<StringLength>()},
+        {"substring", Make<Substring>()},
+        {"string-append", Make<StringAppend>()},
+        {"string=?", Make<StringEqual>()},
+        {"string->symbol", Make<StringToSymbol>()},
+        {"symbol->string", Make<SymbolToString>()},
+        {"number->string", Make<FormatNumber>()},
+        {"vector?", Make<IsVector>()},
+        {"make-vector", Make<MakeVector>()},
+        {"vector", Make<VectorOf>()},
+        {"vector-length", Make<VectorLength>()},
+        {"vector-ref", Make<VectorRef>()},
+        {"vector-set!", Make<VectorSet>()},
+        {"vector-fill!", Make<VectorFill>()},
+        {"vector->list", Make<VectorToList>()},
+        {"list->vector", Make<ListToVector>()},
+        {"s64vector?", Make<IsNumericVector<S64Vector>>("s64vector?")},
+        {"make-s64vector", Make<MakeNumericVector<S64Vector>>("make-s64vector")},
+        {"s64vector", Make<NumericVectorOf<S64Vector>>("s64vector")},
+        {"s64vector-length", Make<NumericVectorLength<S64Vector>>("s64vector-length")},
+        {"s64vector-ref", Make<NumericVectorRef<S64Vector>>("s64vector-ref")},
+        {"s64vector-set!", Make<NumericVectorSet<S64Vector>>("s64vector-set!")},
+        {"s64vector->list", Make<NumericVectorToList<S64Vector>>("s64vector->list")},
+        {"list->s64vector", Make<ListToNumericVector<S64Vector>>("list->s64vector")},
+        {"s64vector-add",
+         Make<NumericVectorElementwise<S64Vector>>("s64vector-add", ElementwiseOperation::kAdd)},
+        {"s64vector-sub",
+         Make<NumericVectorElementwise<S64Vector>>("s64vector-sub",
+                                                  ElementwiseOperation::kSubtract)},
+        {"s64vector-mul",
+         Make<NumericVectorElementwise<S64Vector>>("s64vector-mul",
+                                                  ElementwiseOperation::kMultiply)},
+        {"s64vector-scale", Make<NumericVectorScale<S64Vector>>("s64vector-scale")},
+        {"s64vector-dot", Make<NumericVectorDot<S64Vector>>("s64vector-dot")},
+        {"s64vector-sum", Make<NumericVectorSum<S64Vector>>("s64vector-sum")},
+        {"s64vector-min", Make<NumericVectorMin<S64Vector>>("s64vector-min")},
+        {"s64vector-max", Make<NumericVectorMax<S64Vector>>("s64vector-max")},
+        {"f64vector?", Make<IsNumericVector<F64Vector>>("f64vector?")},
+        {"make-f64vector", Make<MakeNumericVector<F64Vector>>("make-f64vector")},
+        {"f64vector", Make<NumericVectorOf<F64Vector>>("f64vector")},
+        {"f64vector-length", Make<NumericVectorLength<F64Vector>>("f64vector-length")},
+        {"f64vector-ref", Make<NumericVectorRef<F64Vector>>("f64vector-ref")},
+        {"f64vector-set!", Make<NumericVectorSet<F64Vector>>("f64vector-set!")},
+        {"f64vector->list", Make<NumericVectorToList<F64Vector>>("f64vector->list")},
+        {"list->f64vector", Make<ListToNumericVector<F64Vector>>("list->f64vector")},
+        {"f64vector-add",
+         Make<NumericVectorElementwise<F64Vector>>("f64vector-add", ElementwiseOperation::kAdd)},
+        {"f64vector-sub",
+         Make<NumericVectorElementwise<F64Vector>>("f64vector-sub",
+                                                  ElementwiseOperation::kSubtract)},
+        {"f64vector-mul",
+         Make<NumericVectorElementwise<F64Vector>>("f64vector-mul",
+                                                  ElementwiseOperation::kMultiply)},
+        {"f64vector-scale", Make<NumericVectorScale<F64Vector>>("f64vector-scale")},
+        {"f64vector-dot", Make<NumericVectorDot<F64Vector>>("f64vector-dot")},
+        {"f64vector-sum", Make<NumericVectorSum<F64Vector>>("f64vector-sum")},
+        {"f64vector-min", Make<NumericVectorMin<F64Vector>>("f64vector-min")},
+        {"f64vector-max", Make<NumericVectorMax<F64Vector>>("f64vector-max")},
+        {"hash-table?", Make<IsHashTable>()},
+        {"make-hash-table", Make<MakeHashTable>(is_eq, is_eqv, is_equal)},
+        {"hash-table-ref", Make<HashTableRef>()},
+        {"hash-table-ref/default", Make<HashTableRefDefault>()},
+        {"hash-table-set!", Make<HashTableSet>()},
+        {"hash-table-delete!", Make<HashTableDelete>()},
+        {"hash-table-contains?", Make<HashTableContains>()},
+        {"hash-table-count", Make<HashTableCount>()},
+        {"hash-table-keys", Make<HashTableKeys>()},
+        {"hash-table-values", Make<HashTableValues>()},
+        {"hash-table->alist", Make<HashTableToAlist>()},
+        {"write-fasl", Make<WriteFasl>()},
+        {"read-fasl", Make<ReadFasl>()},
+        {"gc", Make<GarbageCollect>()},
+        {"call-with-current-continuation", call_cc},
+        {"call/cc", call_cc},
+        {"call-with-escape-continuation", call_ec},
+        {"call/ec", call_ec}};
+    globals_ = Make<Globals>();
+    for (const auto& [name, function] : builtins) {
+        globals_->Define(Symbol::Intern(name)->GetId(), function);
+    }
+    Heap::Instance().AddRoot(globals_);
+    if (mode_ == ExecutionMode::kBytecode) {
+        vm_ = std::make_unique<VirtualMachine>(globals_);
+    }
+    SetMaxCallDepth(vm_ ? kDefaultMaxVmCallDepth : kDefaultMaxCallDepth);
+}
+
+Scheme::~Scheme() {
+    vm_.reset();
+    Heap::Instance().RemoveRoot(globals_);
 }
 
 std::string Scheme::Evaluate(const std::string& expression) {
-    std::stringstream ss{expression};
-    Tokenizer tokenizer(&ss);
-    auto expr = Read(&tokenizer);
-    auto evaluated = ::Evaluate(expr, scope_);
-    return ToString(evaluated);
+    auto& heap = Heap::Instance();
+    heap.CollectAtSafePoint();
+    Tokenizer tokenizer(std::string_view{expression});
+    auto result = ToString(EvaluateForm(Read(&tokenizer)));
+    heap.CollectAtSafePoint();
+    return result;
 }
 
-// std::shared_ptr<Object> Scheme::Evaluate(std::shared_ptr<Object> arg) {
-//     if (Is<Number>(arg)) {
-//         return arg;
-//     }
-//     throw std::runtime_error("Not implemented");
+void Scheme::Evaluate(const std::string& expression, std::ostream* out) {
+    auto& heap = Heap::Instance();
+    heap.CollectAtSafePoint();
+    Tokenizer tokenizer(std::string_view{expression});
+    Print(EvaluateForm(Read(&tokenizer)), out, print_labels_);
+    heap.CollectAtSafePoint();
+}
 
-// }
+Value Scheme::EvaluateForm(Value form) {
+    // The form holds the constants of its code, which collections during it must keep.
+    ScopedRoot root(form);
+    auto node = Analyze(form, globals_);
+    return vm_ ? vm_->Evaluate(*node) : Execute(*node, max_call_depth_);
+}
 
-std::string Scheme::ToString(std::shared_ptr<Object> obj) {
-    if (obj == nullptr) {
-        return "()";
+namespace {
+void WriteFile(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(bytes.data(), bytes.size())) {
+        throw RuntimeError("cannot write " + path);
     }
-    if (Is<Number>(obj)) {
-        return std::to_string(As<Number>(obj)->GetValue());
+}
+
+Value ReadForm(Tokenizer* tokenizer) {
+    return ReadNext(tokenizer);
+}
+
+Value ReadForm(FaslReader* reader) {
+    return reader->Next();
+}
+}  // namespace
+
+template <class Reader>
+std::string Scheme::EvaluateForms(Reader* reader, const ResultCallback& on_result) {
+    auto& heap = Heap::Instance();
+    std::string result;
+    while (!reader->IsEnd()) {
+        // Between forms nothing but the globals is live.
+        heap.CollectAtSafePoint();
+        auto value = EvaluateForm(ReadForm(reader));
+        // Results nobody asked for aren't printed: loading a program discards most of them.
+        if (on_result) {
+            result = ToString(value);
+            on_result(result);
+        } else if (reader->IsEnd()) {
+            result = ToString(value);
+        }
     }
-    if (Is<Boolean>(obj)) {
-        return As<Boolean>(obj)->GetValue() ? "#t" : "#f";
+    heap.CollectAtSafePoint();
+    return result;
+}
+
+std::string Scheme::EvaluateAll(std::string_view program, const ResultCallback& on_result) {
+    Tokenizer tokenizer(program);
+    return EvaluateForms(&tokenizer, on_result);
+}
+
+std::string Scheme::EvaluateAll(std::istream* input, const ResultCallback& on_result) {
+    Tokenizer tokenizer(input);
+    return EvaluateForms(&tokenizer, on_result);
+}
+
+std::string Scheme::Load(const std::string& path, const ResultCallback& on_result) {
+    FileContents contents(path);
+    auto bytes = contents.GetView();
+    if (IsImage(bytes)) {
+        RestoreImage(bytes);
+        return {};
     }
-    if (Is<Symbol>(obj)) {
-        return As<Symbol>(obj)->GetName();
+    if (IsFasl(bytes)) {
+        FaslReader reader(bytes);
+        return EvaluateForms(&reader, on_result);
     }
-    std::vector<std::string> inner_strings;
-    bool proper = true;
-    auto cell = As<Cell>(obj);
-    while (cell) {
-        inner_strings.push_back(ToString(cell->GetFirst()));
-        if (cell->GetSecond() == nullptr) {
-            break;
-        }
-        if (Is<Cell>(cell->GetSecond())) {
-            cell = As<Cell>(cell->GetSecond());
-        } else {
-            proper = false;
-            inner_strings.push_back(ToString(cell->GetSecond()));
-            break;
-        }
+    return EvaluateAll(bytes, on_result);
+}
+
+void Scheme::MakeFasl(const std::string& source_path, const std::string& fasl_path) {
+    FileContents source(source_path);
+    Tokenizer tokenizer(source.GetView());
+    FaslWriter writer;
+    while (!tokenizer.IsEnd()) {
+        writer.Add(ReadNext(&tokenizer));
     }
+    WriteFile(fasl_path, writer.Finish());
+}
+
+void Scheme::SaveImage(const std::string& path) const {
+    // The mode, then the names of the globals and their values in turn.
+    size_t count = 0;
+    globals_->ForEach([&count](uint32_t, Value) { ++count; });
+    auto* globals = Vector::Create(count * 2, nullptr);
+    auto elements = globals->GetElements();
+    size_t i = 0;
+    globals_->ForEach([&](uint32_t id, Value value) {
+        elements[i++] = Symbol::FromId(id);
+        elements[i++] = value;
+    });
+    FaslWriter writer(FaslKind::kImage);
+    writer.Add(Value::Fixnum(static_cast<int64_t>(mode_)));
+    writer.Add(globals);
+    WriteFile(path, writer.Finish());
+}
 
-    std::string res = "(";
-    for (size_t i = 0; i + 1 < inner_strings.size(); ++i) {
-        res += inner_strings[i];
-        res += ' ';
+void Scheme::LoadImage(const std::string& path) {
+    FileContents contents(path);
+    RestoreImage(contents.GetView());
+}
+
+void Scheme::RestoreImage(std::string_view image) {
+    // Builtins are taken from the globals before any is redefined.
+    FaslReader reader(image, globals_);
+    auto mode = reader.IsEnd() ? Value{} : reader.Next();
+    if (!mode.IsFixnum()) {
+        throw SyntaxError("malformed image");
+    }
+    if (mode.GetFixnum() != static_cast<int64_t>(mode_)) {
+        throw RuntimeError("the image was saved in another execution mode");
     }
-    if (proper) {
-        res += inner_strings.back();
-    } else {
-        res += ". ";
-        res += inner_strings.back();
+    auto globals = reader.IsEnd() ? Value{} : reader.Next();
+    if (!Is<Vector>(globals) || As<Vector>(globals)->GetElements().size() % 2 != 0) {
+        throw SyntaxError("malformed image");
+    }
+    auto elements = As<Vector>(globals)->GetElements();
+    for (size_t i = 0; i < elements.size(); i += 2) {
+        if (!Is<Symbol>(elements[i])) {
+            throw SyntaxError("malformed image");
+        }
+    }
+    for (size_t i = 0; i < elements.size(); i += 2) {
+        globals_->Define(As<Symbol>(elements[i])->GetId(), elements[i + 1]);
+    }
+    Heap::Instance().CollectAtSafePoint();
+}
+
+void Scheme::SetMaxCallDepth(size_t depth) {
+    max_call_depth_ = depth;
+    if (vm_) {
+        vm_->SetMaxCallDepth(depth);
     }
-    res += ')';
-    return res;
+}
+
+void Scheme::SetPrintLabels(PrintLabels labels) {
+    print_labels_ = labels;
+}
+
+void Scheme::CollectGarbage() {
+    Heap::Instance().Collect();
+}
+
+// Value Scheme::Evaluate(Value arg) {
+//     if (arg.IsFixnum()) {
+//         return arg;
+//     }
+//     throw std::runtime_error("Not implemented");
+
+// }
+
+std::string Scheme::ToString(Value obj) const {
+    std::string result;
+    Print(obj, &result, print_labels_);
+    return result;
 }
@@ -1,19 +1,89 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
 #include <string>
+#include <string_view>
 #include "object.h"
+#include "printer.h"
 #include "scope.h"
 
+class VirtualMachine;
+
+enum class ExecutionMode {
+    // Executes the analyzed tree of every form.
+    kTreeWalker,
+    // Compiles every form to bytecode run by a virtual machine.
+    kBytecode
+};
+
 class Scheme {
-    std::shared_ptr<Scope> scope_;
+    ExecutionMode mode_;
+    Globals* globals_;
+    size_t max_call_depth_;
+    PrintLabels print_labels_ = PrintLabels::kCycles;
+    // Only in bytecode mode.
+    std::unique_ptr<VirtualMachine> vm_;
 
 public:
-    Scheme();
+    explicit Scheme(ExecutionMode mode = ExecutionMode::kTreeWalker);
+    Scheme(const Scheme&) = delete;
+    Scheme& operator=(const Scheme&) = delete;
+    ~Scheme();
 
     std::string Evaluate(const std::string& expression);
+    // Writes the printed result to the stream as it is printed, instead of building it whole.
+    void Evaluate(const std::string& expression, std::ostream* out);
+
+    // Called with the printed result of each form of a program, in order.
+    using ResultCallback = std::function<void(const std::string&)>;
+
+    // Reads and evaluates the forms of a program one at a time, each after the ones before it,
+    // so a form may use what those define. Returns the printed result of the last form, or an
+    // empty string if there is none. An error stops the program at the form that raised it.
+    std::string EvaluateAll(std::string_view program, const ResultCallback& on_result = nullptr);
+    // Reads the stream as the forms need it, so the program is never held whole.
+    std::string EvaluateAll(std::istream* input, const ResultCallback& on_result = nullptr);
+    // Evaluates the program in a file, as text or as a fasl, or restores an image. Throws
+    // RuntimeError if it can't be opened.
+    std::string Load(const std::string& path, const ResultCallback& on_result = nullptr);
+
+    // Reads the forms of a program and writes them as a fasl, which Load evaluates without
+    // parsing text. The forms are stored as read: how they compile depends on the globals of
+    // the Scheme that evaluates them.
+    static void MakeFasl(const std::string& source_path, const std::string& fasl_path);
+
+    // Saves the globals to an image, from which LoadImage defines them again without reading or
+    // evaluating the program that made them. Compiled procedures are saved with their code and
+    // the frames they close over, so a program is saved whole in bytecode mode. Throws
+    // RuntimeError if a global holds what has no image form, such as a closure of the tree
+    // walker, or if the file can't be written.
+    void SaveImage(const std::string& path) const;
+    // Defines the globals saved in an image, by a Scheme of the same mode and of the same build:
+    // the image holds its bytecode as it was compiled. Meant for a Scheme that defines nothing of
+    // its own yet. Load restores an image too.
+    void LoadImage(const std::string& path);
+
+    // Nesting more non-tail calls raises a RuntimeError. The default depends on the mode: the
+    // tree walker recurses on the native stack, the virtual machine keeps its activations on
+    // the heap. The tree walker also raises it before it runs out of native stack.
+    void SetMaxCallDepth(size_t depth);
+
+    // Which structure results print datum labels for. Cycles always get them.
+    void SetPrintLabels(PrintLabels labels);
+
+    void CollectGarbage();
 
 private:
-    // std::shared_ptr<Object> Evaluate(std::shared_ptr<Object> obj);
+    // Value Evaluate(Value obj);
+
+    Value EvaluateForm(Value form);
+    void RestoreImage(std::string_view image);
+    // Reader is a Tokenizer or a FaslReader.
+    template <class Reader>
+    std::string EvaluateForms(Reader* reader, const ResultCallback& on_result);
 
-    static std::string ToString(std::shared_ptr<Object> obj);
+    std::string ToString(Value obj) const;
 };
@@ -1,29 +1,98 @@
 #include "scope.h"
+#include <algorithm>
+#include <new>
 #include "error.h"
+#include "heap.h"
 #include "object.h"
 
-std::shared_ptr<Object> Scope::Get(const std::string& key) const {
-    if (auto it = mapping_.find(key); it != mapping_.end()) {
-        return it->second;
+Frame::Frame(Frame* parent, uint32_t size) : Object(kType), parent_(parent), size_(size) {
+    std::fill_n(GetSlots(), size, Value::Unbound());
+}
+
+Frame* Frame::Create(Frame* parent, uint32_t size) {
+    return Heap::Instance().MakeSized<Frame>(sizeof(Frame) + size * sizeof(Value), parent, size);
+}
+
+FramePool& FramePool::Instance() {
+    thread_local FramePool pool;
+    return pool;
+}
+
+FramePool::FramePool() {
+    Heap::Instance().AddRootSet(this);
+}
+
+FramePool::~FramePool() {
+    Heap::Instance().RemoveRootSet(this);
+}
+
+Frame* FramePool::Acquire(Frame* parent, uint32_t size) {
+    auto bytes = sizeof(Frame) + size * sizeof(Value);
+    while (chunks_.empty() || chunks_[current_].size - chunks_[current_].used < bytes) {
+        if (!chunks_.empty() && chunks_[current_].used != 0) {
+            ++current_;
+        }
+        if (current_ == chunks_.size()) {
+            auto chunk_size = std::max(kChunkSize, bytes);
+            chunks_.push_back({std::make_unique<std::byte[]>(chunk_size), chunk_size, 0});
+        } else if (chunks_[current_].size < bytes) {
+            // Only an empty chunk gets here: one too small for the frame is replaced.
+            chunks_[current_] = {std::make_unique<std::byte[]>(bytes), bytes, 0};
+        }
     }
-    if (parent_ != nullptr) {
-        return parent_->Get(key);
+    auto& chunk = chunks_[current_];
+    auto* frame = new (chunk.memory.get() + chunk.used) Frame(parent, size);
+    chunk.used += bytes;
+    return frame;
+}
+
+void FramePool::Release(Frame* frame) {
+    auto* address = reinterpret_cast<std::byte*>(frame);
+    auto chunk = current_;
+    while (address < chunks_[chunk].memory.get() ||
+           address >= chunks_[chunk].memory.get() + chunks_[chunk].size) {
+        --chunk;
+    }
+    // Frames hold no resources, they are not destroyed.
+    Release(Mark{chunk, static_cast<size_t>(address - chunks_[chunk].memory.get())});
+}
+
+void FramePool::Trace(Heap& heap) const {
+    // The frames of a chunk lie one after another up to what is used of it.
+    for (size_t i = 0; i < chunks_.size() && i <= current_; ++i) {
+        const auto* memory = chunks_[i].memory.get();
+        for (size_t offset = 0; offset < chunks_[i].used;) {
+            const auto* frame = reinterpret_cast<const Frame*>(memory + offset);
+            frame->Trace(heap);
+            offset += sizeof(Frame) + frame->GetSize() * sizeof(Value);
+        }
+    }
+}
+
+void Frame::Trace(Heap& heap) const {
+    heap.Mark(parent_);
+    for (uint32_t i = 0; i < size_; ++i) {
+        heap.Mark(GetSlots()[i]);
+    }
+}
+
+Value Globals::Get(uint32_t id) const {
+    auto value = Find(id);
+    if (value.IsUnbound()) {
+        throw NameError(Symbol::FromId(id)->GetName());
+    }
+    return value;
+}
+
+void Globals::Define(uint32_t id, Value value) {
+    if (id >= values_.size()) {
+        values_.resize(id + 1, Value::Unbound());
+    }
+    values_[id] = value;
+}
+
+void Globals::Trace(Heap& heap) const {
+    for (auto value : values_) {
+        heap.Mark(value);
     }
-    throw NameError(key);
-}
-
-// void Scope::Define(const std::string& key, std::shared_ptr<Object> value) {
-//     mapping_[key] = value;
-// }
-
-void Scope::Set(const std::string& key, std::shared_ptr<Object> value) {
-    // if (mapping_.contains(key)) {
-    //     mapping_[key] = value;
-    // }
-    // if (parent_) {
-    //     parent_->Set(key, value);
-    // } else {
-    //     throw RuntimeError("No such key: " + key);
-    // }
-    mapping_[key] = value;
 }
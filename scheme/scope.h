@@ -1,29 +1,156 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <string>
-#include <unordered_map>
+#include <vector>
 #include "error.h"
+#include "heap.h"
 #include "object.h"
 
-class Scope {
+// Activation record of a procedure call: a flat array of variable slots addressed by
+// index, stored right after the object.
+class Frame : public Object {
 public:
-    Scope() = default;
-    Scope(const std::unordered_map<std::string, std::shared_ptr<Object>>& mapping)
-        : mapping_(mapping) {
+    static constexpr ObjectType kType = ObjectType::kFrame;
+
+    // Every slot starts unbound.
+    static Frame* Create(Frame* parent, uint32_t size);
+
+    Frame* GetParent() const {
+        return parent_;
+    }
+
+    uint32_t GetSize() const {
+        return size_;
+    }
+
+    Value* GetSlots() {
+        return reinterpret_cast<Value*>(this + 1);
     }
 
-    Scope(std::unordered_map<std::string, std::shared_ptr<Object>>&& mapping)
-        : mapping_(std::move(mapping)) {
+    const Value* GetSlots() const {
+        return reinterpret_cast<const Value*>(this + 1);
     }
 
-    Scope(std::shared_ptr<Scope> parent) : parent_(parent) {
+    void Trace(Heap& heap) const override;
+
+private:
+    friend class Heap;
+    friend class FramePool;
+    // Reads the frames of an image before their parents.
+    friend class FaslReader;
+
+    Frame(Frame* parent, uint32_t size);
+
+    Frame* parent_;
+    uint32_t size_;
+};
+
+// Frames no closure can capture, which die with their call. They are released in the
+// reverse order they are acquired, so their memory is reused like a stack. Nothing on the heap
+// points to them, they aren't heap objects: the pool is a root set, marking what every frame
+// acquired holds.
+class FramePool : public RootSet {
+public:
+    // Position of the top of the pool.
+    struct Mark {
+        size_t chunk;
+        size_t used;
+    };
+
+    // Releases the frames acquired since it was created when it goes out of scope.
+    class Scope {
+    public:
+        explicit Scope(FramePool& pool) : pool_(pool), mark_(pool.GetMark()) {
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope() {
+            Release();
+        }
+
+        void Release() {
+            pool_.Release(mark_);
+        }
+
+    private:
+        FramePool& pool_;
+        Mark mark_;
+    };
+
+    static FramePool& Instance();
+
+    FramePool();
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+    ~FramePool();
+
+    // Every slot starts unbound.
+    Frame* Acquire(Frame* parent, uint32_t size);
+
+    Mark GetMark() const {
+        return {current_, chunks_.empty() ? 0 : chunks_[current_].used};
+    }
+
+    // Releases every frame acquired after mark was taken.
+    void Release(Mark mark) {
+        if (!chunks_.empty()) {
+            for (auto i = mark.chunk + 1; i <= current_; ++i) {
+                chunks_[i].used = 0;
+            }
+            current_ = mark.chunk;
+            chunks_[current_].used = mark.used;
+        }
+    }
+
+    // Releases frame and every frame acquired after it.
+    void Release(Frame* frame);
+
+    void Trace(Heap& heap) const override;
+
+private:
+    static constexpr size_t kChunkSize = 1 << 16;
+
+    struct Chunk {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+        size_t used;
+    };
+
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;
+};
+
+// Global variables in a table indexed by symbol id.
+class Globals : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kGlobals;
+
+    Globals() : Object(kType) {
+    }
+
+    // Returns an unbound value for an undefined variable.
+    Value Find(uint32_t id) const {
+        return id < values_.size() ? values_[id] : Value::Unbound();
+    }
+
+    Value Get(uint32_t id) const;
+    void Define(uint32_t id, Value value);
+
+    // Calls f(id, value) for every defined variable, in order of id.
+    template <class F>
+    void ForEach(F&& f) const {
+        for (uint32_t id = 0; id < values_.size(); ++id) {
+            if (!values_[id].IsUnbound()) {
+                f(id, values_[id]);
+            }
+        }
     }
 
-    std::shared_ptr<Object> Get(const std::string& key) const;
-    void Set(const std::string& key, std::shared_ptr<Object> value);
+    void Trace(Heap& heap) const override;
 
 private:
-    std::shared_ptr<Scope> parent_;
-    std::unordered_map<std::string, std::shared_ptr<Object>> mapping_;
+    std::vector<Value> values_;
 };
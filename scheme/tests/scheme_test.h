@@ -3,10 +3,20 @@
 #include "scheme.h"
 #include "error.h"
 
+#include <istream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
+// The suite is built twice, once per execution mode.
+#ifdef SCHEME_TEST_BYTECODE
+inline constexpr ExecutionMode kTestExecutionMode = ExecutionMode::kBytecode;
+#else
+inline constexpr ExecutionMode kTestExecutionMode = ExecutionMode::kTreeWalker;
+#endif
+
 class SchemeTest {
 public:
     void ExpectEq(const std::string& expression, const std::string& expected) {
@@ -29,6 +39,52 @@ public:
         REQUIRE_THROWS_AS(scheme_.Evaluate(expression), NameError);
     }
 
+    // The printed results of the forms of a program.
+    std::vector<std::string> EvaluateAll(const std::string& program) {
+        std::vector<std::string> results;
+        scheme_.EvaluateAll(program, Collect(&results));
+        return results;
+    }
+
+    std::vector<std::string> EvaluateAll(std::istream* input) {
+        std::vector<std::string> results;
+        scheme_.EvaluateAll(input, Collect(&results));
+        return results;
+    }
+
+    std::vector<std::string> Load(const std::string& path) {
+        std::vector<std::string> results;
+        scheme_.Load(path, Collect(&results));
+        return results;
+    }
+
+    // The printed result, as written to a stream.
+    std::string EvaluateToStream(const std::string& expression) {
+        std::ostringstream out;
+        scheme_.Evaluate(expression, &out);
+        return out.str();
+    }
+
+    void SetPrintLabels(PrintLabels labels) {
+        scheme_.SetPrintLabels(labels);
+    }
+
+    void SaveImage(const std::string& path) {
+        scheme_.SaveImage(path);
+    }
+
+    void CollectGarbage() {
+        scheme_.CollectGarbage();
+    }
+
+    void SetMaxCallDepth(size_t depth) {
+        scheme_.SetMaxCallDepth(depth);
+    }
+
 private:
-    Scheme scheme_;
+    static Scheme::ResultCallback Collect(std::vector<std::string>* results) {
+        return [results](const std::string& result) { results->push_back(result); };
+    }
+
+    Scheme scheme_{kTestExecutionMode};
 };
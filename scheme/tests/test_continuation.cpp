@@ -0,0 +1,95 @@
+#include "tests/scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "ContinuationEscapes") {
+    ExpectEq("(call/cc (lambda (k) 5))", "5");
+    ExpectEq("(call/cc (lambda (k) (+ 1 (k 42))))", "42");
+    ExpectEq("(+ 1 (call-with-current-continuation (lambda (k) (* 10 (k 2)))))", "3");
+    ExpectEq("(call/ec (lambda (k) (+ 1 (k 42))))", "42");
+    ExpectEq("(call-with-escape-continuation (lambda (k) 7))", "7");
+
+    ExpectNoError(R"EOF(
+        (define (find-first pred l)
+          (call/cc
+            (lambda (return)
+              (define (loop l)
+                (if (null? l)
+                    #f
+                    (begin
+                      (if (pred (car l)) (return (car l)))
+                      (loop (cdr l)))))
+              (loop l))))
+                    )EOF");
+    ExpectEq("(find-first (lambda (x) (> x 2)) '(1 2 3 4))", "3");
+    ExpectEq("(find-first (lambda (x) (> x 5)) '(1 2 3 4))", "#f");
+}
+
+TEST_CASE_METHOD(SchemeTest, "NestedContinuations") {
+    ExpectEq("(call/ec (lambda (outer) (+ 1 (call/ec (lambda (inner) (outer 10))))))", "10");
+    ExpectEq("(call/ec (lambda (outer) (+ 1 (call/ec (lambda (inner) (inner 10))))))", "11");
+    ExpectEq("(call/cc (lambda (outer) (+ 1 (call/cc (lambda (inner) (outer 10))))))", "10");
+
+    // Escaping from deep non-tail recursion.
+    ExpectNoError(R"EOF(
+        (define (product l k)
+          (if (null? l)
+              1
+              (if (= (car l) 0) (k 0) (* (car l) (product (cdr l) k)))))
+                    )EOF");
+    ExpectEq("(call/ec (lambda (k) (product '(1 2 3 4) k)))", "24");
+    ExpectEq("(call/ec (lambda (k) (product '(1 2 0 4) k)))", "0");
+    ExpectEq("(+ (call/cc (lambda (k) (product '(5 0) k))) (product '(2 3) 0))", "6");
+}
+
+TEST_CASE_METHOD(SchemeTest, "ContinuationErrors") {
+    ExpectRuntimeError("(call/cc 1)");
+    ExpectRuntimeError("(call/cc (lambda () 1))");
+    ExpectRuntimeError("(call/cc (lambda (k) (k 1 2)))");
+    ExpectRuntimeError("(call/ec)");
+
+    // Escape-only continuations are dead once call/ec returns.
+    ExpectNoError("(define k (call/ec (lambda (k) k)))");
+    ExpectRuntimeError("(k 1)");
+    ExpectEq("(call/ec (lambda (k) 1))", "1");
+}
+
+TEST_CASE_METHOD(SchemeTest, "ReenteredContinuations") {
+    ExpectNoError("(define k #f)");
+    ExpectNoError("(define (grab c) (set! k c) 0)");
+    if (kTestExecutionMode == ExecutionMode::kTreeWalker) {
+        // The tree walker only escapes.
+        ExpectEq("(+ 100 (call/cc grab))", "100");
+        ExpectRuntimeError("(k 10)");
+        return;
+    }
+
+    ExpectEq("(+ 100 (call/cc grab))", "100");
+    ExpectEq("(k 10)", "110");
+    ExpectEq("(k 20)", "120");
+
+    ExpectNoError("(define n 0)");
+    ExpectNoError(R"EOF(
+        (define (count-to a)
+          (define x (call/cc grab))
+          (set! n (+ n a))
+          (if (< x 3) (k (+ x 1)) n))
+                    )EOF");
+    ExpectEq("(count-to 5)", "20");
+    ExpectEq("(list (count-to 1) (count-to 1))", "(24 28)");
+
+    // A generator walking a list: each call resumes the walk where it stopped.
+    ExpectNoError("(define return #f)");
+    ExpectNoError("(define resume #f)");
+    ExpectNoError(R"EOF(
+        (define (walk l)
+          (if (null? l)
+              (return 'done)
+              (begin
+                (call/cc (lambda (c) (set! resume c) (return (car l))))
+                (walk (cdr l)))))
+                    )EOF");
+    ExpectNoError("(define (next) (call/cc (lambda (r) (set! return r) (resume #f))))");
+    ExpectEq("(call/cc (lambda (r) (set! return r) (walk '(1 2 3))))", "1");
+    ExpectEq("(next)", "2");
+    ExpectEq("(next)", "3");
+    ExpectEq("(next)", "done");
+}
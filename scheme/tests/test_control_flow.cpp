@@ -25,3 +25,29 @@ TEST_CASE_METHOD(SchemeTest, "IfSyntaxError") {
     ExpectSyntaxError("(if)");
     ExpectSyntaxError("(if 1 2 3 4)");
 }
+
+TEST_CASE_METHOD(SchemeTest, "Begin") {
+    ExpectNoError("(define x 1)");
+    ExpectEq("(begin (set! x 2) (+ x 1))", "3");
+    ExpectEq("x", "2");
+    ExpectEq("(begin 5)", "5");
+    ExpectSyntaxError("(begin)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "TailCallsDoNotGrowTheStack") {
+    ExpectNoError("(define (count n) (if (= n 0) 'done (count (- n 1))))");
+    ExpectEq("(count 100000)", "done");
+
+    ExpectNoError(R"EOF(
+        (define (loop n acc)
+          (begin
+            (set! acc (+ acc 1))
+            (or (and (= n 0) acc)
+                (loop (- n 1) acc))))
+                    )EOF");
+    ExpectEq("(loop 100000 0)", "100001");
+
+    ExpectNoError("(define (ping n) (if (= n 0) 'ping (pong (- n 1))))");
+    ExpectNoError("(define (pong n) (if (= n 0) 'pong (ping (- n 1))))");
+    ExpectEq("(ping 100001)", "pong");
+}
@@ -0,0 +1,117 @@
+#include "tests/scheme_test.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+std::string TempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+}  // namespace
+
+TEST_CASE_METHOD(SchemeTest, "FaslRoundTrip") {
+    auto path = TempPath("scheme-test-data.fasl");
+    auto write = "(write-fasl \"" + path + "\" datum)";
+    auto read = "(define copy (read-fasl \"" + path + "\"))";
+
+    ExpectNoError(
+        "(define datum (list 1 -2 4611686018427387903 (* 10000000000 10000000000) "
+        "(- 0 (* 10000000000 10000000000)) 1.5 -0.0 #t #f '() 'symbol \"text\" \"\" "
+        "'(a . b) #(1 #(2) \"x\") (s64vector 1 -9223372036854775808) (f64vector 0.5 -1e300)))");
+    ExpectEq(write, "()");
+    ExpectNoError(read);
+    ExpectEq("(equal? copy datum)", "#t");
+    ExpectEq("(eq? copy datum)", "#f");
+    ExpectEq("(list-ref copy 10)", "symbol");
+    ExpectEq("(eq? (list-ref copy 10) 'symbol)", "#t");
+    ExpectEq("(list-ref copy 14)", "#(1 #(2) \"x\")");
+
+    // A long list: neither end recurses per element.
+    ExpectNoError("(define (build n acc) (if (= n 0) acc (build (- n 1) (cons n acc))))");
+    ExpectNoError("(define datum (build 200000 '()))");
+    ExpectEq(write, "()");
+    ExpectNoError(read);
+    ExpectEq("(equal? copy datum)", "#t");
+    ExpectEq("(list-ref copy 199999)", "200000");
+    std::filesystem::remove(path);
+}
+
+TEST_CASE_METHOD(SchemeTest, "FaslSharedStructure") {
+    auto path = TempPath("scheme-test-shared.fasl");
+    auto write = "(write-fasl \"" + path + "\" datum)";
+    auto read = "(define copy (read-fasl \"" + path + "\"))";
+
+    ExpectNoError("(define shared (list 1 2))");
+    ExpectNoError("(define datum (vector shared shared \"s\" (cons 'x shared)))");
+    ExpectEq(write, "()");
+    ExpectNoError(read);
+    ExpectEq("copy", "#((1 2) (1 2) \"s\" (x 1 2))");
+    ExpectEq("(eq? (vector-ref copy 0) (vector-ref copy 1))", "#t");
+    ExpectEq("(eq? (vector-ref copy 0) (cdr (vector-ref copy 3)))", "#t");
+
+    // Cycles are written once too.
+    ExpectNoError("(define datum (list 1 2 3))");
+    ExpectNoError("(set-cdr! (cdr (cdr datum)) datum)");
+    ExpectEq(write, "()");
+    ExpectNoError(read);
+    ExpectEq("(list-ref copy 5)", "3");
+    ExpectEq("(eq? (cdr (cdr (cdr copy))) copy)", "#t");
+    ExpectEq("(eq? copy datum)", "#f");
+    ExpectNoError("(define datum (vector 1 2))");
+    ExpectNoError("(vector-set! datum 1 datum)");
+    ExpectEq(write, "()");
+    ExpectNoError(read);
+    ExpectEq("(eq? (vector-ref copy 1) copy)", "#t");
+    std::filesystem::remove(path);
+}
+
+TEST_CASE_METHOD(SchemeTest, "FaslErrors") {
+    auto path = TempPath("scheme-test-errors.fasl");
+    ExpectRuntimeError("(write-fasl \"" + path + "\" car)");
+    ExpectRuntimeError("(write-fasl \"" + path + "\" (list 1 (lambda (x) x)))");
+    ExpectRuntimeError("(write-fasl \"" + path + "\" (make-hash-table))");
+    ExpectRuntimeError("(write-fasl 'path 1)");
+    ExpectRuntimeError("(read-fasl \"" + path + "\")");
+
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "(not a fasl)";
+    }
+    ExpectSyntaxError("(read-fasl \"" + path + "\")");
+
+    // Cut short anywhere, a fasl is malformed rather than read past its end.
+    ExpectNoError("(write-fasl \"" + path + "\" '(a (b #(c \"text\" 1.5)) . 7))");
+    std::string fasl;
+    {
+        std::ifstream file(path, std::ios::binary);
+        fasl.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+    for (size_t size = 8; size < fasl.size(); ++size) {
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(fasl.data(), size);
+        }
+        ExpectSyntaxError("(read-fasl \"" + path + "\")");
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE_METHOD(SchemeTest, "FaslPrograms") {
+    auto source = TempPath("scheme-test-program.scm");
+    auto fasl = TempPath("scheme-test-program.fasl");
+    {
+        std::ofstream file(source);
+        file << "(define table (make-hash-table))\n"
+                "(define (add key value) (hash-table-set! table key value))\n"
+                "(add 'rule '(allow \"/api\" 3))\n"
+                "(hash-table-ref table 'rule)\n";
+    }
+    Scheme::MakeFasl(source, fasl);
+    REQUIRE(Load(fasl) == std::vector<std::string>{"table", "add", "()", "(allow \"/api\" 3)"});
+    ExpectEq("(hash-table-count table)", "1");
+    std::filesystem::remove(source);
+    std::filesystem::remove(fasl);
+}
@@ -0,0 +1,96 @@
+#include "tests/scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "FlonumsAreSelfEvaluating") {
+    ExpectEq("1.5", "1.5");
+    ExpectEq("-0.25", "-0.25");
+    ExpectEq("2.", "2.0");
+    ExpectEq(".5", "0.5");
+    ExpectEq("1e3", "1000.0");
+    ExpectEq("1.5e-3", "0.0015");
+    ExpectEq("1e300", "1e300");
+    ExpectEq("(number? 1.5)", "#t");
+}
+
+TEST_CASE_METHOD(SchemeTest, "FlonumsReadBackAsPrinted") {
+    ExpectEq("-.5", "-0.5");
+    ExpectEq("+.5", "0.5");
+    ExpectEq("'(-.25 . +.75)", "(-0.25 . 0.75)");
+    ExpectEq("1e5", "1e5");
+    ExpectEq("1e3", "1000.0");
+    ExpectEq("1e21", "1e21");
+    ExpectEq("(* 1e10 1e11)", "1e21");
+    ExpectEq("1.5e-7", "1.5e-7");
+    ExpectEq("-1e-300", "-1e-300");
+    ExpectEq("+inf.0", "+inf.0");
+    ExpectEq("-inf.0", "-inf.0");
+    ExpectEq("+nan.0", "+nan.0");
+    ExpectEq("-nan.0", "+nan.0");
+    ExpectEq("(- +inf.0)", "-inf.0");
+    ExpectEq("(= +inf.0 (/ 1.0 0.0))", "#t");
+    ExpectEq("(eqv? -inf.0 (/ -1.0 0.0))", "#t");
+    ExpectEq("'(+inf.0 -inf.0 +nan.0)", "(+inf.0 -inf.0 +nan.0)");
+    ExpectEq("(f64vector 1e21 -.5 +inf.0)", "#f64(1e21 -0.5 +inf.0)");
+    ExpectNameError("(list +infinity)");
+
+    // What is printed reads back as the same number.
+    for (auto text : {"1e21", "1.5e-7", "-0.5", "0.1", "1.7976931348623157e308", "5e-324",
+                      "-inf.0", "123456789.125"}) {
+        ExpectEq(text, text);
+        ExpectEq(std::string("(number->string ") + text + ")", std::string("\"") + text + "\"");
+    }
+}
+
+TEST_CASE_METHOD(SchemeTest, "FlonumArithmetics") {
+    ExpectEq("(+ 0.5 0.25)", "0.75");
+    ExpectEq("(+ 1 0.5)", "1.5");
+    ExpectEq("(+ 0.5 1)", "1.5");
+    ExpectEq("(- 1.5)", "-1.5");
+    ExpectEq("(- 3 0.5 0.5)", "2.0");
+    ExpectEq("(* 1.5 2)", "3.0");
+    ExpectEq("(* 0.5 0.5 0.5 0.5 0.5)", "0.03125");
+    ExpectEq("(/ 1.0 4)", "0.25");
+    ExpectEq("(/ 1 4.0)", "0.25");
+    ExpectEq("(/ 7 2)", "3");
+    ExpectEq("(/ 1.0 0.0)", "+inf.0");
+    ExpectEq("(/ -1.0 0.0)", "-inf.0");
+    ExpectRuntimeError("(/ 1.0 0)");
+    ExpectEq("(abs -2.5)", "2.5");
+    ExpectEq("(+ 1.5 (* 9223372036854775807 2))", "18446744073709551616.0");
+}
+
+TEST_CASE_METHOD(SchemeTest, "FlonumVariadicReductions") {
+    ExpectEq("(+ 0.5 0.5 0.5 0.5 0.5 0.5 0.5 0.5 0.5 0.5 0.5)", "5.5");
+    ExpectEq("(+ -0.0 -0.0)", "-0.0");
+    ExpectEq("(* 2.0 2.0 2.0 2.0 2.0 2.0 2.0 2.0 2.0)", "512.0");
+    ExpectEq("(min 3.5 1.5 2.5 -4.5 0.5 7.5)", "-4.5");
+    ExpectEq("(max 3.5 1.5 2.5 -4.5 0.5 7.5)", "7.5");
+    ExpectEq("(max 1.0 (/ 0.0 0.0) 2.0 3.0 4.0)", "+nan.0");
+}
+
+TEST_CASE_METHOD(SchemeTest, "FlonumComparison") {
+    ExpectEq("(< 1 1.5 2)", "#t");
+    ExpectEq("(= 1 1.0)", "#t");
+    ExpectEq("(> 2.5 2)", "#t");
+    ExpectEq("(<= 2.5 2.5 3)", "#t");
+    ExpectEq("(>= 2.5 3)", "#f");
+    ExpectEq("(= (/ 0.0 0.0) (/ 0.0 0.0))", "#f");
+    ExpectEq("(< (/ 0.0 0.0) 1.0)", "#f");
+}
+
+TEST_CASE_METHOD(SchemeTest, "MinMaxContagion") {
+    ExpectEq("(max 1 2.0)", "2.0");
+    ExpectEq("(max 3 2.0)", "3.0");
+    ExpectEq("(min 1 2.0)", "1.0");
+    ExpectEq("(min 1 2)", "1");
+}
+
+TEST_CASE_METHOD(SchemeTest, "MinMaxPropagateNan") {
+    ExpectEq("(min 1.0 +nan.0)", "+nan.0");
+    ExpectEq("(min 1 +nan.0)", "+nan.0");
+    ExpectEq("(min +nan.0 1)", "+nan.0");
+    ExpectEq("(max 1 +nan.0)", "+nan.0");
+    ExpectEq("(max +nan.0 1)", "+nan.0");
+    ExpectEq("(max 1 2 +nan.0 3)", "+nan.0");
+    ExpectEq("(min +nan.0)", "+nan.0");
+    ExpectEq("(min (* 10000000000 10000000000) +nan.0)", "+nan.0");
+}
@@ -0,0 +1,64 @@
+#include "tests/scheme_test.h"
+#include "heap.h"
+
+TEST_CASE_METHOD(SchemeTest, "CollectorReclaimsClosureCycles") {
+    // Every closure returned by make-cycle refers to itself through its scope.
+    ExpectNoError("(define (make-cycle) (define (self) self) self)");
+
+    auto make_cycles = [this] {
+        for (int i = 0; i < 100; ++i) {
+            ExpectNoError("(define cycle (make-cycle))");
+            ExpectEq("(symbol? ((cycle)))", "#f");
+        }
+        CollectGarbage();
+        return Heap::Instance().GetObjectCount();
+    };
+
+    auto live = make_cycles();
+    REQUIRE(make_cycles() == live);
+    REQUIRE(make_cycles() == live);
+}
+
+TEST_CASE_METHOD(SchemeTest, "CollectorKeepsReachableData") {
+    ExpectNoError("(define x '(1 2 (3 4) . 5))");
+    ExpectNoError("(define (f y) (cons y x))");
+    CollectGarbage();
+    ExpectEq("x", "(1 2 (3 4) . 5)");
+    ExpectEq("(f 0)", "(0 1 2 (3 4) . 5)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "GcBuiltin") {
+    ExpectEq("(gc)", "()");
+    ExpectRuntimeError("(gc 1)");
+
+    // Too few objects for a collection to be due: only (gc) frees the first list before the
+    // second is built, in the same form.
+    constexpr size_t kLength = 50'000;
+    ExpectNoError("(define (build n acc) (if (= n 0) acc (build (- n 1) (cons n acc))))");
+    ExpectNoError("(define junk (build " + std::to_string(kLength) + " '()))");
+    CollectGarbage();
+    auto& heap = Heap::Instance();
+    auto live = heap.GetObjectCount();
+    heap.ResetPeakObjectCount();
+    ExpectEq("(begin (set! junk #f) (gc) (set! junk (build " + std::to_string(kLength) +
+                 " '())) (car junk))",
+             "1");
+    REQUIRE(heap.GetPeakObjectCount() < live + kLength / 2);
+}
+
+TEST_CASE_METHOD(SchemeTest, "CollectorRunsDuringLongForms") {
+    ExpectNoError("(define (loop n acc) (if (= n 0) acc (loop (- n 1) (cons n n))))");
+    ExpectNoError("(define (count-down n) (if (= n 0) '() (cons n (count-down (- n 1)))))");
+    CollectGarbage();
+    auto& heap = Heap::Instance();
+    heap.ResetPeakObjectCount();
+    ExpectEq("(loop 3000000 0)", "(1 . 1)");
+    REQUIRE(heap.GetPeakObjectCount() < 500'000);
+
+    // What the calls in progress hold survives the collections made during them.
+    ExpectEq("(car (count-down 2000))", "2000");
+    ExpectNoError("(define (sum a b c) (+ (list-ref a 999) (cdr b) (car c)))");
+    ExpectEq("(sum (count-down 1000) (loop 200000 0) (count-down 5))", "7");
+    ExpectEq("((lambda (x) (loop 200000 0) x) (count-down 3))", "(3 2 1)");
+    ExpectEq("(call/cc (lambda (k) (loop 200000 0) (k '(1 2))))", "(1 2)");
+}
@@ -0,0 +1,141 @@
+#include "tests/scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "Equivalence") {
+    ExpectEq("(eq? 'a 'a)", "#t");
+    ExpectEq("(eq? 1 1)", "#t");
+    ExpectEq("(eq? '(1) '(1))", "#f");
+    ExpectEq("(eq? '() '())", "#t");
+    ExpectNoError("(define big (* 10000000000 10000000000))");
+    ExpectEq("(eqv? big (* 10000000000 10000000000))", "#t");
+    ExpectEq("(eq? big (* 10000000000 10000000000))", "#f");
+    ExpectEq("(eqv? 1.5 1.5)", "#t");
+    ExpectEq("(eqv? 1 1.0)", "#f");
+    ExpectEq("(eqv? 0.0 -0.0)", "#f");
+    ExpectEq("(eqv? '(1) '(1))", "#f");
+    ExpectEq("(equal? '(1 (2 #(3 x)) . 4) '(1 (2 #(3 x)) . 4))", "#t");
+    ExpectEq("(equal? '(1 2) '(1 2 3))", "#f");
+    ExpectEq("(equal? #(1 2) #(1 2.0))", "#f");
+    ExpectEq("(equal? (s64vector 1 2) (s64vector 1 2))", "#t");
+    ExpectEq("(equal? (s64vector 1 2) (f64vector 1 2))", "#f");
+    ExpectRuntimeError("(eq? 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "EqualOnCycles") {
+    ExpectNoError("(define (last-pair l) (if (null? (cdr l)) l (last-pair (cdr l))))");
+    ExpectNoError("(define (make-cycle l) (set-cdr! (last-pair l) l) l)");
+    ExpectNoError("(define (zeros n tail) (if (= n 0) tail (zeros (- n 1) (cons 0 tail))))");
+
+    ExpectNoError("(define a (make-cycle (list 1 2 3)))");
+    ExpectEq("(equal? a a)", "#t");
+    ExpectEq("(equal? a (make-cycle (list 1 2 3)))", "#t");
+    ExpectEq("(equal? a (make-cycle (list 1 2 3 1 2 3)))", "#t");
+    ExpectEq("(equal? a (make-cycle (list 1 2 4)))", "#f");
+    ExpectEq("(equal? a (list 1 2 3))", "#f");
+    ExpectEq("(equal? (vector a) (vector (make-cycle (list 1 2 3))))", "#t");
+
+    // The difference is past the compares made before cycles are looked for.
+    ExpectNoError("(define b (make-cycle (zeros 2000 (list 1))))");
+    ExpectEq("(equal? b (make-cycle (zeros 2000 (list 1))))", "#t");
+    ExpectEq("(equal? b (make-cycle (zeros 2000 (list 2))))", "#f");
+    ExpectEq("(equal? b (make-cycle (zeros 1999 (list 1))))", "#f");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HashTableBasics") {
+    ExpectNoError("(define t (make-hash-table))");
+    ExpectEq("(hash-table? t)", "#t");
+    ExpectEq("(hash-table? '())", "#f");
+    ExpectEq("(hash-table-count t)", "0");
+    ExpectNoError("(hash-table-set! t 'a 1)");
+    ExpectNoError("(hash-table-set! t 'b 2)");
+    ExpectNoError("(hash-table-set! t 'a 3)");
+    ExpectEq("(hash-table-count t)", "2");
+    ExpectEq("(hash-table-ref t 'a)", "3");
+    ExpectEq("(hash-table-ref/default t 'c 'none)", "none");
+    ExpectEq("(hash-table-contains? t 'b)", "#t");
+    ExpectNoError("(hash-table-delete! t 'b)");
+    ExpectNoError("(hash-table-delete! t 'b)");
+    ExpectEq("(hash-table-contains? t 'b)", "#f");
+    ExpectEq("(hash-table->alist t)", "((a . 3))");
+    ExpectEq("(hash-table-keys t)", "(a)");
+    ExpectEq("(hash-table-values t)", "(3)");
+    ExpectEq("t", "#<hash-table>");
+
+    ExpectRuntimeError("(hash-table-ref t 'b)");
+    ExpectRuntimeError("(hash-table-ref '() 'a)");
+    ExpectRuntimeError("(hash-table-set! t 'a)");
+    ExpectRuntimeError("(make-hash-table =)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HashTableEquivalences") {
+    ExpectNoError("(define k '(1 2))");
+    ExpectNoError("(define e (make-hash-table eq?))");
+    ExpectNoError("(hash-table-set! e k 'list)");
+    ExpectEq("(hash-table-ref/default e k #f)", "list");
+    ExpectEq("(hash-table-ref/default e '(1 2) #f)", "#f");
+
+    ExpectNoError("(define v (make-hash-table eqv?))");
+    ExpectNoError("(hash-table-set! v (* 10000000000 10000000000) 'big)");
+    ExpectNoError("(hash-table-set! v 2.5 'flonum)");
+    ExpectEq("(hash-table-ref v (* 10000000000 10000000000))", "big");
+    ExpectEq("(hash-table-ref v (/ 5.0 2))", "flonum");
+    ExpectEq("(hash-table-ref/default v '(1 2) #f)", "#f");
+
+    ExpectNoError("(define q (make-hash-table equal?))");
+    ExpectNoError("(hash-table-set! q k 'list)");
+    ExpectNoError("(hash-table-set! q #(1 (2 3)) 'vector)");
+    ExpectEq("(hash-table-ref q (list 1 2))", "list");
+    ExpectEq("(hash-table-ref q (vector 1 (list 2 3)))", "vector");
+    ExpectEq("(hash-table-ref/default q '(1 2 3) #f)", "#f");
+
+    ExpectNoError("(define renamed eqv?)");
+    ExpectNoError("(define r (make-hash-table renamed))");
+    ExpectNoError("(hash-table-set! r 2.5 'flonum)");
+    ExpectEq("(hash-table-ref r (/ 5.0 2))", "flonum");
+    ExpectRuntimeError("(make-hash-table (lambda (a b) (eqv? a b)))");
+    ExpectRuntimeError("(make-hash-table 'eqv?)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HashTableLargeKeys") {
+    // Keys that differ only past the prefix that is hashed still find their own entries.
+    ExpectNoError("(define q (make-hash-table equal?))");
+    ExpectNoError("(define a (make-vector 100000 0))");
+    ExpectNoError("(define b (make-vector 100000 0))");
+    ExpectNoError("(vector-set! b 99999 1)");
+    ExpectNoError("(hash-table-set! q a 'a)");
+    ExpectNoError("(hash-table-set! q b 'b)");
+    ExpectEq("(hash-table-ref q (make-vector 100000 0))", "a");
+    ExpectEq("(hash-table-ref q b)", "b");
+
+    ExpectNoError("(define (double s n) (if (= n 0) s (double (string-append s s) (- n 1))))");
+    ExpectNoError("(define s (double \"a\" 17))");
+    ExpectNoError("(hash-table-set! q s 'string)");
+    ExpectEq("(hash-table-ref q (string-append s \"\"))", "string");
+    ExpectEq("(hash-table-ref/default q (string-append s \"b\") #f)", "#f");
+
+    ExpectNoError("(define n (make-s64vector 100000 7))");
+    ExpectNoError("(hash-table-set! q n 's64)");
+    ExpectEq("(hash-table-ref q (make-s64vector 100000 7))", "s64");
+    ExpectEq("(hash-table-ref/default q (make-s64vector 99999 7) #f)", "#f");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HashTableGrowsAndShrinks") {
+    ExpectNoError("(define t (make-hash-table))");
+    ExpectNoError(
+        "(define (fill i n) (if (< i n) (begin (hash-table-set! t (list i) (* i i)) "
+        "(fill (+ i 1) n))))");
+    ExpectNoError(
+        "(define (drop i n) (if (< i n) (begin (hash-table-delete! t (list i)) "
+        "(drop (+ i 2) n))))");
+    ExpectNoError(
+        "(define (check i n) (if (< i n) (if (= (hash-table-ref/default t (list i) -1) "
+        "(if (= (- i (* (/ i 2) 2)) 0) -1 (* i i))) (check (+ i 1) n) i) #t))");
+    ExpectNoError("(fill 0 5000)");
+    ExpectEq("(hash-table-count t)", "5000");
+    ExpectNoError("(drop 0 5000)");
+    ExpectEq("(hash-table-count t)", "2500");
+    ExpectEq("(check 0 5000)", "#t");
+    CollectGarbage();
+    ExpectEq("(check 0 5000)", "#t");
+    ExpectNoError("(fill 0 5000)");
+    ExpectEq("(hash-table-count t)", "5000");
+}
@@ -0,0 +1,176 @@
+#include "tests/scheme_test.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+std::string TempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+}  // namespace
+
+TEST_CASE_METHOD(SchemeTest, "ImageData") {
+    auto path = TempPath("scheme-test-data.image");
+    ExpectNoError("(define shared (list 1 2))");
+    ExpectNoError("(define pair (cons shared shared))");
+    ExpectNoError("(define big (* 10000000000 10000000000))");
+    ExpectNoError("(define text \"text\")");
+    ExpectNoError("(define numbers (s64vector 1 -2 3))");
+    ExpectNoError("(define table (make-hash-table))");
+    ExpectNoError("(hash-table-set! table '(key 1) #(value))");
+    ExpectNoError("(hash-table-set! table \"name\" 'x)");
+    ExpectNoError("(define symbols (make-hash-table eq?))");
+    ExpectNoError("(hash-table-set! symbols 'a shared)");
+    ExpectNoError("(define first car)");
+    SaveImage(path);
+
+    Scheme restored{kTestExecutionMode};
+    restored.LoadImage(path);
+    REQUIRE(restored.Evaluate("pair") == "((1 2) 1 2)");
+    REQUIRE(restored.Evaluate("(eq? (car pair) shared)") == "#t");
+    REQUIRE(restored.Evaluate("(eq? (car pair) (cdr pair))") == "#t");
+    REQUIRE(restored.Evaluate("big") == "100000000000000000000");
+    REQUIRE(restored.Evaluate("text") == "\"text\"");
+    REQUIRE(restored.Evaluate("numbers") == "#s64(1 -2 3)");
+    REQUIRE(restored.Evaluate("(hash-table-ref table (list 'key 1))") == "#(value)");
+    REQUIRE(restored.Evaluate("(hash-table-ref table \"name\")") == "x");
+    REQUIRE(restored.Evaluate("(hash-table-count table)") == "2");
+    REQUIRE(restored.Evaluate("(eq? (hash-table-ref symbols 'a) shared)") == "#t");
+    // Builtins are the restored Scheme's own.
+    REQUIRE(restored.Evaluate("(eq? first car)") == "#t");
+    REQUIRE(restored.Evaluate("(first shared)") == "1");
+
+    // The image is a copy: changes on either side stay there.
+    REQUIRE(restored.Evaluate("(set-car! shared 5)") == "()");
+    ExpectEq("shared", "(1 2)");
+    std::filesystem::remove(path);
+}
+
+TEST_CASE_METHOD(SchemeTest, "ImageCompiledProcedures") {
+    auto path = TempPath("scheme-test-procedures.image");
+    ExpectNoError("(define (fact n) (if (= n 0) 1 (* n (fact (- n 1)))))");
+    ExpectNoError("(define (make-counter n) (lambda () (set! n (+ n 1)) n))");
+    ExpectNoError("(define counter (make-counter 0))");
+    ExpectEq("(counter)", "1");
+    ExpectNoError("(define (make-account total) "
+                  "(cons (lambda (x) (set! total (+ total x)) total) (lambda () total)))");
+    ExpectNoError("(define account (make-account 10))");
+    ExpectNoError("(define (caller) (helper 2))");
+    ExpectNoError("(define (helper x) (list 'helped x))");
+    ExpectNoError("(define (broken) (if))");
+    if (kTestExecutionMode == ExecutionMode::kTreeWalker) {
+        // The closures of the tree walker hold analyzed syntax, which has no image form.
+        REQUIRE_THROWS_AS(SaveImage(path), RuntimeError);
+        return;
+    }
+    SaveImage(path);
+
+    Scheme restored{kTestExecutionMode};
+    REQUIRE(restored.Load(path).empty());
+    REQUIRE(restored.Evaluate("(fact 20)") == "2432902008176640000");
+    REQUIRE(restored.Evaluate("(fact 25)") == "15511210043330985984000000");
+    REQUIRE(restored.Evaluate("(counter)") == "2");
+    REQUIRE(restored.Evaluate("(counter)") == "3");
+    ExpectEq("(counter)", "2");
+    // Closures over the same frame still share it.
+    REQUIRE(restored.Evaluate("((car account) 5)") == "15");
+    REQUIRE(restored.Evaluate("((cdr account))") == "15");
+    REQUIRE(restored.Evaluate("(caller)") == "(helped 2)");
+    REQUIRE(restored.Evaluate("((make-counter 41))") == "42");
+    REQUIRE_THROWS_AS(restored.Evaluate("(broken)"), SyntaxError);
+    // Globals are looked up by name, the restored Scheme can redefine them.
+    REQUIRE(restored.Evaluate("(define (helper x) x)") == "helper");
+    REQUIRE(restored.Evaluate("(caller)") == "2");
+
+    Scheme other{ExecutionMode::kTreeWalker};
+    REQUIRE_THROWS_AS(other.LoadImage(path), RuntimeError);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE_METHOD(SchemeTest, "ImageErrors") {
+    auto path = TempPath("scheme-test-errors.image");
+    ExpectNoError("(define datum '(a (b #(c \"text\" 1.5)) . 7))");
+    ExpectNoError("(define table (make-hash-table))");
+    ExpectNoError("(hash-table-set! table 'key datum)");
+    if (kTestExecutionMode == ExecutionMode::kBytecode) {
+        ExpectNoError("(define (f x) (if x (g x) (list x 'y)))");
+    }
+    SaveImage(path);
+    std::string image;
+    {
+        std::ifstream file(path, std::ios::binary);
+        image.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+
+    // Images and fasls aren't taken for each other.
+    ExpectSyntaxError("(read-fasl \"" + path + "\")");
+    ExpectNoError("(write-fasl \"" + path + "\" datum)");
+    {
+        Scheme restored{kTestExecutionMode};
+        REQUIRE_THROWS_AS(restored.LoadImage(path), SyntaxError);
+    }
+
+    // Cut short anywhere, an image is malformed rather than read past its end.
+    for (size_t size = 8; size < image.size(); ++size) {
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(image.data(), size);
+        }
+        Scheme restored{kTestExecutionMode};
+        REQUIRE_THROWS_AS(restored.LoadImage(path), SyntaxError);
+    }
+    std::filesystem::remove(path);
+
+    Scheme restored{kTestExecutionMode};
+    REQUIRE_THROWS_AS(restored.LoadImage(path), RuntimeError);
+}
+
+TEST_CASE_METHOD(SchemeTest, "ImageCorruptBytecode") {
+    if (kTestExecutionMode == ExecutionMode::kTreeWalker) {
+        return;
+    }
+    auto path = TempPath("scheme-test-corrupt.image");
+    ExpectNoError("(define (f x) (if (< x 0) (- x) (+ x 1)))");
+    ExpectNoError("(define (make-adder n) (lambda (x) (+ x n)))");
+    ExpectNoError("(define add2 (make-adder 2))");
+    SaveImage(path);
+    std::string image;
+    {
+        std::ifstream file(path, std::ios::binary);
+        image.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+
+    // Whatever byte changes, the image is refused, or its procedures run within their code and
+    // frames, though they may compute something else.
+    size_t refused = 0;
+    for (size_t i = 8; i < image.size(); ++i) {
+        for (int flip : {0x01, 0x02, 0x10, 0x80, 0xff}) {
+            auto corrupt = image;
+            corrupt[i] = static_cast<char>(corrupt[i] ^ flip);
+            {
+                std::ofstream file(path, std::ios::binary | std::ios::trunc);
+                file.write(corrupt.data(), corrupt.size());
+            }
+            Scheme restored{kTestExecutionMode};
+            try {
+                restored.LoadImage(path);
+            } catch (const SyntaxError&) {
+                ++refused;
+                continue;
+            } catch (const RuntimeError&) {
+                ++refused;
+                continue;
+            }
+            for (const auto* expression : {"(f 5)", "(f -3)", "(add2 1)", "((make-adder 1) 2)"}) {
+                try {
+                    restored.Evaluate(expression);
+                } catch (const std::runtime_error&) {
+                }
+            }
+        }
+    }
+    REQUIRE(refused > 0);
+    std::filesystem::remove(path);
+}
@@ -123,3 +123,69 @@ TEST_CASE_METHOD(SchemeTest, "IntegerPredicateAfterExecution") {
     ExpectEq("(number? '(/ 2 -1))", "#f");
     ExpectEq("(number? '())", "#f");
 }
+
+TEST_CASE_METHOD(SchemeTest, "RedefinedArithmetic") {
+    ExpectNoError("(define (add a b) (+ a b))");
+    ExpectEq("(add 5 2)", "7");
+    ExpectRuntimeError("(add 5 #t)");
+
+    ExpectNoError("(define + -)");
+    ExpectEq("(add 5 2)", "3");
+    ExpectEq("(+ 5 2)", "3");
+}
+
+TEST_CASE_METHOD(SchemeTest, "IntegerOverflowPromotesToBignum") {
+    ExpectEq("(+ 4611686018427387903 1)", "4611686018427387904");
+    ExpectEq("(- -4611686018427387904 1)", "-4611686018427387905");
+    ExpectEq("(* 4611686018427387903 2)", "9223372036854775806");
+    ExpectEq("(* 9223372036854775807 9223372036854775807)",
+             "85070591730234615847396907784232501249");
+    ExpectEq("(- (* 9223372036854775807 4) (* 9223372036854775807 3))", "9223372036854775807");
+    ExpectEq("(- (+ 4611686018427387903 1) 1)", "4611686018427387903");
+    ExpectEq("(number? (* 9223372036854775807 2))", "#t");
+    ExpectEq("(abs -9223372036854775808)", "9223372036854775808");
+    ExpectEq("(- -9223372036854775808)", "9223372036854775808");
+
+    ExpectNoError("(define (fact n) (if (= n 0) 1 (* n (fact (- n 1)))))");
+    ExpectEq("(fact 30)", "265252859812191058636308480000000");
+    ExpectEq("(/ (fact 30) (fact 28))", "870");
+    ExpectEq("(/ (fact 30) (- (fact 25)))", "-17100720");
+    ExpectEq("(/ (fact 30) 1000000007)", "265252857955421052948361");
+    ExpectEq("(/ (fact 20) (fact 30))", "0");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BignumComparison") {
+    ExpectNoError("(define big (* 9223372036854775807 9223372036854775807))");
+    ExpectEq("(< 1 big)", "#t");
+    ExpectEq("(< (- big) 1 big)", "#t");
+    ExpectEq("(> big (- big 1) 0)", "#t");
+    ExpectEq("(= big (* 9223372036854775807 9223372036854775807))", "#t");
+    ExpectEq("(= big (+ big 1))", "#f");
+    ExpectEq("(max 1 big 2)", "85070591730234615847396907784232501249");
+    ExpectEq("(min 1 (- big) 2)", "-85070591730234615847396907784232501249");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BignumLiterals") {
+    // Literals read as the integers arithmetic gives, so printed bignums read back.
+    ExpectEq("(* 99999999999 99999999999)", "9999999999800000000001");
+    ExpectEq("9999999999800000000001", "9999999999800000000001");
+    ExpectEq("'9999999999800000000001", "9999999999800000000001");
+    ExpectEq("(quote (9999999999800000000001 -9999999999800000000001))",
+             "(9999999999800000000001 -9999999999800000000001)");
+    ExpectEq("(= 9999999999800000000001 (* 99999999999 99999999999))", "#t");
+    ExpectEq("(eqv? '9999999999800000000001 (* 99999999999 99999999999))", "#t");
+    ExpectEq("(- 9999999999800000000001 9999999999800000000000)", "1");
+    ExpectEq("+18446744073709551616", "18446744073709551616");
+    ExpectEq("-9223372036854775809", "-9223372036854775809");
+    ExpectEq("#(85070591730234615847396907784232501249)",
+             "#(85070591730234615847396907784232501249)");
+    // Leading zeros may make a literal long without making it large.
+    ExpectEq("00000000000000000000000000042", "42");
+    ExpectEq("-00000000000000000000004611686018427387904", "-4611686018427387904");
+}
+
+TEST_CASE_METHOD(SchemeTest, "DivisionByZero") {
+    ExpectRuntimeError("(/ 1 0)");
+    ExpectRuntimeError("(/ 0)");
+    ExpectRuntimeError("(/ (* 9223372036854775807 2) 0)");
+}
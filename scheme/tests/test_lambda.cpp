@@ -1,5 +1,17 @@
 #include "tests/scheme_test.h"
 
+#include <string>
+
+namespace {
+// How deep plain recursion gets with the default limits. AddressSanitizer takes several times
+// the native stack per call of the tree walker.
+#if defined(__SANITIZE_ADDRESS__)
+constexpr int kDefaultRecursionDepth = 2'000;
+#else
+constexpr int kDefaultRecursionDepth = 5'000;
+#endif
+}  // namespace
+
 TEST_CASE_METHOD(SchemeTest, "SimpleLambda") {
     ExpectEq("((lambda () (+ 5 6 7)))", "18");
     ExpectEq("((lambda (x) (+ 1 x)) 5)", "6");
@@ -42,6 +54,61 @@ TEST_CASE_METHOD(SchemeTest, "LambdaClosure") {
     ExpectEq("x", "1");
 }
 
+TEST_CASE_METHOD(SchemeTest, "NestedLambdasSeeOuterVariables") {
+    ExpectNoError("(define (adder a) (lambda (b) (lambda (c) (+ a b c))))");
+    ExpectEq("(((adder 1) 2) 3)", "6");
+    ExpectNoError("(define (outer x) (define (middle) (lambda () x)) ((middle)))");
+    ExpectEq("(outer 4)", "4");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VariablesShadowSpecialForms") {
+    ExpectNoError("(define (g if) (if 1 2))");
+    ExpectRuntimeError("(g 5)");
+    ExpectEq("(g +)", "3");
+    ExpectEq("((lambda (begin) ((lambda () (begin 1 2)))) list)", "(1 2)");
+    ExpectNoError("(define (h) (define and *) (and 6 7))");
+    ExpectEq("(h)", "42");
+    ExpectEq("(if #f 1 2)", "2");
+}
+
+TEST_CASE_METHOD(SchemeTest, "RecursiveCallsHaveTheirOwnVariables") {
+    ExpectNoError("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+    ExpectEq("(fib 10)", "55");
+}
+
+TEST_CASE_METHOD(SchemeTest, "CapturedFramesOutliveTheirCall") {
+    ExpectNoError("(define (make-adder n) (lambda (x) (+ x n)))");
+    ExpectNoError("(define (square x) (* x x))");
+    ExpectNoError("(define add2 (make-adder 2))");
+    // Calls that don't capture their frame must not reuse the captured one.
+    ExpectEq("(square 7)", "49");
+    ExpectEq("(add2 (square 3))", "11");
+    ExpectEq("((make-adder (square 2)) (add2 1))", "7");
+
+    ExpectRuntimeError("(square 1 2)");
+    ExpectEq("(add2 (square 4))", "18");
+}
+
+TEST_CASE_METHOD(SchemeTest, "InternalDefinitions") {
+    ExpectNoError(R"EOF(
+        (define (parity n)
+          (define (even? n) (if (= n 0) #t (odd? (- n 1))))
+          (define (odd? n) (if (= n 0) #f (even? (- n 1))))
+          (even? n))
+                    )EOF");
+    ExpectEq("(parity 10)", "#t");
+    ExpectEq("(parity 7)", "#f");
+
+    ExpectNoError("(define (early) (define x y) (define y 1) x)");
+    ExpectNameError("(early)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "LambdaSyntaxErrorIsRaisedWhenEvaluated") {
+    ExpectNoError("(define (f x) (if x 1 (lambda)))");
+    ExpectEq("(f #t)", "1");
+    ExpectSyntaxError("(f #f)");
+}
+
 TEST_CASE_METHOD(SchemeTest, "LambdaSyntax") {
     ExpectSyntaxError("(lambda)");
     ExpectSyntaxError("(lambda x)");
@@ -62,3 +129,47 @@ TEST_CASE_METHOD(SchemeTest, "DefineLambdaSugar") {
     ExpectEq("(f)", "32");
     ExpectEq("(f)", "32");
 }
+
+TEST_CASE_METHOD(SchemeTest, "ArgumentsAreDroppedWhenACallFails") {
+    ExpectNoError("(define (f x y) (if (= x 0) y (f (- x 1) (+ y (car x)))))");
+    ExpectRuntimeError("(+ 1 (f 3 0) 2)");
+    ExpectEq("(list 1 (+ 2 3) (list 4))", "(1 5 (4))");
+    ExpectEq("(f 0 7)", "7");
+}
+
+TEST_CASE_METHOD(SchemeTest, "DeepRecursionRaisesRuntimeError") {
+    ExpectNoError("(define (deep n) (if (= n 0) 0 (+ 1 (deep (- n 1)))))");
+    auto depth = std::to_string(kDefaultRecursionDepth);
+    ExpectEq("(deep " + depth + ")", depth);
+
+    SetMaxCallDepth(1000);
+    ExpectEq("(deep 500)", "500");
+    ExpectRuntimeError("(deep 5000)");
+    ExpectEq("(deep 10)", "10");
+
+    // Tail calls don't nest.
+    ExpectNoError("(define (count n) (if (= n 0) 'done (count (- n 1))))");
+    ExpectEq("(count 5000)", "done");
+
+    if (kTestExecutionMode == ExecutionMode::kBytecode) {
+        // Activations of the virtual machine are on the heap.
+        SetMaxCallDepth(1'000'000);
+        ExpectEq("(deep 200000)", "200000");
+    }
+}
+
+TEST_CASE_METHOD(SchemeTest, "DeepRecursionInNestedBodies") {
+    // Every call is nested in 200 others, which the tree walker recurses on as well.
+    std::string body = "(f (- n 1))";
+    for (int i = 0; i < 200; ++i) {
+        body = "(+ 1 " + body + ")";
+    }
+    ExpectNoError("(define (f n) (if (= n 0) 0 " + body + "))");
+    ExpectEq("(f 10)", "2000");
+    if (kTestExecutionMode == ExecutionMode::kBytecode) {
+        ExpectEq("(f 3900)", "780000");
+    } else {
+        ExpectRuntimeError("(f 3900)");
+    }
+    ExpectEq("(f 10)", "2000");
+}
@@ -49,6 +49,14 @@ TEST_CASE_METHOD(SchemeTest, "ListPredicate") {
     ExpectEq("(list? '(1 2))", "#t");
     ExpectEq("(list? '(1 . 2))", "#f");
     ExpectEq("(list? '(1 2 3 4 . 5))", "#f");
+
+    ExpectNoError("(define l (list 1 2 3))");
+    ExpectNoError("(set-cdr! (cdr (cdr l)) l)");
+    ExpectEq("(list? l)", "#f");
+    ExpectEq("(list? (cons 0 l))", "#f");
+    ExpectNoError("(define p (list 1))");
+    ExpectNoError("(set-cdr! p p)");
+    ExpectEq("(list? p)", "#f");
 }
 
 TEST_CASE_METHOD(SchemeTest, "PairOperations") {
@@ -65,6 +73,11 @@ TEST_CASE_METHOD(SchemeTest, "PairMutations") {
 
     ExpectNoError("(set-cdr! x 6)");
     ExpectEq("(cdr x)", "6");
+
+    ExpectNoError("(define y (list x x))");
+    ExpectNoError("(set-car! (car y) 7)");
+    ExpectEq("y", "((7 . 6) (7 . 6))");
+    ExpectRuntimeError("(set-car! 1 2)");
 }
 
 TEST_CASE_METHOD(SchemeTest, "ListOperations") {
@@ -80,3 +93,18 @@ TEST_CASE_METHOD(SchemeTest, "ListOperations") {
     ExpectRuntimeError("(list-ref '(1 2 3) 10)");
     ExpectRuntimeError("(list-tail '(1 2 3) 10)");
 }
+
+TEST_CASE_METHOD(SchemeTest, "DeeplyNestedData") {
+    constexpr int kDepth = 100'000;
+    std::string nested = std::string(kDepth, '(') + std::string(kDepth, ')');
+    ExpectEq("'" + nested, nested);
+    ExpectEq("(car '" + nested + ")", nested.substr(1, 2 * kDepth - 2));
+
+    std::string expression;
+    for (int i = 0; i < kDepth; ++i) {
+        expression += "(+ 1 ";
+    }
+    expression += "0" + std::string(kDepth, ')');
+    ExpectRuntimeError(expression);
+    ExpectRuntimeError("((lambda () " + expression + "))");
+}
@@ -0,0 +1,93 @@
+#include "tests/scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "NumericVectorConstruction") {
+    ExpectEq("(make-s64vector 3)", "#s64(0 0 0)");
+    ExpectEq("(make-s64vector 2 -5)", "#s64(-5 -5)");
+    ExpectEq("(make-f64vector 2 1)", "#f64(1.0 1.0)");
+    ExpectEq("(s64vector 1 2 9223372036854775807)", "#s64(1 2 9223372036854775807)");
+    ExpectEq("(f64vector 0.5 2)", "#f64(0.5 2.0)");
+    ExpectEq("(list->s64vector '(1 2 3))", "#s64(1 2 3)");
+    ExpectEq("(s64vector->list (s64vector 4611686018427387904 1))", "(4611686018427387904 1)");
+    ExpectEq("(f64vector->list (f64vector))", "()");
+    ExpectEq("(s64vector? (s64vector))", "#t");
+    ExpectEq("(s64vector? (f64vector))", "#f");
+    ExpectEq("(f64vector? #(1.0))", "#f");
+
+    ExpectRuntimeError("(s64vector 1.5)");
+    ExpectRuntimeError("(s64vector (* 9223372036854775807 2))");
+    ExpectRuntimeError("(f64vector 'a)");
+    ExpectRuntimeError("(make-f64vector -1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "NumericVectorAccess") {
+    ExpectNoError("(define v (make-f64vector 3))");
+    ExpectEq("(f64vector-length v)", "3");
+    ExpectNoError("(f64vector-set! v 2 1.5)");
+    ExpectNoError("(f64vector-set! v 0 2)");
+    ExpectEq("(f64vector-ref v 2)", "1.5");
+    ExpectEq("v", "#f64(2.0 0.0 1.5)");
+    ExpectRuntimeError("(f64vector-ref v 3)");
+    ExpectRuntimeError("(s64vector-ref v 0)");
+    ExpectRuntimeError("(f64vector-set! v 0 #t)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "NumericVectorElementwise") {
+    ExpectNoError("(define a (s64vector 1 2 3 4 5 6 7 8 9))");
+    ExpectNoError("(define b (s64vector 9 8 7 6 5 4 3 2 1))");
+    ExpectEq("(s64vector-add a b)", "#s64(10 10 10 10 10 10 10 10 10)");
+    ExpectEq("(s64vector-sub a b)", "#s64(-8 -6 -4 -2 0 2 4 6 8)");
+    ExpectEq("(s64vector-mul a b)", "#s64(9 16 21 24 25 24 21 16 9)");
+    ExpectEq("(s64vector-scale a -2)", "#s64(-2 -4 -6 -8 -10 -12 -14 -16 -18)");
+    ExpectEq("a", "#s64(1 2 3 4 5 6 7 8 9)");
+
+    ExpectNoError("(define x (f64vector 0.5 1.5 2.5 3.5 4.5))");
+    ExpectNoError("(define y (f64vector 1 1 1 1 2))");
+    ExpectEq("(f64vector-add x y)", "#f64(1.5 2.5 3.5 4.5 6.5)");
+    ExpectEq("(f64vector-sub x y)", "#f64(-0.5 0.5 1.5 2.5 2.5)");
+    ExpectEq("(f64vector-mul x y)", "#f64(0.5 1.5 2.5 3.5 9.0)");
+    ExpectEq("(f64vector-scale x 2)", "#f64(1.0 3.0 5.0 7.0 9.0)");
+
+    ExpectRuntimeError("(s64vector-add a (s64vector 1))");
+    ExpectRuntimeError("(s64vector-add a x)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "NumericVectorOverflow") {
+    ExpectNoError("(define big (make-s64vector 5 9223372036854775807))");
+    ExpectRuntimeError("(s64vector-add big big)");
+    ExpectRuntimeError("(s64vector-sub (s64vector-scale big -1) (make-s64vector 5 2))");
+    ExpectRuntimeError("(s64vector-mul big big)");
+    ExpectRuntimeError("(s64vector-scale big 2)");
+
+    ExpectEq("(s64vector-sum big)", "46116860184273879035");
+    ExpectEq("(s64vector-dot big (make-s64vector 5 2))", "92233720368547758070");
+    ExpectEq("(s64vector-sum (s64vector 9223372036854775807 1 -2))", "9223372036854775806");
+}
+
+TEST_CASE_METHOD(SchemeTest, "NumericVectorReductions") {
+    ExpectNoError("(define a (s64vector 3 -1 4 1 -5 9 2 6 5 3 5))");
+    ExpectEq("(s64vector-sum a)", "32");
+    ExpectEq("(s64vector-min a)", "-5");
+    ExpectEq("(s64vector-max a)", "9");
+    ExpectEq("(s64vector-dot a a)", "232");
+    ExpectEq("(s64vector-sum (s64vector))", "0");
+    ExpectRuntimeError("(s64vector-min (s64vector))");
+
+    ExpectNoError("(define x (f64vector 0.5 -1.5 2.5 3.5 -4.5 5.5 6.5 7.5 8.5))");
+    ExpectEq("(f64vector-sum x)", "28.5");
+    ExpectEq("(f64vector-min x)", "-4.5");
+    ExpectEq("(f64vector-max x)", "8.5");
+    ExpectEq("(f64vector-dot x (make-f64vector 9 2))", "57.0");
+    ExpectEq("(f64vector-sum (f64vector))", "0.0");
+    ExpectEq("(f64vector-max (f64vector 1 2 3 4 5 (/ 0.0 0.0) 7 8))", "+nan.0");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HugeNumericVectors") {
+    // The size in bytes would wrap around.
+    ExpectRuntimeError("(define v (make-s64vector 2305843009213693953 0))");
+    ExpectNameError("(s64vector-set! v 100000000 1)");
+    ExpectRuntimeError("(make-f64vector 2305843009213693953)");
+    // It wouldn't, but no allocator can serve it.
+    ExpectRuntimeError("(make-s64vector 100000000000000)");
+    ExpectRuntimeError("(make-f64vector 100000000000000 1.5)");
+    ExpectEq("(make-s64vector 2 7)", "#s64(7 7)");
+}
@@ -0,0 +1,60 @@
+#include "tests/scheme_test.h"
+
+#include <string>
+
+TEST_CASE_METHOD(SchemeTest, "PrintCycles") {
+    ExpectNoError("(define x (list 1 2 3))");
+    ExpectNoError("(set-cdr! (cdr (cdr x)) x)");
+    ExpectEq("x", "#0=(1 2 3 . #0#)");
+    ExpectEq("(cdr x)", "#0=(2 3 1 . #0#)");
+
+    ExpectNoError("(define y (list 1 2 3))");
+    ExpectNoError("(set-cdr! (cdr (cdr y)) (cdr y))");
+    ExpectEq("y", "(1 . #0=(2 3 . #0#))");
+
+    ExpectNoError("(define z (list 1 2))");
+    ExpectNoError("(set-car! z z)");
+    ExpectEq("z", "#0=(#0# 2)");
+
+    ExpectNoError("(define v (vector 1 2))");
+    ExpectNoError("(vector-set! v 1 v)");
+    ExpectEq("v", "#0=#(1 #0#)");
+    ExpectEq("(list v v)", "(#0=#(1 #0#) #0#)");
+
+    // Sharing without a cycle is printed out in full.
+    ExpectNoError("(define shared (list 1 2))");
+    ExpectEq("(list shared shared x)", "((1 2) (1 2) #0=(1 2 3 . #0#))");
+
+    // A long cycle, past the walk that finds no labels in data without sharing.
+    ExpectNoError("(define (build n acc) (if (= n 0) acc (build (- n 1) (cons n acc))))");
+    ExpectNoError("(define long (build 100000 '()))");
+    ExpectNoError("(set-cdr! (list-tail long 99999) long)");
+    auto printed = EvaluateToStream("long");
+    REQUIRE(printed.starts_with("#0=(1 2 3 "));
+    REQUIRE(printed.ends_with(" 99999 100000 . #0#)"));
+}
+
+TEST_CASE_METHOD(SchemeTest, "PrintSharedStructure") {
+    ExpectNoError("(define shared (list 1 2))");
+    ExpectNoError("(define data (list shared (cons 0 shared) (vector shared)))");
+    ExpectEq("data", "((1 2) (0 1 2) #((1 2)))");
+    SetPrintLabels(PrintLabels::kShared);
+    ExpectEq("data", "(#0=(1 2) (0 . #0#) #(#0#))");
+    ExpectEq("(list data data)", "(#0=(#1=(1 2) (0 . #1#) #(#1#)) #0#)");
+    ExpectEq("'(1 (2) #(3))", "(1 (2) #(3))");
+    // Only pairs and vectors are labeled.
+    ExpectNoError("(define text \"text\")");
+    ExpectEq("(list text text)", "(\"text\" \"text\")");
+}
+
+TEST_CASE_METHOD(SchemeTest, "PrintToStream") {
+    ExpectNoError(
+        "(define (build n acc) (if (= n 0) acc (build (- n 1) (cons (list n \"n\") acc))))");
+    ExpectNoError("(define long (build 50000 '()))");
+    auto printed = EvaluateToStream("long");
+    REQUIRE(printed.size() > (1 << 16) * 8);
+    ExpectEq("long", printed);
+    REQUIRE(printed.starts_with("((1 \"n\") (2 \"n\") "));
+    REQUIRE(EvaluateToStream("(+ 1 2)") == "3");
+    REQUIRE(EvaluateToStream("'()") == "()");
+}
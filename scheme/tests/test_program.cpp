@@ -0,0 +1,60 @@
+#include "tests/scheme_test.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE_METHOD(SchemeTest, "ProgramOfSeveralForms") {
+    using Results = std::vector<std::string>;
+    REQUIRE(EvaluateAll("(define x 1)\n(define (add y) (+ x y))\n(add 2) 'a \"s\" '()") ==
+            Results{"x", "add", "3", "a", "\"s\"", "()"});
+    ExpectEq("(add 3)", "4");
+
+    REQUIRE(EvaluateAll("").empty());
+    REQUIRE(EvaluateAll("  \n\t ").empty());
+    REQUIRE(EvaluateAll("(add 4)") == Results{"5"});
+
+    std::istringstream input{"(set! x 10) (add 1)\n'(1 . 2)"};
+    REQUIRE(EvaluateAll(&input) == Results{"()", "11", "(1 . 2)"});
+}
+
+TEST_CASE_METHOD(SchemeTest, "ErrorsStopProgram") {
+    REQUIRE_THROWS_AS(EvaluateAll("(define a 1) (car '()) (define b 2)"), RuntimeError);
+    ExpectEq("a", "1");
+    ExpectNameError("b");
+
+    REQUIRE_THROWS_AS(EvaluateAll("(define c 1) (+ c"), SyntaxError);
+    ExpectEq("c", "1");
+    REQUIRE_THROWS_AS(EvaluateAll("(define d 1) )"), SyntaxError);
+    ExpectEq("d", "1");
+}
+
+TEST_CASE_METHOD(SchemeTest, "LongProgramReadWhileEvaluated") {
+    // Each form makes garbage, which is collected between forms.
+    std::stringstream input;
+    constexpr int kForms = 20000;
+    input << "(define total 0)\n";
+    for (int i = 0; i < kForms; ++i) {
+        input << "(set! total (+ total (car (cdr (list 0 " << i << " 2 3)))))\n";
+    }
+    input << "total";
+    auto results = EvaluateAll(&input);
+    REQUIRE(results.size() == kForms + 2);
+    REQUIRE(results.back() == std::to_string(kForms * (kForms - 1) / 2));
+}
+
+TEST_CASE_METHOD(SchemeTest, "Load") {
+    auto path = std::filesystem::temp_directory_path() / "scheme-test-load.scm";
+    {
+        std::ofstream file(path);
+        file << "(define (square x) (* x x))\n(square 7)\n";
+    }
+    REQUIRE(Load(path.string()) == std::vector<std::string>{"square", "49"});
+    std::filesystem::remove(path);
+    ExpectEq("(square 3)", "9");
+
+    REQUIRE_THROWS_AS(Load(path.string()), RuntimeError);
+}
@@ -0,0 +1,62 @@
+#include "tests/scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "StringLiterals") {
+    ExpectEq(R"("hello")", R"("hello")");
+    ExpectEq(R"("")", R"("")");
+    ExpectEq(R"("a \"b\"\n\\")", R"("a \"b\"\n\\")");
+    ExpectEq(R"('("x" . "y"))", R"(("x" . "y"))");
+    ExpectEq(R"((string? "s"))", "#t");
+    ExpectEq("(string? 's)", "#f");
+    ExpectSyntaxError(R"("open)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "StringBuiltins") {
+    ExpectEq(R"((string-length "hello"))", "5");
+    ExpectEq(R"((string-length ""))", "0");
+    ExpectEq(R"((substring "hello" 1 3))", R"("el")");
+    ExpectEq(R"((substring "hello" 2))", R"("llo")");
+    ExpectEq(R"((substring "hello" 5 5))", R"("")");
+    ExpectEq(R"((string-append "a" "" "bc" "d"))", R"("abcd")");
+    ExpectEq("(string-append)", R"("")");
+    ExpectEq(R"((string=? "ab" "ab" "ab"))", "#t");
+    ExpectEq(R"((string=? "ab" "abc"))", "#f");
+    ExpectEq(R"((string->symbol "foo"))", "foo");
+    ExpectEq(R"((eq? (string->symbol "foo") 'foo))", "#t");
+    ExpectEq("(symbol->string 'bar)", R"("bar")");
+    ExpectEq("(number->string 42)", R"("42")");
+    ExpectEq("(number->string -1.5)", R"("-1.5")");
+    ExpectEq("(number->string (* 10000000000 10000000000))", R"("100000000000000000000")");
+
+    ExpectRuntimeError(R"((substring "hello" 3 2))");
+    ExpectRuntimeError(R"((substring "hello" 0 6))");
+    ExpectRuntimeError(R"((string-append "a" 'b))");
+    ExpectRuntimeError(R"((string=? "a" 1))");
+    ExpectRuntimeError("(string-length 'a)");
+    ExpectRuntimeError("(number->string 'a)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "StringEquivalence") {
+    ExpectNoError(R"((define (f) "literal"))");
+    ExpectEq("(eq? (f) (f))", "#t");
+    ExpectEq(R"((eq? (f) "literal"))", "#t");
+    ExpectEq(R"((eq? (string-append "lit" "eral") "literal"))", "#f");
+    ExpectEq(R"((equal? (string-append "lit" "eral") "literal"))", "#t");
+    ExpectEq(R"((equal? '("a" #("b")) (list "a" (vector "b"))))", "#t");
+    ExpectNoError("(define t (make-hash-table))");
+    ExpectNoError(R"((hash-table-set! t (string-append "k" "ey") 1))");
+    ExpectEq(R"((hash-table-ref t "key"))", "1");
+}
+
+TEST_CASE_METHOD(SchemeTest, "StringsSurviveCollection") {
+    ExpectNoError(R"((define s (string-append "x" (number->string 1))))");
+    ExpectNoError(R"((define (g) "kept"))");
+    CollectGarbage();
+    ExpectEq("s", R"("x1")");
+    ExpectEq("(g)", R"("kept")");
+    ExpectEq(R"((eq? (g) "kept"))", "#t");
+
+    // An unreachable literal is collected and read afresh.
+    ExpectEq(R"("dropped")", R"("dropped")");
+    CollectGarbage();
+    ExpectEq(R"((string-append "dropped"))", R"("dropped")");
+}
@@ -0,0 +1,59 @@
+#include "tests/scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "VectorLiterals") {
+    ExpectEq("#(1 2 3)", "#(1 2 3)");
+    ExpectEq("#()", "#()");
+    ExpectEq("'#(a (b c) #(d))", "#(a (b c) #(d))");
+    ExpectEq("(vector? #(1))", "#t");
+    ExpectEq("(vector? '(1))", "#f");
+    ExpectSyntaxError("#(1 . 2)");
+    ExpectSyntaxError("#(1 2");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorConstruction") {
+    ExpectEq("(make-vector 3)", "#(0 0 0)");
+    ExpectEq("(make-vector 2 'x)", "#(x x)");
+    ExpectEq("(make-vector 0)", "#()");
+    ExpectEq("(vector 1 (+ 1 1) 'three)", "#(1 2 three)");
+    ExpectEq("(vector)", "#()");
+    ExpectEq("(list->vector '(1 2 3))", "#(1 2 3)");
+    ExpectEq("(vector->list #(1 2 3))", "(1 2 3)");
+    ExpectEq("(vector->list #())", "()");
+    ExpectRuntimeError("(make-vector -1)");
+    ExpectRuntimeError("(list->vector '(1 . 2))");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorAccess") {
+    ExpectNoError("(define v (make-vector 3 0))");
+    ExpectEq("(vector-length v)", "3");
+    ExpectNoError("(vector-set! v 1 'a)");
+    ExpectEq("(vector-ref v 1)", "a");
+    ExpectEq("v", "#(0 a 0)");
+    ExpectNoError("(vector-fill! v 7)");
+    ExpectEq("v", "#(7 7 7)");
+
+    ExpectRuntimeError("(vector-ref v 3)");
+    ExpectRuntimeError("(vector-ref v -1)");
+    ExpectRuntimeError("(vector-set! v 3 0)");
+    ExpectRuntimeError("(vector-ref '(1 2) 0)");
+    ExpectRuntimeError("(vector-ref v 'a)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorsSurviveCollection") {
+    ExpectNoError("(define v (make-vector 100 '()))");
+    ExpectNoError(R"EOF(
+        (define (fill i) (if (= i 100) v (begin (vector-set! v i (list i i)) (fill (+ i 1)))))
+                  )EOF");
+    ExpectNoError("(fill 0)");
+    CollectGarbage();
+    ExpectEq("(vector-ref v 42)", "(42 42)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HugeVectors") {
+    // The size in bytes would wrap around.
+    ExpectRuntimeError("(define v (make-vector 2305843009213693952 0))");
+    ExpectNameError("(vector-set! v 1000000000 'x)");
+    // It wouldn't, but no allocator can serve it.
+    ExpectRuntimeError("(make-vector 100000000000000)");
+    ExpectEq("(make-vector 2 'x)", "#(x x)");
+}
@@ -1,6 +1,14 @@
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdlib>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <system_error>
 
+#include "error.h"
 #include "tokenizer.h"
 
 bool SymbolToken::operator==(const SymbolToken& other) const {
@@ -11,6 +19,10 @@ bool QuoteToken::operator==(const QuoteToken&) const {
     return true;
 }
 
+bool VectorToken::operator==(const VectorToken&) const {
+    return true;
+}
+
 bool DotToken::operator==(const DotToken&) const {
     return true;
 }
@@ -19,10 +31,26 @@ bool ConstantToken::operator==(const ConstantToken& other) const {
     return value == other.value;
 }
 
+bool BignumToken::operator==(const BignumToken& other) const {
+    return digits == other.digits;
+}
+
+bool FlonumToken::operator==(const FlonumToken& other) const {
+    return value == other.value;
+}
+
+bool StringToken::operator==(const StringToken& other) const {
+    return value == other.value;
+}
+
 Tokenizer::Tokenizer(std::istream* in) : input_(in) {
     Next();
 }
 
+Tokenizer::Tokenizer(std::string_view source) : source_(source) {
+    Next();
+}
+
 bool Tokenizer::IsEnd() {
     return !current_token_;
 }
@@ -38,30 +66,112 @@ Token Tokenizer::GetToken() {
     throw std::runtime_error("GetToken: no token");
 }
 
+int Tokenizer::Peek(size_t offset) {
+    while (position_ + offset >= source_.size()) {
+        if (!Fill()) {
+            return EOF;
+        }
+    }
+    return static_cast<unsigned char>(source_[position_ + offset]);
+}
+
+char Tokenizer::Get() {
+    Peek();
+    return source_[position_++];
+}
+
+bool Tokenizer::Fill() {
+    if (!input_) {
+        return false;
+    }
+    // Only the token being read is still needed.
+    buffer_.erase(0, token_start_);
+    position_ -= token_start_;
+    token_start_ = 0;
+    auto size = buffer_.size();
+    buffer_.resize(size + kChunkSize);
+    auto count = input_->readsome(buffer_.data() + size, kChunkSize);
+    if (count == 0) {
+        // Nothing is buffered in the stream: waits for a character, or the end.
+        auto next = input_->get();
+        if (next != EOF) {
+            buffer_[size] = static_cast<char>(next);
+            count = 1 + input_->readsome(buffer_.data() + size + 1, kChunkSize - 1);
+        }
+    }
+    buffer_.resize(size + count);
+    source_ = buffer_;
+    return count != 0;
+}
+
+std::string_view Tokenizer::GetTokenText() const {
+    return source_.substr(token_start_, position_ - token_start_);
+}
+
+void Tokenizer::Skip(CharClass char_class) {
+    for (;;) {
+        // Most runs are a few characters long, for which classifying a block costs more than
+        // looking at each character; blocks pay off only past the first few.
+        auto scalar_end = kVectorizedScan ? std::min(source_.size(), position_ + kScalarScanSize)
+                                          : source_.size();
+        while (position_ < scalar_end &&
+               HasCharClass(static_cast<unsigned char>(source_[position_]), char_class)) {
+            ++position_;
+        }
+        if (position_ < scalar_end) {
+            return;
+        }
+        if constexpr (kVectorizedScan) {
+            // Characters past the end of the source are in no class, so a run ends in the last
+            // block.
+            uint64_t rest;
+            while ((rest = ~ClassifyBlock(source_.data() + position_, source_.size() - position_,
+                                          char_class)) == 0) {
+                position_ += kScanBlockSize;
+            }
+            position_ += std::countr_zero(rest);
+        }
+        // A run may continue past the end of what the stream has given so far.
+        if (position_ < source_.size() || !Fill()) {
+            return;
+        }
+    }
+}
+
 void Tokenizer::ReadNextToken() {
     current_token_.reset();
-    std::ws(*input_);
-    if (input_->peek() != EOF) {
-        char current_char = input_->peek();
-        if (current_char == '(' || current_char == ')') {
-            ReadBracket();
-        } else if (current_char == '.') {
-            ReadDot();
-        } else if (current_char == '\'') {
-            ReadQuote();
-        } else if (IsConstantStart()) {
-            ReadConstant();
-        } else if (SymbolHead(current_char)) {
-            ReadSymbol();
-        } else {
-            throw std::runtime_error("Unknown token at " + std::to_string(input_->tellg()));
-        }
+    // The previous token is no longer needed.
+    token_start_ = position_;
+    Skip(kSpaceChar);
+    token_start_ = position_;
+    int current_char = Peek();
+    if (current_char == EOF) {
+        return;
+    }
+    if (current_char == '(' || current_char == ')') {
+        ReadBracket();
+    } else if (current_char == '.') {
+        ReadDot();
+    } else if (current_char == '\'') {
+        ReadQuote();
+    } else if (current_char == '"') {
+        ReadString();
+    } else if (IsVectorStart()) {
+        position_ += 2;
+        current_token_ = VectorToken{};
+    } else if (IsConstantStart()) {
+        ReadConstant();
+    } else if (IsSpecialFlonumStart()) {
+        ReadSpecialFlonum();
+    } else if (SymbolHead(current_char)) {
+        ReadSymbol();
+    } else {
+        throw std::runtime_error("Unknown token at " + std::to_string(position_));
     }
 }
 
 void Tokenizer::ReadBracket() {
-    char current_char = input_->get();
-    if (current_char == '(') {
+    if (Get() == '(') {
         current_token_ = BracketToken::OPEN;
     } else {
         current_token_ = BracketToken::CLOSE;
@@ -69,83 +179,168 @@ void Tokenizer::ReadBracket() {
 }
 
 void Tokenizer::ReadDot() {
-    input_->get();
+    Get();
+    if (HasCharClass(Peek(), kDigitChar)) {
+        ReadFlonum();
+        return;
+    }
     current_token_ = DotToken();
 }
 
 void Tokenizer::ReadQuote() {
-    input_->get();
+    Get();
     current_token_ = QuoteToken();
 }
 
 void Tokenizer::ReadConstant() {
-    std::string number;
-    char current_char = input_->get();
-    number += static_cast<char>(current_char);
+    Get();
+    Skip(kDigitChar);
+    if (Peek() == '.' || Peek() == 'e' || Peek() == 'E') {
+        ReadFlonum();
+        return;
+    }
+    auto number = GetTokenText();
+    // from_chars takes a minus sign but no plus.
+    auto digits = number.starts_with('+') ? number.substr(1) : number;
+    int64_t value = 0;
+    auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (error == std::errc::result_out_of_range) {
+        current_token_ = BignumToken{.digits = number};
+        return;
+    }
+    current_token_ = ConstantToken{.value = value};
+}
 
-    while (input_->peek() != EOF) {
-        current_char = input_->peek();
-        if (std::isdigit(current_char) == 0) {
-            break;
+void Tokenizer::ReadFlonum() {
+    auto read_digits = [&] {
+        auto start = position_;
+        Skip(kDigitChar);
+        return position_ != start;
+    };
+    if (Peek() == '.') {
+        ++position_;
+    }
+    read_digits();
+    if (Peek() == 'e' || Peek() == 'E') {
+        ++position_;
+        if (Peek() == '+' || Peek() == '-') {
+            ++position_;
+        }
+        if (!read_digits()) {
+            throw SyntaxError("bad exponent in number literal: " + std::string(GetTokenText()));
         }
-        number += input_->get();
-        ;
     }
-    current_token_ = ConstantToken{.value = std::stoi(number)};
+    auto number = GetTokenText();
+    auto digits = number.starts_with('+') ? number.substr(1) : number;
+    double value = 0;
+    auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (error == std::errc::result_out_of_range) {
+        // Out of range literals become infinities or zeros, as in arithmetic.
+        value = std::strtod(std::string(digits).c_str(), nullptr);
+    }
+    current_token_ = FlonumToken{.value = value};
+}
+
+void Tokenizer::ReadSpecialFlonum() {
+    auto negative = Get() == '-';
+    auto infinite = Get() == 'i';
+    position_ += kSpecialFlonumSize - 2;
+    double value = infinite ? std::numeric_limits<double>::infinity()
+                            : std::numeric_limits<double>::quiet_NaN();
+    current_token_ = FlonumToken{.value = negative ? -value : value};
 }
 
 void Tokenizer::ReadSymbol() {
-    std::string symbol;
-    char current_char = input_->get();
-    symbol += current_char;
+    char current_char = Get();
 
     static constexpr std::array kUniqueChars{'+', '-', '/'};
 
-    if (std::ranges::contains(kUniqueChars, current_char)) {
-        current_token_ = SymbolToken{symbol};
-        return;
+    if (!std::ranges::contains(kUniqueChars, current_char)) {
+        Skip(kSymbolTailChar);
     }
+    current_token_ = SymbolToken{GetTokenText()};
+}
 
-    while (input_->peek() != EOF) {
-        current_char = input_->peek();
-        if (SymbolTail(current_char)) {
-            symbol += input_->get();
-        } else {
+void Tokenizer::ReadString() {
+    Get();
+    // Up to the first escape the literal is its own text.
+    Skip(kStringChar);
+    if (Peek() == '"') {
+        current_token_ = StringToken{GetTokenText().substr(1)};
+        ++position_;
+        return;
+    }
+    unescaped_ = GetTokenText().substr(1);
+    for (;;) {
+        auto current_char = Peek();
+        if (current_char == EOF) {
+            throw SyntaxError("unterminated string literal");
+        }
+        ++position_;
+        if (current_char == '"') {
             break;
         }
+        switch (Peek()) {
+            case '"':
+                unescaped_ += '"';
+                break;
+            case '\\':
+                unescaped_ += '\\';
+                break;
+            case 'n':
+                unescaped_ += '\n';
+                break;
+            case 't':
+                unescaped_ += '\t';
+                break;
+            default:
+                throw SyntaxError("unknown escape in string literal");
+        }
+        ++position_;
+        // Filling the buffer may move the token, but not within it.
+        auto run = position_ - token_start_;
+        Skip(kStringChar);
+        unescaped_ += GetTokenText().substr(run);
     }
-
-    current_token_ = SymbolToken{symbol};
+    current_token_ = StringToken{unescaped_};
 }
 
 bool Tokenizer::IsConstantStart() {
-    char current_char = input_->peek();
-    if (std::isdigit(current_char) != 0) {
-        return true;
-    }
+    size_t offset = 0;
+    int current_char = Peek();
     if (current_char == '-' || current_char == '+') {
-        char previous_char = input_->get();
-        if (input_->peek() == EOF) {
-            input_->putback(previous_char);
-            return false;
+        current_char = Peek(++offset);
+    }
+    // A fraction may start at the point, as in -.5.
+    if (current_char == '.') {
+        current_char = Peek(++offset);
+    }
+    return HasCharClass(current_char, kDigitChar);
+}
+
+bool Tokenizer::IsSpecialFlonumStart() {
+    if (Peek() != '-' && Peek() != '+') {
+        return false;
+    }
+    // Compared a character at a time, so no more of a stream is read than the token needs.
+    static constexpr std::array<std::string_view, 2> kNames{"inf.0", "nan.0"};
+    for (auto name : kNames) {
+        size_t i = 0;
+        while (i < name.size() && Peek(i + 1) == name[i]) {
+            ++i;
         }
-        current_char = input_->peek();
-        input_->putback(previous_char);
-        if (std::isdigit(current_char) != 0) {
-            return true;
+        if (i == name.size()) {
+            // Followed by more of a symbol, it is part of the symbol.
+            return !HasCharClass(Peek(kSpecialFlonumSize), kSymbolTailChar);
         }
     }
     return false;
 }
 
-bool Tokenizer::SymbolHead(char current_char) {
-    static constexpr std::array kSymbolHeadChars{'<', '=', '>', '*', '#', '+', '-', '/'};
-
-    return std::isalpha(current_char) != 0 || std::ranges::contains(kSymbolHeadChars, current_char);
+bool Tokenizer::IsVectorStart() {
+    return Peek() == '#' && Peek(1) == '(';
 }
 
-bool Tokenizer::SymbolTail(char current_char) {
-    static constexpr std::array kSymbolTailChars{'<', '=', '>', '*', '#', '?', '!', '-'};
-
-    return std::isalnum(current_char) != 0 || std::ranges::contains(kSymbolTailChars, current_char);
+bool Tokenizer::SymbolHead(int current_char) {
+    return HasCharClass(current_char, kSymbolHeadChar);
 }
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <variant>
 #include <istream>
 #include <cctype>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "scan-kernels.h"
+
+// Tokens with text view it in the source, or in the tokenizer when it had to be rewritten, so
+// they stay valid only until the tokenizer moves on.
 
 struct SymbolToken {
-    std::string name;
+    std::string_view name;
 
     bool operator==(const SymbolToken& other) const;
 };
@@ -15,6 +24,11 @@ struct QuoteToken {
     bool operator==(const QuoteToken&) const;
 };
 
+// The #( that opens a vector literal.
+struct VectorToken {
+    bool operator==(const VectorToken&) const;
+};
+
 struct DotToken {
     bool operator==(const DotToken&) const;
 };
@@ -22,28 +36,84 @@ struct DotToken {
 enum class BracketToken { OPEN, CLOSE };
 
 struct ConstantToken {
-    int value;
+    int64_t value;
 
     bool operator==(const ConstantToken& other) const;
 };
 
-using Token = std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken>;
+// An integer literal too large for 64 bits, as its text.
+struct BignumToken {
+    std::string_view digits;
+
+    bool operator==(const BignumToken& other) const;
+};
+
+// A number with a fraction or an exponent.
+struct FlonumToken {
+    double value;
+
+    bool operator==(const FlonumToken& other) const;
+};
+
+// A string literal, with its escapes replaced.
+struct StringToken {
+    std::string_view value;
+
+    bool operator==(const StringToken& other) const;
+};
+
+using Token =
+    std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken, BignumToken,
+                 FlonumToken, VectorToken, StringToken>;
 
 // Интерфейс, позволяющий читать токены по одному из потока.
+//
+// Scans a contiguous buffer. Given a string, it scans the string in place; given a stream, it
+// buffers what the stream has available and reads more only when a token needs it, so input
+// may still be added to the stream between tokens.
 class Tokenizer {
-    std::istream* input_;
+    static constexpr size_t kChunkSize = 1 << 16;
+    static constexpr size_t kScalarScanSize = 16;
+    // The length of +inf.0 and the other flonums written without digits.
+    static constexpr size_t kSpecialFlonumSize = 6;
+
+    std::istream* input_ = nullptr;
+    // What was read from the stream and is still needed.
+    std::string buffer_;
+    std::string_view source_;
+    size_t position_ = 0;
+    size_t token_start_ = 0;
+    // The text of a string literal with escapes.
+    std::string unescaped_;
     std::optional<Token> current_token_;
 
 public:
     Tokenizer(std::istream* in);
 
+    // The source must outlive the tokenizer.
+    explicit Tokenizer(std::string_view source);
+
     bool IsEnd();
 
     void Next();
 
+    // The token is valid until the next call to Next.
     Token GetToken();
 
 private:
+    // The character at offset from the position, or EOF.
+    int Peek(size_t offset = 0);
+
+    char Get();
+
+    // Reads more of the stream into the buffer. False at the end of the input.
+    bool Fill();
+
+    std::string_view GetTokenText() const;
+
+    // Moves past a run of characters of the class.
+    void Skip(CharClass char_class);
+
     void ReadNextToken();
 
     void ReadBracket();
@@ -54,11 +124,21 @@ private:
 
     void ReadConstant();
 
+    // Reads the rest of a flonum: the digits after the decimal point and the exponent.
+    void ReadFlonum();
+
+    // Reads +inf.0, -inf.0, +nan.0 or -nan.0, the flonums written without digits.
+    void ReadSpecialFlonum();
+
     void ReadSymbol();
 
+    void ReadString();
+
     bool IsConstantStart();
 
-    bool SymbolHead(char current_char);
+    bool IsSpecialFlonumStart();
+
+    bool IsVectorStart();
 
-    bool SymbolTail(char current_char);
+    bool SymbolHead(int current_char);
 };
@@ -0,0 +1,506 @@
+#include "vector-kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// AVX2 loops are compiled with a target attribute rather than for the whole library, and
+// picked at run time, so the library still runs on processors without AVX2.
+#ifndef SCHEME_AVX2
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define SCHEME_AVX2 1
+#else
+#define SCHEME_AVX2 0
+#endif
+#endif
+
+#if SCHEME_AVX2
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define VECTOR_KERNEL(avx2, portable) return HasVectorKernelsAvx2() ? (avx2) : (portable)
+#else
+#define VECTOR_KERNEL(avx2, portable) return (portable)
+#endif
+
+namespace {
+bool CheckedAdd(int64_t a, int64_t b, int64_t* result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_add_overflow(a, b, result);
+#else
+    constexpr auto kMax = std::numeric_limits<int64_t>::max();
+    constexpr auto kMin = std::numeric_limits<int64_t>::min();
+    if ((b > 0 && a > kMax - b) || (b < 0 && a < kMin - b)) {
+        return false;
+    }
+    *result = a + b;
+    return true;
+#endif
+}
+
+bool CheckedSubtract(int64_t a, int64_t b, int64_t* result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_sub_overflow(a, b, result);
+#else
+    constexpr auto kMax = std::numeric_limits<int64_t>::max();
+    constexpr auto kMin = std::numeric_limits<int64_t>::min();
+    if ((b < 0 && a > kMax + b) || (b > 0 && a < kMin + b)) {
+        return false;
+    }
+    *result = a - b;
+    return true;
+#endif
+}
+
+bool CheckedMultiply(int64_t a, int64_t b, int64_t* result) {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_mul_overflow(a, b, result);
+#else
+    constexpr auto kMin = std::numeric_limits<int64_t>::min();
+    if ((a == -1 && b == kMin) || (b == -1 && a == kMin)) {
+        return false;
+    }
+    auto product = static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+    if (a != 0 && product / a != b) {
+        return false;
+    }
+    *result = product;
+    return true;
+#endif
+}
+
+bool HasNan(std::span<const double> values) {
+    return std::ranges::any_of(values, [](double value) { return std::isnan(value); });
+}
+
+// Operations on doubles, on single values and on AVX2 registers of four. A reduction starts
+// every lane from the identity, which is -0.0 for sums so that adding negative zeros stays
+// negative.
+struct DoubleAdd {
+    static constexpr double kIdentity = -0.0;
+
+    static double Apply(double a, double b) {
+        return a + b;
+    }
+#if SCHEME_AVX2
+    AVX2_TARGET static __m256d Apply(__m256d a, __m256d b) {
+        return _mm256_add_pd(a, b);
+    }
+#endif
+};
+
+struct DoubleSubtract {
+    static double Apply(double a, double b) {
+        return a - b;
+    }
+#if SCHEME_AVX2
+    AVX2_TARGET static __m256d Apply(__m256d a, __m256d b) {
+        return _mm256_sub_pd(a, b);
+    }
+#endif
+};
+
+struct DoubleMultiply {
+    static constexpr double kIdentity = 1.0;
+
+    static double Apply(double a, double b) {
+        return a * b;
+    }
+#if SCHEME_AVX2
+    AVX2_TARGET static __m256d Apply(__m256d a, __m256d b) {
+        return _mm256_mul_pd(a, b);
+    }
+#endif
+};
+
+// Only applied once NaNs are ruled out: the instructions and the portable code disagree on
+// which operand they return then.
+struct DoubleMin {
+    static constexpr double kIdentity = std::numeric_limits<double>::infinity();
+
+    static double Apply(double a, double b) {
+        return b < a ? b : a;
+    }
+#if SCHEME_AVX2
+    AVX2_TARGET static __m256d Apply(__m256d a, __m256d b) {
+        return _mm256_min_pd(a, b);
+    }
+#endif
+};
+
+struct DoubleMax {
+    static constexpr double kIdentity = -std::numeric_limits<double>::infinity();
+
+    static double Apply(double a, double b) {
+        return a < b ? b : a;
+    }
+#if SCHEME_AVX2
+    AVX2_TARGET static __m256d Apply(__m256d a, __m256d b) {
+        return _mm256_max_pd(a, b);
+    }
+#endif
+};
+
+// Checked operations on int64s. On registers they accumulate into overflow a lane whose sign
+// bit is set when the lane overflowed.
+struct Int64Add {
+    static bool Apply(int64_t a, int64_t b, int64_t* result) {
+        return CheckedAdd(a, b, result);
+    }
+#if SCHEME_AVX2
+    AVX2_TARGET static __m256i Apply(__m256i a, __m256i b, __m256i* overflow) {
+        auto result = _mm256_add_epi64(a, b);
+        // The sum overflowed if its sign differs from the sign of both operands.
+        *overflow = _mm256_or_si256(*overflow, _mm256_and_si256(_mm256_xor_si256(a, result),
+                                                                _mm256_xor_si256(b, result)));
+        return result;
+    }
+#endif
+};
+
+struct Int64Subtract {
+    static bool Apply(int64_t a, int64_t b, int64_t* result) {
+        return CheckedSubtract(a, b, result);
+    }
+#if SCHEME_AVX2
+    AVX2_TARGET static __m256i Apply(__m256i a, __m256i b, __m256i* overflow) {
+        auto result = _mm256_sub_epi64(a, b);
+        // The difference overflowed if the operands' signs differ and the result's sign isn't
+        // the minuend's.
+        *overflow = _mm256_or_si256(*overflow, _mm256_and_si256(_mm256_xor_si256(a, b),
+                                                                _mm256_xor_si256(a, result)));
+        return result;
+    }
+#endif
+};
+
+// AVX2 has no 64-bit multiplication, so these only run in portable loops.
+struct Int64Multiply {
+    static bool Apply(int64_t a, int64_t b, int64_t* result) {
+        return CheckedMultiply(a, b, result);
+    }
+};
+
+template <class Op>
+bool Elementwise(std::span<const double> a, std::span<const double> b, std::span<double> out) {
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = Op::Apply(a[i], b[i]);
+    }
+    return true;
+}
+
+template <class Op>
+bool Elementwise(std::span<const int64_t> a, std::span<const int64_t> b,
+                 std::span<int64_t> out) {
+    for (size_t i = 0; i < out.size(); ++i) {
+        if (!Op::Apply(a[i], b[i], &out[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Scale(std::span<const double> a, double factor, std::span<double> out) {
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = a[i] * factor;
+    }
+    return true;
+}
+
+bool Scale(std::span<const int64_t> a, int64_t factor, std::span<int64_t> out) {
+    for (size_t i = 0; i < out.size(); ++i) {
+        if (!CheckedMultiply(a[i], factor, &out[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Folds in four independent lanes, which compilers can keep in SIMD registers, then folds the
+// lanes and the values left over.
+template <class Op>
+double Reduce(std::span<const double> values) {
+    double lanes[4] = {Op::kIdentity, Op::kIdentity, Op::kIdentity, Op::kIdentity};
+    size_t i = 0;
+    for (; i + 4 <= values.size(); i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            lanes[lane] = Op::Apply(lanes[lane], values[i + lane]);
+        }
+    }
+    auto result = Op::Apply(Op::Apply(lanes[0], lanes[1]), Op::Apply(lanes[2], lanes[3]));
+    for (; i < values.size(); ++i) {
+        result = Op::Apply(result, values[i]);
+    }
+    return result;
+}
+
+double Dot(std::span<const double> a, std::span<const double> b) {
+    double lanes[4] = {-0.0, -0.0, -0.0, -0.0};
+    size_t i = 0;
+    for (; i + 4 <= a.size(); i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            lanes[lane] += a[i + lane] * b[i + lane];
+        }
+    }
+    auto result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < a.size(); ++i) {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+bool Dot(std::span<const int64_t> a, std::span<const int64_t> b, int64_t* result) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        int64_t product;
+        if (!CheckedMultiply(a[i], b[i], &product) || !CheckedAdd(sum, product, &sum)) {
+            return false;
+        }
+    }
+    *result = sum;
+    return true;
+}
+
+bool Sum(std::span<const int64_t> values, int64_t* result) {
+    int64_t sum = 0;
+    for (auto value : values) {
+        if (!CheckedAdd(sum, value, &sum)) {
+            return false;
+        }
+    }
+    *result = sum;
+    return true;
+}
+
+#if SCHEME_AVX2
+template <class Op>
+AVX2_TARGET bool ElementwiseAvx2(std::span<const double> a, std::span<const double> b,
+                                 std::span<double> out) {
+    size_t i = 0;
+    for (; i + 4 <= out.size(); i += 4) {
+        _mm256_storeu_pd(&out[i],
+                         Op::Apply(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+    }
+    for (; i < out.size(); ++i) {
+        out[i] = Op::Apply(a[i], b[i]);
+    }
+    return true;
+}
+
+template <class Op>
+AVX2_TARGET bool ElementwiseAvx2(std::span<const int64_t> a, std::span<const int64_t> b,
+                                 std::span<int64_t> out) {
+    size_t i = 0;
+    auto overflow = _mm256_setzero_si256();
+    for (; i + 4 <= out.size(); i += 4) {
+        auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&a[i]));
+        auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&b[i]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), Op::Apply(x, y, &overflow));
+    }
+    if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0) {
+        return false;
+    }
+    for (; i < out.size(); ++i) {
+        if (!Op::Apply(a[i], b[i], &out[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+AVX2_TARGET bool ScaleAvx2(std::span<const double> a, double factor, std::span<double> out) {
+    size_t i = 0;
+    auto factors = _mm256_set1_pd(factor);
+    for (; i + 4 <= out.size(); i += 4) {
+        _mm256_storeu_pd(&out[i], _mm256_mul_pd(_mm256_loadu_pd(&a[i]), factors));
+    }
+    for (; i < out.size(); ++i) {
+        out[i] = a[i] * factor;
+    }
+    return true;
+}
+
+AVX2_TARGET double HorizontalFold(__m256d lanes, double (*fold)(double, double)) {
+    double values[4];
+    _mm256_storeu_pd(values, lanes);
+    return fold(fold(values[0], values[1]), fold(values[2], values[3]));
+}
+
+// Two registers of four lanes each, to hide the latency of the operation.
+template <class Op>
+AVX2_TARGET double ReduceAvx2(std::span<const double> values) {
+    auto low = _mm256_set1_pd(Op::kIdentity);
+    auto high = _mm256_set1_pd(Op::kIdentity);
+    size_t i = 0;
+    for (; i + 8 <= values.size(); i += 8) {
+        low = Op::Apply(low, _mm256_loadu_pd(&values[i]));
+        high = Op::Apply(high, _mm256_loadu_pd(&values[i + 4]));
+    }
+    auto result = HorizontalFold(Op::Apply(low, high), [](double a, double b) {
+        return Op::Apply(a, b);
+    });
+    for (; i < values.size(); ++i) {
+        result = Op::Apply(result, values[i]);
+    }
+    return result;
+}
+
+AVX2_TARGET double DotAvx2(std::span<const double> a, std::span<const double> b) {
+    auto low = _mm256_set1_pd(-0.0);
+    auto high = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 8 <= a.size(); i += 8) {
+        low = _mm256_add_pd(low, _mm256_mul_pd(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+        high = _mm256_add_pd(
+            high, _mm256_mul_pd(_mm256_loadu_pd(&a[i + 4]), _mm256_loadu_pd(&b[i + 4])));
+    }
+    auto result = HorizontalFold(_mm256_add_pd(low, high), DoubleAdd::Apply);
+    for (; i < a.size(); ++i) {
+        result += a[i] * b[i];
+    }
+    return result;
+}
+
+AVX2_TARGET bool SumAvx2(std::span<const int64_t> values, int64_t* result) {
+    auto sums = _mm256_setzero_si256();
+    auto overflow = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= values.size(); i += 4) {
+        sums = Int64Add::Apply(
+            sums, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&values[i])), &overflow);
+    }
+    if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow)) != 0) {
+        return false;
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sums);
+    int64_t sum = 0;
+    for (auto lane : lanes) {
+        if (!CheckedAdd(sum, lane, &sum)) {
+            return false;
+        }
+    }
+    for (; i < values.size(); ++i) {
+        if (!CheckedAdd(sum, values[i], &sum)) {
+            return false;
+        }
+    }
+    *result = sum;
+    return true;
+}
+
+template <bool kMax>
+AVX2_TARGET int64_t ExtremumAvx2(std::span<const int64_t> values) {
+    auto result = values[0];
+    size_t i = 0;
+    if (values.size() >= 4) {
+        auto extremum = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&values[0]));
+        for (i = 4; i + 4 <= values.size(); i += 4) {
+            auto next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&values[i]));
+            auto replace = kMax ? _mm256_cmpgt_epi64(next, extremum)
+                                : _mm256_cmpgt_epi64(extremum, next);
+            extremum = _mm256_blendv_epi8(extremum, next, replace);
+        }
+        int64_t lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), extremum);
+        result = kMax ? *std::ranges::max_element(lanes) : *std::ranges::min_element(lanes);
+    }
+    for (; i < values.size(); ++i) {
+        result = kMax ? std::max(result, values[i]) : std::min(result, values[i]);
+    }
+    return result;
+}
+#endif
+}  // namespace
+
+bool HasVectorKernelsAvx2() {
+#if SCHEME_AVX2
+    static const bool kHasAvx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return kHasAvx2;
+#else
+    return false;
+#endif
+}
+
+bool VectorAdd(std::span<const double> a, std::span<const double> b, std::span<double> out) {
+    VECTOR_KERNEL(ElementwiseAvx2<DoubleAdd>(a, b, out), Elementwise<DoubleAdd>(a, b, out));
+}
+
+bool VectorAdd(std::span<const int64_t> a, std::span<const int64_t> b, std::span<int64_t> out) {
+    VECTOR_KERNEL(ElementwiseAvx2<Int64Add>(a, b, out), Elementwise<Int64Add>(a, b, out));
+}
+
+bool VectorSubtract(std::span<const double> a, std::span<const double> b,
+                    std::span<double> out) {
+    VECTOR_KERNEL(ElementwiseAvx2<DoubleSubtract>(a, b, out),
+                  Elementwise<DoubleSubtract>(a, b, out));
+}
+
+bool VectorSubtract(std::span<const int64_t> a, std::span<const int64_t> b,
+                    std::span<int64_t> out) {
+    VECTOR_KERNEL(ElementwiseAvx2<Int64Subtract>(a, b, out),
+                  Elementwise<Int64Subtract>(a, b, out));
+}
+
+bool VectorMultiply(std::span<const double> a, std::span<const double> b,
+                    std::span<double> out) {
+    VECTOR_KERNEL(ElementwiseAvx2<DoubleMultiply>(a, b, out),
+                  Elementwise<DoubleMultiply>(a, b, out));
+}
+
+bool VectorMultiply(std::span<const int64_t> a, std::span<const int64_t> b,
+                    std::span<int64_t> out) {
+    return Elementwise<Int64Multiply>(a, b, out);
+}
+
+bool VectorScale(std::span<const double> a, double factor, std::span<double> out) {
+    VECTOR_KERNEL(ScaleAvx2(a, factor, out), Scale(a, factor, out));
+}
+
+bool VectorScale(std::span<const int64_t> a, int64_t factor, std::span<int64_t> out) {
+    return Scale(a, factor, out);
+}
+
+double VectorDot(std::span<const double> a, std::span<const double> b) {
+    VECTOR_KERNEL(DotAvx2(a, b), Dot(a, b));
+}
+
+bool VectorDot(std::span<const int64_t> a, std::span<const int64_t> b, int64_t* result) {
+    return Dot(a, b, result);
+}
+
+double VectorSum(std::span<const double> values) {
+    VECTOR_KERNEL(ReduceAvx2<DoubleAdd>(values), Reduce<DoubleAdd>(values));
+}
+
+bool VectorSum(std::span<const int64_t> values, int64_t* result) {
+    VECTOR_KERNEL(SumAvx2(values, result), Sum(values, result));
+}
+
+double VectorProduct(std::span<const double> values) {
+    VECTOR_KERNEL(ReduceAvx2<DoubleMultiply>(values), Reduce<DoubleMultiply>(values));
+}
+
+double VectorMin(std::span<const double> values) {
+    if (HasNan(values)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    VECTOR_KERNEL(ReduceAvx2<DoubleMin>(values), Reduce<DoubleMin>(values));
+}
+
+int64_t VectorMin(std::span<const int64_t> values) {
+    VECTOR_KERNEL(ExtremumAvx2<false>(values), *std::ranges::min_element(values));
+}
+
+double VectorMax(std::span<const double> values) {
+    if (HasNan(values)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    VECTOR_KERNEL(ReduceAvx2<DoubleMax>(values), Reduce<DoubleMax>(values));
+}
+
+int64_t VectorMax(std::span<const int64_t> values) {
+    VECTOR_KERNEL(ExtremumAvx2<true>(values), *std::ranges::max_element(values));
+}
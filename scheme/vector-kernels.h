@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+// Loops over unboxed numbers, for the bulk builtins on numeric vectors and the variadic
+// arithmetic builtins. On x86-64 they use AVX2 when the processor has it, which is checked
+// once; elsewhere, or without AVX2, portable loops run instead.
+//
+// Element-wise kernels take spans of the same size and write out, which may alias an input.
+// The integer ones return false if any result doesn't fit in 64 bits; out is then partially
+// written. Floating-point sums and products are accumulated in several lanes, so they may
+// round differently from a left-to-right fold. Minimum and maximum take at least one value and
+// are NaN if any value is.
+
+// Whether the kernels use AVX2 on this machine.
+bool HasVectorKernelsAvx2();
+
+bool VectorAdd(std::span<const double> a, std::span<const double> b, std::span<double> out);
+bool VectorAdd(std::span<const int64_t> a, std::span<const int64_t> b, std::span<int64_t> out);
+
+bool VectorSubtract(std::span<const double> a, std::span<const double> b,
+                    std::span<double> out);
+bool VectorSubtract(std::span<const int64_t> a, std::span<const int64_t> b,
+                    std::span<int64_t> out);
+
+bool VectorMultiply(std::span<const double> a, std::span<const double> b,
+                    std::span<double> out);
+bool VectorMultiply(std::span<const int64_t> a, std::span<const int64_t> b,
+                    std::span<int64_t> out);
+
+bool VectorScale(std::span<const double> a, double factor, std::span<double> out);
+bool VectorScale(std::span<const int64_t> a, int64_t factor, std::span<int64_t> out);
+
+// The integer reductions return false when the result, or a partial sum on the way, doesn't
+// fit in 64 bits.
+double VectorDot(std::span<const double> a, std::span<const double> b);
+bool VectorDot(std::span<const int64_t> a, std::span<const int64_t> b, int64_t* result);
+
+double VectorSum(std::span<const double> values);
+bool VectorSum(std::span<const int64_t> values, int64_t* result);
+
+double VectorProduct(std::span<const double> values);
+
+double VectorMin(std::span<const double> values);
+int64_t VectorMin(std::span<const int64_t> values);
+
+double VectorMax(std::span<const double> values);
+int64_t VectorMax(std::span<const int64_t> values);
@@ -0,0 +1,60 @@
+#include "vector.h"
+#include <algorithm>
+#include <new>
+#include <string>
+#include "error.h"
+#include "heap.h"
+
+namespace {
+// Larger arrays are refused before they reach the allocator: no machine has the memory, and
+// some allocators abort on such requests instead of throwing.
+constexpr size_t kMaxArrayBytes = size_t{1} << 40;
+
+// Allocates an object of type T followed by size elements of type E. Throws RuntimeError if
+// they don't fit in memory, rather than letting the size wrap around or fail as bad_alloc.
+template <class T, class E>
+T* MakeArray(size_t size) {
+    auto error = [size] {
+        return RuntimeError("cannot allocate a vector of " + std::to_string(size) + " elements");
+    };
+    if (size > (kMaxArrayBytes - sizeof(T)) / sizeof(E)) {
+        throw error();
+    }
+    try {
+        return Heap::Instance().MakeSized<T>(sizeof(T) + size * sizeof(E), size);
+    } catch (const std::bad_alloc&) {
+        throw error();
+    }
+}
+}  // namespace
+
+Vector::Vector(size_t size) : Object(kType), size_(size) {
+}
+
+Vector* Vector::Create(size_t size, Value fill) {
+    auto* vector = MakeArray<Vector, Value>(size);
+    std::ranges::fill(vector->GetElements(), fill);
+    return vector;
+}
+
+Vector* Vector::Create(std::span<const Value> elements) {
+    auto* vector = MakeArray<Vector, Value>(elements.size());
+    std::ranges::copy(elements, vector->GetElements().begin());
+    return vector;
+}
+
+void Vector::Trace(Heap& heap) const {
+    for (auto element : GetElements()) {
+        heap.Mark(element);
+    }
+}
+
+template <class T, ObjectType Type>
+NumericVector<T, Type>* NumericVector<T, Type>::Create(size_t size) {
+    auto* vector = MakeArray<NumericVector, T>(size);
+    std::ranges::fill(vector->GetElements(), T{});
+    return vector;
+}
+
+template class NumericVector<int64_t, ObjectType::kS64Vector>;
+template class NumericVector<double, ObjectType::kF64Vector>;
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "object.h"
+
+// A fixed-size array of values, stored right after the object.
+class Vector : public Object {
+public:
+    static constexpr ObjectType kType = ObjectType::kVector;
+
+    static Vector* Create(size_t size, Value fill);
+    static Vector* Create(std::span<const Value> elements);
+
+    size_t GetSize() const {
+        return size_;
+    }
+
+    std::span<Value> GetElements() {
+        return {reinterpret_cast<Value*>(this + 1), size_};
+    }
+
+    std::span<const Value> GetElements() const {
+        return {reinterpret_cast<const Value*>(this + 1), size_};
+    }
+
+    void Trace(Heap& heap) const override;
+
+private:
+    friend class Heap;
+
+    explicit Vector(size_t size);
+
+    size_t size_;
+};
+
+// A fixed-size array of unboxed numbers of one type, stored right after the object. The
+// elements start zeroed.
+template <class T, ObjectType Type>
+class NumericVector : public Object {
+public:
+    using Element = T;
+
+    static constexpr ObjectType kType = Type;
+
+    static NumericVector* Create(size_t size);
+
+    size_t GetSize() const {
+        return size_;
+    }
+
+    std::span<T> GetElements() {
+        return {reinterpret_cast<T*>(this + 1), size_};
+    }
+
+    std::span<const T> GetElements() const {
+        return {reinterpret_cast<const T*>(this + 1), size_};
+    }
+
+private:
+    friend class Heap;
+
+    explicit NumericVector(size_t size) : Object(kType), size_(size) {
+    }
+
+    size_t size_;
+};
+
+using S64Vector = NumericVector<int64_t, ObjectType::kS64Vector>;
+using F64Vector = NumericVector<double, ObjectType::kF64Vector>;
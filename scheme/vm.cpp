@@ -0,0 +1,495 @@
+#include "vm.h"
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <utility>
+#include "compiler.h"
+#include "error.h"
+#include "heap.h"
+#include "number.h"
+
+// Computed goto jumps from one instruction straight to the next, a switch is the portable
+// fallback.
+#ifndef SCHEME_VM_COMPUTED_GOTO
+#if defined(__GNUC__)
+#define SCHEME_VM_COMPUTED_GOTO 1
+#else
+#define SCHEME_VM_COMPUTED_GOTO 0
+#endif
+#endif
+
+namespace {
+constexpr size_t kInitialStackSize = 1024;
+
+bool IsFalse(Value value) {
+    return value == kFalse;
+}
+
+// Whether activations of code take their frame from the FramePool.
+bool HasPooledFrame(const Code* code) {
+    return code->frame_size != 0 && !code->frame_captured;
+}
+}  // namespace
+
+VirtualMachine::VirtualMachine(Globals* globals) : globals_(globals) {
+    std::initializer_list<std::pair<std::string_view, Opcode>> primitives{
+        {"+", Opcode::kAdd},
+        {"-", Opcode::kSub},
+        {"*", Opcode::kMul},
+        {"<", Opcode::kLess},
+        {"<=", Opcode::kLessOrEqual},
+        {">", Opcode::kGreater},
+        {">=", Opcode::kGreaterOrEqual},
+        {"=", Opcode::kNumEqual}};
+    for (auto [name, opcode] : primitives) {
+        auto id = Symbol::Intern(name)->GetId();
+        auto function = globals->Find(id);
+        if (!Is<Function>(function)) {
+            continue;
+        }
+        primitives_.push_back({.symbol_id = id, .opcode = opcode, .function = function});
+    }
+    // Continuations are captured by the machine itself, not by the builtins.
+    call_cc_ = globals->Find(Symbol::Intern("call/cc")->GetId());
+    call_ec_ = globals->Find(Symbol::Intern("call/ec")->GetId());
+    stack_.resize(kInitialStackSize);
+    Heap::Instance().AddRootSet(this);
+}
+
+VirtualMachine::~VirtualMachine() {
+    Heap::Instance().RemoveRootSet(this);
+}
+
+void VirtualMachine::Trace(Heap& heap) const {
+    // The builtins must outlive a redefinition, the machine compares the globals against them.
+    for (const auto& primitive : primitives_) {
+        heap.Mark(primitive.function);
+    }
+    heap.Mark(call_cc_);
+    heap.Mark(call_ec_);
+    // At a safe point the current activation is pushed too, so the stack is live up to where
+    // its operands end. Frames of the pool are marked by the pool.
+    if (!frames_.empty()) {
+        for (size_t i = 0; i < frames_.back().top; ++i) {
+            heap.Mark(stack_[i]);
+        }
+    }
+    for (const auto& frame : frames_) {
+        heap.Mark(frame.code);
+        if (!frame.pooled) {
+            heap.Mark(frame.env);
+        }
+        heap.Mark(frame.escape);
+    }
+    heap.Mark(saved_);
+}
+
+Value VirtualMachine::Evaluate(const Node& node) {
+    return Run(Compiler(primitives_).Compile(node));
+}
+
+ContinuationFrame* VirtualMachine::SaveActivations(Code* code, const uint8_t* ip, Frame* env,
+                                                   bool pooled, const Value* top) {
+    // Frames of the pool die with their call, the saved activations get copies.
+    auto keep = [](Frame* frame, bool pooled) {
+        if (!pooled) {
+            return frame;
+        }
+        auto* copy = Frame::Create(frame->GetParent(), frame->GetSize());
+        std::copy_n(frame->GetSlots(), frame->GetSize(), copy->GetSlots());
+        return copy;
+    };
+    size_t base = 0;
+    for (const auto& frame : frames_) {
+        saved_ = ContinuationFrame::Create(
+            frame.code, frame.ip - frame.code->bytecode.data(), keep(frame.env, frame.pooled),
+            frame.escape, std::span(stack_.data() + base, frame.top - base), saved_);
+        base = frame.top;
+    }
+    const Value* bottom = stack_.data() + base;
+    saved_ = ContinuationFrame::Create(code, ip - code->bytecode.data(), keep(env, pooled),
+                                       nullptr, std::span(bottom, top), saved_);
+    frames_.clear();
+    return saved_;
+}
+
+Value VirtualMachine::Run(Code* code) {
+    assert(frames_.empty() && !saved_);
+    auto& heap = Heap::Instance();
+    auto& frame_pool = FramePool::Instance();
+    auto frame_pool_mark = frame_pool.GetMark();
+    Frame* env = nullptr;
+    // Whether env comes from the frame pool.
+    bool pooled = false;
+    // Set for a call made by call/ec, which returns to the frame it pushes.
+    Continuation* escape = nullptr;
+    const uint8_t* ip = code->bytecode.data();
+    const Value* constants = code->constants.data();
+    if (stack_.size() < code->max_stack) {
+        stack_.resize(code->max_stack);
+    }
+    Value* sp = stack_.data();
+    uint16_t argc;
+    bool tail;
+    uint8_t primitive;
+
+#define VM_READ(type) (ip += sizeof(type), ReadOperand<type>(ip - sizeof(type)))
+
+#if SCHEME_VM_COMPUTED_GOTO
+#define VM_CASE(name) op_##name
+#define VM_DISPATCH() goto* kDispatch[*ip++]
+#define VM_LABEL_ADDRESS(name) &&op_##name,
+    static const void* const kDispatch[] = {SCHEME_OPCODES(VM_LABEL_ADDRESS)};
+#undef VM_LABEL_ADDRESS
+#else
+#define VM_CASE(name) case Opcode::k##name
+#define VM_DISPATCH() continue
+#endif
+
+// Fixnum operands take the fast path unless the global was redefined; anything else, and
+// arithmetic leaving the fixnum range, calls the primitive.
+#define VM_BINARY(name, fast_path)                                                 \
+    VM_CASE(name) : {                                                              \
+        primitive = VM_READ(uint8_t);                                              \
+        auto lhs = sp[-2];                                                         \
+        auto rhs = sp[-1];                                                         \
+        const auto& entry = primitives_[primitive];                                \
+        if (lhs.IsFixnum() && rhs.IsFixnum() &&                                    \
+            globals_->Find(entry.symbol_id) == entry.function) {                   \
+            auto a = lhs.GetFixnum();                                              \
+            auto b = rhs.GetFixnum();                                              \
+            fast_path                                                              \
+        }                                                                          \
+        goto primitive_call;                                                       \
+    }
+#define VM_BINARY_RESULT(value)                                                \
+    sp[-2] = (value);                                                          \
+    --sp;                                                                      \
+    VM_DISPATCH();
+#define VM_ARITHMETIC(name, checked)                                           \
+    VM_BINARY(name, int64_t result;                                            \
+              if (checked(a, b, &result)) {                                    \
+                  VM_BINARY_RESULT(Value::Fixnum(result))                      \
+              })
+#define VM_COMPARISON(name, op) VM_BINARY(name, VM_BINARY_RESULT(Value::Boolean(a op b)))
+
+    try {
+#if SCHEME_VM_COMPUTED_GOTO
+        VM_DISPATCH();
+#else
+        for (;;) {
+            switch (static_cast<Opcode>(*ip++)) {
+#endif
+        VM_CASE(Constant) : {
+            *sp++ = constants[VM_READ(uint16_t)];
+            VM_DISPATCH();
+        }
+        VM_CASE(Nil) : {
+            *sp++ = nullptr;
+            VM_DISPATCH();
+        }
+        VM_CASE(Pop) : {
+            --sp;
+            VM_DISPATCH();
+        }
+        VM_CASE(LoadLocal) : {
+            auto depth = VM_READ(uint16_t);
+            auto slot = VM_READ(uint16_t);
+            auto* frame = env;
+            while (depth--) {
+                frame = frame->GetParent();
+            }
+            *sp++ = frame->GetSlots()[slot];
+            VM_DISPATCH();
+        }
+        VM_CASE(LoadLocalChecked) : {
+            auto depth = VM_READ(uint16_t);
+            auto slot = VM_READ(uint16_t);
+            auto name = VM_READ(uint16_t);
+            auto* frame = env;
+            while (depth--) {
+                frame = frame->GetParent();
+            }
+            auto value = frame->GetSlots()[slot];
+            if (value.IsUnbound()) {
+                throw NameError(As<Symbol>(constants[name])->GetName());
+            }
+            *sp++ = value;
+            VM_DISPATCH();
+        }
+        VM_CASE(StoreLocal) : {
+            auto depth = VM_READ(uint16_t);
+            auto slot = VM_READ(uint16_t);
+            auto* frame = env;
+            while (depth--) {
+                frame = frame->GetParent();
+            }
+            frame->GetSlots()[slot] = *--sp;
+            VM_DISPATCH();
+        }
+        VM_CASE(LoadGlobal) : {
+            auto id = VM_READ(uint32_t);
+            auto value = globals_->Find(id);
+            *sp++ = value.IsUnbound() ? globals_->Get(id) : value;
+            VM_DISPATCH();
+        }
+        VM_CASE(StoreGlobal) : {
+            globals_->Define(VM_READ(uint32_t), *--sp);
+            VM_DISPATCH();
+        }
+        VM_CASE(Jump) : {
+            ip = code->bytecode.data() + ReadOperand<uint32_t>(ip);
+            VM_DISPATCH();
+        }
+        VM_CASE(JumpIfFalse) : {
+            auto target = VM_READ(uint32_t);
+            if (IsFalse(*--sp)) {
+                ip = code->bytecode.data() + target;
+            }
+            VM_DISPATCH();
+        }
+        VM_CASE(JumpIfFalseKeep) : {
+            auto target = VM_READ(uint32_t);
+            if (IsFalse(sp[-1])) {
+                ip = code->bytecode.data() + target;
+            } else {
+                --sp;
+            }
+            VM_DISPATCH();
+        }
+        VM_CASE(JumpIfTrueKeep) : {
+            auto target = VM_READ(uint32_t);
+            if (!IsFalse(sp[-1])) {
+                ip = code->bytecode.data() + target;
+            } else {
+                --sp;
+            }
+            VM_DISPATCH();
+        }
+        VM_CASE(MakeClosure) : {
+            auto* lambda = static_cast<Code*>(constants[VM_READ(uint16_t)].GetObject());
+            *sp++ = Make<CompiledClosure>(lambda, env);
+            VM_DISPATCH();
+        }
+        VM_CASE(Call) : {
+            argc = VM_READ(uint16_t);
+            tail = false;
+            goto call;
+        }
+        VM_CASE(TailCall) : {
+            argc = VM_READ(uint16_t);
+            tail = true;
+            goto call;
+        }
+        VM_CASE(Return) : {
+        do_return:
+            if (pooled) {
+                frame_pool.Release(env);
+            }
+        return_to_caller:
+            if (frames_.empty()) {
+                if (!saved_) {
+                    return sp[-1];
+                }
+                // The caller was saved by a continuation: its operands go back on the stack.
+                auto result = sp[-1];
+                auto* caller = saved_;
+                saved_ = caller->GetNext();
+                code = caller->GetCode();
+                ip = code->bytecode.data() + caller->GetIp();
+                env = caller->GetEnv();
+                pooled = false;
+                constants = code->constants.data();
+                if (stack_.size() < code->max_stack) {
+                    stack_.resize(code->max_stack);
+                }
+                sp = std::ranges::copy(caller->GetOperands(), stack_.data()).out;
+                *sp++ = result;
+                VM_DISPATCH();
+            }
+            // The result already sits where the callee was.
+            const auto& caller = frames_.back();
+            code = caller.code;
+            ip = caller.ip;
+            env = caller.env;
+            pooled = caller.pooled;
+            constants = code->constants.data();
+            frames_.pop_back();
+            VM_DISPATCH();
+        }
+        VM_CASE(Raise) : {
+            std::rethrow_exception(code->errors[VM_READ(uint16_t)]);
+        }
+        VM_ARITHMETIC(Add, AddFixnums)
+        VM_ARITHMETIC(Sub, SubtractFixnums)
+        VM_ARITHMETIC(Mul, MultiplyFixnums)
+        VM_COMPARISON(Less, <)
+        VM_COMPARISON(LessOrEqual, <=)
+        VM_COMPARISON(Greater, >)
+        VM_COMPARISON(GreaterOrEqual, >=)
+        VM_COMPARISON(NumEqual, ==)
+
+        primitive_call : {
+            // Calls whatever the global holds now, which also reports bad arguments.
+            sp[0] = sp[-1];
+            sp[-1] = sp[-2];
+            sp[-2] = globals_->Get(primitives_[primitive].symbol_id);
+            ++sp;
+            argc = 2;
+            tail = false;
+            goto call;
+        }
+
+        call : {
+            if (heap.IsCollectionDue()) {
+                // Everything live is on the stack or in an activation, once the current one is
+                // pushed with the others.
+                frames_.push_back({.code = code,
+                                   .ip = ip,
+                                   .env = env,
+                                   .escape = escape,
+                                   .top = static_cast<size_t>(sp - stack_.data()),
+                                   .pooled = pooled});
+                heap.Collect();
+                frames_.pop_back();
+            }
+            auto callee = sp[-argc - 1];
+            auto* return_escape = escape;
+            escape = nullptr;
+            if (Is<CompiledClosure>(callee)) {
+                auto* closure = static_cast<CompiledClosure*>(callee.GetObject());
+                auto* callee_code = closure->GetCode();
+                if (argc != callee_code->param_count) {
+                    throw RuntimeError("\"lambda\": not equal amount of arguments");
+                }
+                if (tail && pooled) {
+                    // The arguments are on the stack, the frame of the caller is dead.
+                    frame_pool.Release(env);
+                }
+                auto* callee_env = closure->GetEnv();
+                bool callee_pooled = HasPooledFrame(callee_code);
+                if (callee_pooled) {
+                    callee_env = frame_pool.Acquire(callee_env, callee_code->frame_size);
+                    std::copy(sp - argc, sp, callee_env->GetSlots());
+                } else if (callee_code->frame_size != 0) {
+                    callee_env = Frame::Create(callee_env, callee_code->frame_size);
+                    std::copy(sp - argc, sp, callee_env->GetSlots());
+                }
+                sp -= argc + 1;
+                if (!tail) {
+                    if (frames_.size() + (saved_ ? saved_->GetDepth() : 0) == max_call_depth_) {
+                        throw RuntimeError("maximum call depth exceeded");
+                    }
+                    frames_.push_back({.code = code,
+                                       .ip = ip,
+                                       .env = env,
+                                       .escape = return_escape,
+                                       .top = static_cast<size_t>(sp - stack_.data()),
+                                       .pooled = pooled});
+                }
+                code = callee_code;
+                ip = code->bytecode.data();
+                env = callee_env;
+                pooled = callee_pooled;
+                constants = code->constants.data();
+
+                auto top = static_cast<size_t>(sp - stack_.data());
+                if (top + code->max_stack > stack_.size()) {
+                    stack_.resize(std::max(2 * stack_.size(), top + code->max_stack));
+                    sp = stack_.data() + top;
+                }
+                VM_DISPATCH();
+            }
+            if (Is<Continuation>(callee)) {
+                if (argc != 1) {
+                    throw RuntimeError("continuation must have 1 argument");
+                }
+                auto value = sp[-1];
+                auto* continuation = As<Continuation>(callee);
+                if (!continuation->IsEscapeOnly()) {
+                    // Everything running is dropped for the saved activations.
+                    frames_.clear();
+                    frame_pool.Release(frame_pool_mark);
+                    saved_ = continuation->GetFrames();
+                    sp = stack_.data();
+                    *sp++ = value;
+                    goto return_to_caller;
+                }
+                auto marked = std::ranges::find(frames_, continuation, &CallFrame::escape);
+                if (marked != frames_.end()) {
+                    // Drops the activations above the one call/ec returns to.
+                    auto first_pooled = std::ranges::find(marked + 1, frames_.end(), true,
+                                                          &CallFrame::pooled);
+                    if (first_pooled != frames_.end()) {
+                        frame_pool.Release(first_pooled->env);
+                    } else if (pooled) {
+                        frame_pool.Release(env);
+                    }
+                    sp = stack_.data() + marked->top;
+                    *sp++ = value;
+                    frames_.erase(marked + 1, frames_.end());
+                    goto return_to_caller;
+                }
+                for (auto* frame = saved_; frame; frame = frame->GetNext()) {
+                    if (frame->GetEscape() == continuation) {
+                        frames_.clear();
+                        frame_pool.Release(frame_pool_mark);
+                        saved_ = frame;
+                        sp = stack_.data();
+                        *sp++ = value;
+                        goto return_to_caller;
+                    }
+                }
+                throw RuntimeError("continuation called after its call/ec returned");
+            }
+            if (callee == call_cc_ && argc == 1) {
+                // The current activation is saved, the function returns straight to it.
+                auto* frames = SaveActivations(code, ip, env, pooled, sp - 2);
+                frame_pool.Release(frame_pool_mark);
+                pooled = false;
+                auto function = sp[-1];
+                sp = stack_.data();
+                *sp++ = function;
+                *sp++ = Make<Continuation>(frames);
+                tail = true;
+                goto call;
+            }
+            if (callee == call_ec_ && argc == 1) {
+                sp[-2] = sp[-1];
+                sp[-1] = Make<Continuation>();
+                escape = As<Continuation>(sp[-1]);
+                tail = false;
+                goto call;
+            }
+            if (Is<Function>(callee)) {
+                auto result = (*As<Function>(callee))(std::span<const Value>(sp - argc, argc));
+                sp -= argc;
+                sp[-1] = result;
+                if (tail) {
+                    goto do_return;
+                }
+                VM_DISPATCH();
+            }
+            throw RuntimeError("Expected function applying");
+        }
+#if !SCHEME_VM_COMPUTED_GOTO
+            }
+        }
+#endif
+    } catch (...) {
+        frames_.clear();
+        saved_ = nullptr;
+        frame_pool.Release(frame_pool_mark);
+        throw;
+    }
+
+#undef VM_COMPARISON
+#undef VM_ARITHMETIC
+#undef VM_BINARY_RESULT
+#undef VM_BINARY
+#undef VM_DISPATCH
+#undef VM_CASE
+#undef VM_READ
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include "analyzer.h"
+#include "bytecode.h"
+#include "continuation.h"
+#include "scope.h"
+
+// Stack-based virtual machine running compiled code. Calls between compiled procedures don't
+// recurse on the native stack, and tail calls reuse the caller's activation.
+// Activations take 24 bytes plus the stack slots of the procedure.
+inline constexpr size_t kDefaultMaxVmCallDepth = 10'000'000;
+
+// Every call is a safe point: the machine is a root set, whose stack and activations are
+// marked while it runs.
+class VirtualMachine : public RootSet {
+public:
+    // globals must already hold the builtins: binary calls to some of them are compiled to
+    // dedicated instructions.
+    explicit VirtualMachine(Globals* globals);
+    VirtualMachine(const VirtualMachine&) = delete;
+    VirtualMachine& operator=(const VirtualMachine&) = delete;
+    ~VirtualMachine();
+
+    // Compiles and runs a top-level form.
+    Value Evaluate(const Node& node);
+
+    // Nesting more non-tail calls raises a RuntimeError. Activations live on the heap, so the
+    // limit is only there to stop runaway recursion before it takes all the memory.
+    void SetMaxCallDepth(size_t depth) {
+        max_call_depth_ = depth;
+    }
+
+    void Trace(Heap& heap) const override;
+
+private:
+    // A caller waiting for its callee to return.
+    struct CallFrame {
+        Code* code;
+        const uint8_t* ip;
+        Frame* env;
+        // The continuation of the call/ec the callee was called by.
+        Continuation* escape;
+        // Where the operands of the caller end.
+        size_t top;
+        bool pooled;
+    };
+
+    Value Run(Code* code);
+
+    // Moves the callers and the current activation, whose operands end at top, to the heap.
+    // Returns the saved current activation.
+    ContinuationFrame* SaveActivations(Code* code, const uint8_t* ip, Frame* env, bool pooled,
+                                       const Value* top);
+
+    Globals* globals_;
+    std::vector<Primitive> primitives_;
+    std::vector<Value> stack_;
+    std::vector<CallFrame> frames_;
+    // Callers saved by a continuation, below the ones on frames_.
+    ContinuationFrame* saved_ = nullptr;
+    Value call_cc_;
+    Value call_ec_;
+    size_t max_call_depth_ = kDefaultMaxVmCallDepth;
+};